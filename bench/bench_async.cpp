@@ -0,0 +1,143 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+// Scheduler benchmarks over a growing number of worker threads: `spawn` starts two million tasks that do
+// nothing but await their children, `fanout` starts tasks with real work from one loop and joins them
+// through a chain of awaits. Latency is measured per task from its spawn to its completion.
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "../lang/driver.h"
+#include "../lang/runtime.h"
+
+static constexpr std::string_view source = R"(
+async function tree(depth: i32) -> i64
+{
+    if (depth == 0)
+        return 1;
+    var left: Task<i64> = tree(depth - 1);
+    var right: Task<i64> = tree(depth - 1);
+    return await left + await right;
+}
+
+function spawn(depth: i32) -> i64
+{
+    return await tree(depth);
+}
+
+async function seed() -> i64
+{
+    return 0;
+}
+
+async function chain(previous: Task<i64>, work: i32) -> i64
+{
+    var total: i64 = 0;
+    for (var i: i32 = 0; i < work; i += 1)
+        total += i % 7;
+    return total + await previous;
+}
+
+function fanout(n: i32) -> i64
+{
+    var last: Task<i64> = seed();
+    for (var i: i32 = 0; i < n; i += 1)
+        last = chain(last, 500);
+    return await last;
+}
+)";
+
+struct benchmark_t
+{
+    std::string_view name;
+    std::string_view function;
+    int32_t argument;
+};
+
+static int64_t percentile(const std::vector<int64_t>& sorted, const double p)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+int main(const int argc, char** argv)
+{
+    const int repeats = argc > 1 ? std::max(1, std::stoi(argv[1])) : 3;
+
+    driver::unit_t unit;
+    if (!driver::build_program(unit, source))
+        return 1;
+    const ir::module_t& module = unit.module;
+    const vm::program_t& program = unit.program;
+
+    std::vector<uint32_t> thread_counts;
+    const uint32_t hardware = argc > 2 ? std::max(1, std::stoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t t = 1; t < hardware; t *= 2)
+        thread_counts.push_back(t);
+    thread_counts.push_back(hardware);
+
+    constexpr benchmark_t benchmarks[] = {
+        { "spawn", "spawn", 20 },      // 2^21 - 1 tasks
+        { "fanout", "fanout", 20000 },
+    };
+
+    std::cout << std::left << std::setw(8) << "bench" << std::right << std::setw(8) << "threads" << std::setw(10) << "best ms"
+        << std::setw(12) << "Mtasks/s" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us"
+        << std::setw(10) << "steals" << "\n";
+    for (const auto& bench : benchmarks)
+    {
+        const auto function = static_cast<uint32_t>(ir::find_function(module, bench.function));
+        const vm::slot_t arg = { .i32 = bench.argument };
+        for (const uint32_t threads : thread_counts)
+        {
+            auto best = std::chrono::nanoseconds::max();
+            uint64_t tasks = 0;
+            uint64_t steals = 0;
+            std::vector<int64_t> latencies;
+            for (int r = 0; r < repeats; ++r)
+            {
+                std::ostringstream sink;
+                runtime::scheduler_t scheduler;
+                runtime::scheduler_init(scheduler, program, sink, threads);
+                scheduler.record_latency = true;
+                vm::slot_t result;
+                const auto start = std::chrono::steady_clock::now();
+                const vm::status status = runtime::call(scheduler, function, &arg, 1, result);
+                const auto time = std::chrono::steady_clock::now() - start;
+                runtime::shutdown(scheduler);
+                if (status != vm::status::OK)
+                {
+                    std::cerr << bench.name << ": " << scheduler.error << "\n";
+                    return 1;
+                }
+                if (time >= best)
+                    continue;
+
+                best = time;
+                tasks = 0;
+                steals = 0;
+                latencies.clear();
+                for (const auto& worker : scheduler.workers)
+                {
+                    tasks += worker->spawned;
+                    steals += worker->steals;
+                    latencies.insert(latencies.end(), worker->latencies.begin(), worker->latencies.end());
+                }
+            }
+
+            std::ranges::sort(latencies);
+            const auto ns = static_cast<double>(best.count());
+            std::cout << std::left << std::setw(8) << bench.name << std::right << std::setw(8) << threads << std::fixed
+                << std::setprecision(2) << std::setw(10) << ns / 1e6 << std::setw(12) << static_cast<double>(tasks) / ns * 1e3
+                << std::setprecision(1) << std::setw(10) << static_cast<double>(percentile(latencies, 0.5)) / 1e3
+                << std::setw(10) << static_cast<double>(percentile(latencies, 0.99)) / 1e3
+                << std::setw(10) << static_cast<double>(percentile(latencies, 0.999)) / 1e3 << std::setw(10) << steals << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+// Lexer throughput on a large pure-ASCII source and on the same source with non-ASCII identifiers, and
+// the UTF-8 validation pass on its own. The ASCII figure is the one that must not regress: validation
+// skips its 32-byte blocks and identifiers only decode bytes from 0x80 up.
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "../lang/lang.h"
+#include "../lang/unicode.h"
+
+static constexpr std::string_view snippet = R"(
+class Particle
+{
+    var position: Vector3;
+    var velocity: Vector3;
+    var lifetime: f32 = 1.0;
+
+    public function update(delta: f32) -> void
+    {
+        // Integrate and age the particle.
+        position.x += velocity.x * delta;
+        position.y += velocity.y * delta - 9.81 * delta * delta;
+        lifetime -= delta;
+    }
+};
+
+function simulate(particles: i32, steps: i32) -> f32
+{
+    var total: f32 = 0.0;
+    for (var i: i32 = 0; i < steps; i += 1)
+    {
+        if (i % 3 == 0 && total >= 0.5)
+            total = total * 0.5 + 0x1F;
+        io.write("step", i, total);
+    }
+    return total;
+}
+)";
+
+static std::string repeat(const std::string_view text, const size_t bytes)
+{
+    std::string out;
+    out.reserve(bytes + text.size());
+    while (out.size() < bytes)
+        out += text;
+    return out;
+}
+
+static std::string replace_all(const std::string_view text, const std::string_view from, const std::string_view to)
+{
+    std::string out;
+    size_t start = 0;
+    for (size_t at = text.find(from); at != std::string_view::npos; at = text.find(from, start))
+    {
+        out.append(text, start, at - start).append(to);
+        start = at + from.size();
+    }
+    return out.append(text, start);
+}
+
+template<typename F>
+static double best_seconds(const int repeats, F&& f)
+{
+    auto best = std::chrono::nanoseconds::max();
+    for (int r = 0; r < repeats; ++r)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+    return static_cast<double>(best.count()) / 1e9;
+}
+
+int main(const int argc, char** argv)
+{
+    const int repeats = argc > 1 ? std::max(1, std::stoi(argv[1])) : 5;
+    const std::string ascii = repeat(snippet, 16 << 20);
+    const std::string unicode = repeat(replace_all(replace_all(replace_all(snippet, "total", "tötal"), "delta", "Δt"), "lifetime", "寿命"), 16 << 20);
+
+    size_t sink = 0;
+    const auto lex = [&sink](const std::string& source)
+    {
+        lexer::lexer_t lexer;
+        lexer::lexer_init(lexer, source);
+        sink += lexer::tokenize(lexer).size() + lexer.error_log.size();
+    };
+    const struct
+    {
+        std::string_view name;
+        const std::string& source;
+        double seconds;
+    } results[] = {
+        { "validate", ascii, best_seconds(repeats, [&] { sink += unicode::validate_utf8(ascii); }) },
+        { "validate-scalar", ascii, best_seconds(repeats, [&] { sink += unicode::find_invalid_utf8(ascii); }) },
+        { "validate-utf8", unicode, best_seconds(repeats, [&] { sink += unicode::validate_utf8(unicode); }) },
+        { "lex-ascii", ascii, best_seconds(repeats, [&] { lex(ascii); }) },
+        { "lex-utf8", unicode, best_seconds(repeats, [&] { lex(unicode); }) },
+    };
+
+    std::cout << std::left << std::setw(18) << "benchmark" << std::right << std::setw(10) << "MiB" << std::setw(12) << "best ms"
+        << std::setw(12) << "MiB/s" << "\n";
+    for (const auto& result : results)
+    {
+        const double mib = static_cast<double>(result.source.size()) / (1 << 20);
+        std::cout << std::left << std::setw(18) << result.name << std::right << std::fixed << std::setprecision(1) << std::setw(10) << mib
+            << std::setprecision(2) << std::setw(12) << result.seconds * 1e3 << std::setw(12) << mib / result.seconds << "\n";
+    }
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+// Interpreter microbenchmarks. Built twice: `bench-vm` with computed-goto dispatch and
+// `bench-vm-switch` with the portable switch loop, so the two can be compared directly.
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "../lang/driver.h"
+
+static constexpr std::string_view source = R"(
+class Vector3
+{
+    var x: f32 = 0.0;
+    var y: f32 = 0.0;
+    var z: f32 = 0.0;
+
+    public static dot(a: Vector3, b: Vector3) -> f32
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+};
+
+class Shape
+{
+    var side: i32 = 1;
+
+    public virtual function area() -> i32
+    {
+        return side;
+    }
+};
+
+class Square extends Shape
+{
+    public function area() -> i32
+    {
+        return side * side;
+    }
+};
+
+function loop(n: i32) -> i64
+{
+    var total: i64 = 0;
+    for (var i: i32 = 0; i < n; i += 1)
+    {
+        if (i % 3 == 0)
+            total += i;
+        else
+            total -= 1;
+    }
+    return total;
+}
+
+function fib(n: i32) -> i32
+{
+    if (n < 2)
+        return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+function fields(n: i32) -> f32
+{
+    var a: Vector3 = Vector3(1.0, 2.0, 3.0);
+    var b: Vector3 = Vector3(0.5, 0.25, 0.125);
+    var total: f32 = 0.0;
+    for (var i: i32 = 0; i < n; i += 1)
+    {
+        a.x += b.x;
+        a.y -= b.y;
+        total += a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+    return total;
+}
+
+function methods(n: i32) -> f32
+{
+    var a: Vector3 = Vector3(1.0, 2.0, 3.0);
+    var b: Vector3 = Vector3(0.5, 0.25, 0.125);
+    var total: f32 = 0.0;
+    for (var i: i32 = 0; i < n; i += 1)
+        total += Vector3.dot(a, b);
+    return total;
+}
+
+function allocations(n: i32) -> f32
+{
+    var total: f32 = 0.0;
+    for (var i: i32 = 0; i < n; i += 1)
+    {
+        var v: Vector3 = new Vector3();
+        v.x = i;
+        total += Vector3.dot(v, v);
+    }
+    return total;
+}
+
+function virtuals(n: i32) -> i32
+{
+    var shape: Shape = new Shape();
+    var square: Shape = new Square();
+    var total: i32 = 0;
+    for (var i: i32 = 0; i < n; i += 2)
+        total += shape.area() + square.area();
+    return total;
+}
+)";
+
+struct benchmark_t
+{
+    std::string_view name;
+    std::string_view function;
+    int32_t argument;
+    uint64_t units; // loop iterations or calls performed by one run
+};
+
+int main(const int argc, char** argv)
+{
+    const int repeats = argc > 1 ? std::max(1, std::stoi(argv[1])) : 5;
+
+    driver::unit_t unit;
+    if (!driver::build_program(unit, source))
+        return 1;
+    const ir::module_t& module = unit.module;
+    const vm::program_t& program = unit.program;
+
+    std::ostringstream sink;
+    vm::vm_t machine;
+    vm::vm_init(machine, program, sink);
+
+    constexpr benchmark_t benchmarks[] = {
+        { "loop", "loop", 10000000, 10000000 },
+        { "calls", "fib", 27, 317811 * 2 - 1 }, // fib(27) makes 2 * fib(28) - 1 calls
+        { "fields", "fields", 5000000, 5000000 },
+        { "methods", "methods", 5000000, 5000000 },
+        { "virtual", "virtuals", 5000000, 5000000 }, // polymorphic inline cache hits
+        { "alloc", "allocations", 5000000, 5000000 }, // `new` that escape analysis keeps in the frame
+    };
+
+    std::cout << "dispatch: " << (LUMEN_VM_COMPUTED_GOTO ? "computed goto" : "switch") << "\n";
+    std::cout << std::left << std::setw(10) << "benchmark" << std::right << std::setw(12) << "best ms" << std::setw(14) << "ns/unit" << "\n";
+    for (const auto& bench : benchmarks)
+    {
+        const auto function = static_cast<uint32_t>(ir::find_function(module, bench.function));
+        const vm::slot_t arg = { .i32 = bench.argument };
+        auto best = std::chrono::nanoseconds::max();
+        for (int r = 0; r < repeats; ++r)
+        {
+            vm::slot_t result;
+            const auto start = std::chrono::steady_clock::now();
+            if (vm::call(machine, function, &arg, 1, result) != vm::status::OK)
+            {
+                std::cerr << bench.name << ": " << machine.error << "\n";
+                return 1;
+            }
+            best = std::min(best, std::chrono::steady_clock::now() - start);
+        }
+        std::cout << std::left << std::setw(10) << bench.name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(12) << static_cast<double>(best.count()) / 1e6
+            << std::setw(14) << static_cast<double>(best.count()) / static_cast<double>(bench.units) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "lang/server.h"
+
+// Forwards a regular `lumen-lang` command line to a running `lumen-lang serve`. The socket is taken
+// from `--socket <path>` (first), then $LUMEN_SOCKET, then the server's default.
+int main(const int argc, char** argv)
+{
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string socket_path;
+    if (args.size() >= 2 && args[0] == "--socket")
+    {
+        socket_path = args[1];
+        args.erase(args.begin(), args.begin() + 2);
+    }
+    else if (const char* env = std::getenv("LUMEN_SOCKET"); env != nullptr && *env != '\0')
+    {
+        socket_path = env;
+    }
+    else
+    {
+        socket_path = server::default_socket();
+    }
+    return server::forward(socket_path, args);
+}
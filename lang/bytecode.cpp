@@ -0,0 +1,1289 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <type_traits>
+#include "vm.h"
+
+static constexpr std::array<std::string_view, static_cast<size_t>(vm::opcode::COUNT)> opcode_t = {
+#define LUMEN_VM_NAME(name) #name,
+    LUMEN_VM_OPCODES(LUMEN_VM_NAME)
+#undef LUMEN_VM_NAME
+};
+
+namespace
+{
+    using ir::opcode;
+    using ir::type_kind;
+    using ir::NONE;
+
+    constexpr uint32_t MAX_REGISTERS = UINT16_MAX;
+
+    enum class kind : uint8_t
+    {
+        I32,
+        I64,
+        F32,
+        F64,
+    };
+
+    struct patch_t
+    {
+        uint32_t instr;
+        uint32_t label;
+        bool wide; // target in the 32-bit immediate, otherwise in `a`
+    };
+
+    struct stub_t
+    {
+        uint32_t label;
+        uint32_t pred;
+        uint32_t succ;
+    };
+
+    struct compiler_t
+    {
+        vm::program_t& program;
+        const ir::module_t& module;
+        ir::function_t fn;
+        vm::function_t& out;
+        uint32_t index;
+        bool fuse;
+        ir::cfg_t cfg {};
+        std::vector<uint32_t> uses {};
+        std::vector<uint8_t> immediate {}; // per ADD/SUB: 1 or 2 if operand a or b is folded into ADDI
+        std::vector<bool> fused {};        // comparison emitted as part of the following branch
+        std::vector<bool> has_reg {};
+        std::vector<uint32_t> reg {};
+        std::vector<uint32_t> labels {};
+        std::vector<patch_t> patches {};
+        std::vector<stub_t> stubs {};
+        std::vector<std::pair<uint32_t, uint32_t>> locals {}; // (NEW_LOCAL instruction, slot past the registers)
+        uint32_t local_slots = 0;
+        uint32_t scratch = 0;
+        std::string error {};
+    };
+
+    kind kind_of(const type_kind type)
+    {
+        switch (type)
+        {
+            case type_kind::F32: return kind::F32;
+            case type_kind::F64: return kind::F64;
+            case type_kind::I64:
+            case type_kind::STR:
+            case type_kind::REF:
+            case type_kind::TASK: return kind::I64;
+            default: return kind::I32;
+        }
+    }
+
+    // Typed opcodes are laid out I32, I64, F32, F64 in every group.
+    vm::opcode typed(const vm::opcode base, const kind k, const uint32_t stride)
+    {
+        return static_cast<vm::opcode>(static_cast<uint32_t>(base) + static_cast<uint32_t>(k) * stride);
+    }
+
+    bool is_comparison(const opcode op)
+    {
+        return op >= opcode::EQ && op <= opcode::GE;
+    }
+
+    bool small_immediate(const ir::function_t& fn, const uint32_t value, const bool negate, int16_t& out)
+    {
+        const ir::inst_t& inst = fn.insts[value];
+        if (inst.op != opcode::CONST || (inst.type != type_kind::I32 && inst.type != type_kind::I64))
+            return false;
+        int64_t v = inst.type == type_kind::I32
+            ? static_cast<int32_t>(ir::const_bits(inst))
+            : static_cast<int64_t>(ir::const_bits(inst));
+        if (negate)
+            v = -v;
+        if (v < INT16_MIN || v > INT16_MAX)
+            return false;
+        out = static_cast<int16_t>(v);
+        return true;
+    }
+
+    template<typename F>
+    void phi_operands(const ir::function_t& fn, const uint32_t block, F&& f)
+    {
+        for (uint32_t i = fn.blocks[block].first; i < fn.blocks[block].first + fn.blocks[block].count; ++i)
+        {
+            const ir::inst_t& inst = fn.insts[i];
+            if (inst.op != opcode::PHI)
+                break;
+            for (uint32_t k = 0; k < inst.b; ++k)
+                f(i, fn.extra[inst.a + 2 * k], fn.extra[inst.a + 2 * k + 1]);
+        }
+    }
+
+    bool has_phis(const ir::function_t& fn, const uint32_t block)
+    {
+        return fn.blocks[block].count != 0 && fn.insts[fn.blocks[block].first].op == opcode::PHI;
+    }
+
+    // Register operands read by instruction `i`; phi operands are read on the incoming edges instead.
+    template<typename F>
+    void register_uses(compiler_t& c, const uint32_t i, F&& f)
+    {
+        ir::inst_t& inst = c.fn.insts[i];
+        if (inst.op == opcode::PHI || c.fused[i])
+            return;
+        if (inst.op == opcode::BRANCH && c.fused[inst.a])
+        {
+            f(c.fn.insts[inst.a].a);
+            f(c.fn.insts[inst.a].b);
+            return;
+        }
+        uint32_t index = 0;
+        ir::for_each_operand(c.fn, inst, [&](const uint32_t v)
+        {
+            if (c.immediate[i] != ++index)
+                f(v);
+        });
+    }
+
+    void select(compiler_t& c)
+    {
+        const ir::function_t& fn = c.fn;
+        const size_t n = fn.insts.size();
+        c.uses.assign(n, 0);
+        c.immediate.assign(n, 0);
+        c.fused.assign(n, false);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            ir::for_each_operand(c.fn, c.fn.insts[i], [&](const uint32_t v) { ++c.uses[v]; });
+            const ir::inst_t& inst = fn.insts[i];
+            int16_t imm;
+            if (inst.op == opcode::ADD && (inst.type == type_kind::I32 || inst.type == type_kind::I64))
+            {
+                if (small_immediate(fn, inst.b, false, imm))
+                    c.immediate[i] = 2;
+                else if (small_immediate(fn, inst.a, false, imm))
+                    c.immediate[i] = 1;
+            }
+            else if (inst.op == opcode::SUB && (inst.type == type_kind::I32 || inst.type == type_kind::I64)
+                && small_immediate(fn, inst.b, true, imm))
+            {
+                c.immediate[i] = 2;
+            }
+        }
+
+        if (c.fuse)
+        {
+            for (uint32_t i = 1; i < n; ++i)
+            {
+                const ir::inst_t& inst = fn.insts[i];
+                if (inst.op != opcode::BRANCH || inst.a != i - 1 || c.uses[i - 1] != 1 || inst.b == inst.c)
+                    continue;
+                const ir::inst_t& cond = fn.insts[i - 1];
+                if (is_comparison(cond.op) && kind_of(fn.insts[cond.a].type) <= kind::I64)
+                    c.fused[i - 1] = true;
+            }
+        }
+
+        // A constant only needs a register if some use could not take it as an immediate.
+        std::vector<bool> needed(n, false);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (fn.insts[i].op == opcode::PHI)
+            {
+                for (uint32_t k = 0; k < fn.insts[i].b; ++k)
+                    needed[fn.extra[fn.insts[i].a + 2 * k + 1]] = true;
+                continue;
+            }
+            register_uses(c, i, [&](const uint32_t v) { needed[v] = true; });
+        }
+
+        c.has_reg.assign(n, false);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const ir::inst_t& inst = fn.insts[i];
+            c.has_reg[i] = inst.op != opcode::NOP && inst.type != type_kind::VOID && !c.fused[i]
+                && (inst.op != opcode::CONST || needed[i]);
+        }
+    }
+
+    // Single live range per value, widened over every block in which it is live. Coarse, but a
+    // register file without spilling only needs it to be conservative.
+    void allocate(compiler_t& c)
+    {
+        const ir::function_t& fn = c.fn;
+        const size_t n = fn.insts.size();
+        const size_t nb = fn.blocks.size();
+        const size_t words = (n + 63) / 64;
+
+        std::vector<uint64_t> live_in(nb * words, 0);
+        std::vector<uint64_t> live_out(nb * words, 0);
+        std::vector<uint64_t> gen(nb * words, 0);
+        const auto set = [&](std::vector<uint64_t>& bits, const size_t b, const uint32_t v) { bits[b * words + v / 64] |= 1ull << (v % 64); };
+
+        for (uint32_t b = 0; b < nb; ++b)
+        {
+            for (uint32_t i = fn.blocks[b].first; i < fn.blocks[b].first + fn.blocks[b].count; ++i)
+            {
+                register_uses(c, i, [&](const uint32_t v)
+                {
+                    if (fn.insts[v].block != b)
+                        set(gen, b, v);
+                });
+            }
+        }
+
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            for (size_t b = nb; b-- > 0;)
+            {
+                std::vector<uint64_t> out(words, 0);
+                for (uint32_t k = c.cfg.succ_offsets[b]; k < c.cfg.succ_offsets[b + 1]; ++k)
+                {
+                    const uint32_t s = c.cfg.succs[k];
+                    for (size_t w = 0; w < words; ++w)
+                        out[w] |= live_in[s * words + w];
+                    phi_operands(fn, s, [&](uint32_t, const uint32_t pred, const uint32_t v)
+                    {
+                        if (pred == b)
+                            out[v / 64] |= 1ull << (v % 64);
+                    });
+                }
+                // Values defined in `b` occupy the index range of the block and are not live on entry.
+                std::vector<uint64_t> in(words);
+                for (size_t w = 0; w < words; ++w)
+                    in[w] = out[w] | gen[b * words + w];
+                for (uint32_t v = fn.blocks[b].first; v < fn.blocks[b].first + fn.blocks[b].count; ++v)
+                    in[v / 64] &= ~(1ull << (v % 64));
+                for (size_t w = 0; w < words; ++w)
+                {
+                    if (out[w] != live_out[b * words + w] || in[w] != live_in[b * words + w])
+                    {
+                        live_out[b * words + w] = out[w];
+                        live_in[b * words + w] = in[w];
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        std::vector<uint32_t> start(n), end(n);
+        for (uint32_t i = 0; i < n; ++i)
+            start[i] = end[i] = i;
+        const auto extend = [&](const uint32_t v, const uint32_t pos)
+        {
+            start[v] = std::min(start[v], pos);
+            end[v] = std::max(end[v], pos);
+        };
+        for (uint32_t b = 0; b < nb; ++b)
+        {
+            const uint32_t first = fn.blocks[b].first;
+            const uint32_t last = first + fn.blocks[b].count - 1;
+            for (uint32_t i = first; i <= last; ++i)
+                register_uses(c, i, [&](const uint32_t v) { extend(v, i); });
+            phi_operands(fn, b, [&](uint32_t, const uint32_t pred, const uint32_t v)
+            {
+                const uint32_t pred_last = fn.blocks[pred].first + fn.blocks[pred].count - 1;
+                extend(v, pred_last);
+            });
+            for (uint32_t v = 0; v < n; ++v)
+            {
+                if (live_in[b * words + v / 64] >> (v % 64) & 1)
+                    extend(v, first);
+                if (live_out[b * words + v / 64] >> (v % 64) & 1)
+                    extend(v, last);
+            }
+        }
+
+        // Coalesce phis with their operands so the edge copies disappear. Members of a group never
+        // interfere, and no copy writing the group's register happens while another member is live.
+        // Each group is allocated as one range that also covers the edges of its remaining copies.
+        struct edge_t
+        {
+            uint32_t position;
+            uint32_t phi;
+            uint32_t operand;
+        };
+        std::vector<uint32_t> group(n);
+        std::vector<std::vector<uint32_t>> members(n);
+        std::vector<std::vector<edge_t>> edges(n);
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            group[v] = v;
+            members[v] = { v };
+        }
+        for (uint32_t b = 0; b < nb; ++b)
+        {
+            phi_operands(fn, b, [&](const uint32_t phi, const uint32_t pred, const uint32_t v)
+            {
+                edges[phi].push_back({ fn.blocks[pred].first + fn.blocks[pred].count - 1, phi, v });
+            });
+        }
+
+        // Exact SSA interference for coalescing: two values interfere iff one is live where the other
+        // is defined. Phis are defined together on block entry.
+        std::vector<std::vector<uint32_t>> use_positions(n);
+        for (uint32_t i = 0; i < n; ++i)
+            register_uses(c, i, [&](const uint32_t v) { use_positions[v].push_back(i); });
+        const auto contains = [&](const std::vector<uint64_t>& bits, const uint32_t b, const uint32_t v)
+        {
+            return (bits[b * words + v / 64] >> (v % 64) & 1) != 0;
+        };
+        const auto live_after = [&](const uint32_t v, const uint32_t position)
+        {
+            const uint32_t b = fn.insts[position].block;
+            if (fn.insts[position].op == opcode::PHI)
+                return contains(live_in, b, v) || (fn.insts[v].op == opcode::PHI && fn.insts[v].block == b);
+            if (fn.insts[v].block == b && v > position)
+                return false;
+            const uint32_t last = fn.blocks[b].first + fn.blocks[b].count - 1;
+            return contains(live_out, b, v) || std::ranges::any_of(use_positions[v], [&](const uint32_t u) { return u > position && u <= last; });
+        };
+        const auto compatible = [&](const uint32_t x, const uint32_t y)
+        {
+            for (const uint32_t m : members[x])
+            {
+                for (const uint32_t k : members[y])
+                {
+                    if (live_after(m, k) || live_after(k, m))
+                        return false;
+                }
+            }
+            // A copy on edge `pred -> block` writes the register while the values live into `block` still hold theirs.
+            const auto clobbers = [&](const std::vector<edge_t>& list, const std::vector<uint32_t>& values)
+            {
+                return std::ranges::any_of(list, [&](const edge_t& e)
+                {
+                    const uint32_t block = fn.insts[e.phi].block;
+                    return std::ranges::any_of(values, [&](const uint32_t m) { return m != e.phi && contains(live_in, block, m); });
+                });
+            };
+            return !clobbers(edges[x], members[y]) && !clobbers(edges[y], members[x]);
+        };
+        const auto coalesce = [&](const bool phi_operands_pass)
+        {
+            for (uint32_t phi = 0; phi < n; ++phi)
+            {
+                if (fn.insts[phi].op != opcode::PHI || !c.has_reg[phi])
+                    continue;
+                for (const edge_t& e : std::vector<edge_t>(edges[phi]))
+                {
+                    const uint32_t v = e.operand;
+                    const uint32_t x = group[phi];
+                    const uint32_t y = group[v];
+                    if (x == y || !c.has_reg[v] || fn.insts[v].op == opcode::PARAM || (fn.insts[v].op == opcode::PHI) != phi_operands_pass
+                        || !compatible(x, y))
+                        continue;
+                    for (const uint32_t m : members[y])
+                        group[m] = x;
+                    members[x].insert(members[x].end(), members[y].begin(), members[y].end());
+                    edges[x].insert(edges[x].end(), edges[y].begin(), edges[y].end());
+                    members[y].clear();
+                    edges[y].clear();
+                }
+            }
+        };
+        coalesce(false);
+        coalesce(true);
+        for (uint32_t v = 0; v < n; ++v)
+        {
+            if (group[v] != v)
+                continue;
+            for (const uint32_t m : members[v])
+            {
+                extend(v, start[m]);
+                extend(v, end[m]);
+            }
+            for (const edge_t& e : edges[v])
+                extend(v, e.position);
+        }
+
+        std::vector<uint32_t> order;
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (c.has_reg[i] && group[i] == i)
+                order.push_back(i);
+        }
+        std::ranges::sort(order, [&](const uint32_t x, const uint32_t y) { return start[x] != start[y] ? start[x] < start[y] : x < y; });
+
+        // Parameters arrive in registers 0..n-1; the ones never read are free from the start.
+        const auto param_count = static_cast<uint32_t>(fn.params.size());
+        std::vector<bool> param_live(param_count, false);
+        for (const uint32_t v : order)
+        {
+            if (fn.insts[v].op == opcode::PARAM)
+                param_live[fn.insts[v].a] = true;
+        }
+        std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>> free;
+        for (uint32_t p = 0; p < param_count; ++p)
+        {
+            if (!param_live[p])
+                free.push(p);
+        }
+        uint32_t next = param_count;
+
+        using active_t = std::pair<uint32_t, uint32_t>; // (end, register)
+        std::priority_queue<active_t, std::vector<active_t>, std::greater<>> active;
+        c.reg.assign(n, NONE);
+        for (const uint32_t v : order)
+        {
+            while (!active.empty() && active.top().first <= start[v])
+            {
+                free.push(active.top().second);
+                active.pop();
+            }
+            uint32_t r;
+            if (fn.insts[v].op == opcode::PARAM)
+            {
+                r = fn.insts[v].a;
+            }
+            else if (!free.empty())
+            {
+                r = free.top();
+                free.pop();
+            }
+            else
+            {
+                r = next++;
+            }
+            c.reg[v] = r;
+            active.emplace(end[v], r);
+        }
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (group[i] != i)
+                c.reg[i] = c.reg[group[i]];
+        }
+        c.out.register_count = static_cast<uint16_t>(std::min<uint32_t>(next, MAX_REGISTERS));
+        if (next >= MAX_REGISTERS)
+            c.error = "function " + fn.name + " needs more than " + std::to_string(MAX_REGISTERS) + " registers";
+    }
+
+    uint32_t emit(compiler_t& c, const vm::opcode op, const uint32_t a = 0, const uint32_t b = 0, const uint32_t cc = 0)
+    {
+        c.out.code.push_back({ op, 0, static_cast<uint16_t>(a), static_cast<uint16_t>(b), static_cast<uint16_t>(cc) });
+        return static_cast<uint32_t>(c.out.code.size() - 1);
+    }
+
+    uint32_t emit_wide(compiler_t& c, const vm::opcode op, const uint32_t a, const uint32_t imm)
+    {
+        return emit(c, op, a, imm & 0xFFFF, imm >> 16);
+    }
+
+    void emit_jump(compiler_t& c, const vm::opcode op, const uint32_t cond, const uint32_t label)
+    {
+        c.patches.push_back({ emit(c, op, cond), label, true });
+    }
+
+    uint32_t new_label(compiler_t& c)
+    {
+        c.labels.push_back(NONE);
+        return static_cast<uint32_t>(c.labels.size() - 1);
+    }
+
+    uint32_t operand_offset(compiler_t& c, const std::vector<uint32_t>& values)
+    {
+        const auto offset = static_cast<uint32_t>(c.out.operands.size());
+        c.out.operands.insert(c.out.operands.end(), values.begin(), values.end());
+        return offset;
+    }
+
+    uint32_t constant(compiler_t& c, const vm::slot_t value)
+    {
+        c.out.constants.push_back(value);
+        return static_cast<uint32_t>(c.out.constants.size() - 1);
+    }
+
+    uint32_t scratch(compiler_t& c)
+    {
+        if (c.scratch == NONE)
+        {
+            c.scratch = c.out.register_count;
+            ++c.out.register_count;
+        }
+        return c.scratch;
+    }
+
+    // Sequentialises the phi copies of edge `pred -> succ`, breaking cycles through a scratch register.
+    void emit_edge_copies(compiler_t& c, const uint32_t pred, const uint32_t succ)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> copies; // (dst, src)
+        phi_operands(c.fn, succ, [&](const uint32_t phi, const uint32_t from, const uint32_t v)
+        {
+            if (from == pred && c.reg[phi] != c.reg[v])
+                copies.emplace_back(c.reg[phi], c.reg[v]);
+        });
+
+        while (!copies.empty())
+        {
+            const auto ready = std::ranges::find_if(copies, [&](const auto& copy)
+            {
+                return std::ranges::none_of(copies, [&](const auto& other) { return other.second == copy.first; });
+            });
+            if (ready != copies.end())
+            {
+                emit(c, vm::opcode::MOV, ready->first, ready->second);
+                copies.erase(ready);
+                continue;
+            }
+            const uint32_t blocked = copies.front().first;
+            const uint32_t tmp = scratch(c);
+            emit(c, vm::opcode::MOV, tmp, blocked);
+            for (auto& copy : copies)
+            {
+                if (copy.second == blocked)
+                    copy.second = tmp;
+            }
+        }
+    }
+
+    void emit_const(compiler_t& c, const uint32_t i)
+    {
+        const ir::inst_t& inst = c.fn.insts[i];
+        const uint64_t bits = ir::const_bits(inst);
+        vm::slot_t value = {};
+        switch (inst.type)
+        {
+            case type_kind::STR:
+                value.ref = &c.program.strings[bits];
+                c.out.string_constants.push_back(constant(c, value));
+                emit_wide(c, vm::opcode::LOADK, c.reg[i], c.out.string_constants.back());
+                return;
+            case type_kind::I64:
+            case type_kind::F64:
+            case type_kind::REF:
+                if (static_cast<int64_t>(bits) != static_cast<int32_t>(bits))
+                {
+                    value.i64 = static_cast<int64_t>(bits);
+                    emit_wide(c, vm::opcode::LOADK, c.reg[i], constant(c, value));
+                    return;
+                }
+                break;
+            default:
+                break;
+        }
+        emit_wide(c, vm::opcode::LOADI, c.reg[i], static_cast<uint32_t>(bits));
+    }
+
+    bool emit_convert(compiler_t& c, const uint32_t i)
+    {
+        const ir::inst_t& inst = c.fn.insts[i];
+        const type_kind from = c.fn.insts[inst.a].type;
+        const auto dst = c.reg[i];
+        const auto src = c.reg[inst.a];
+        const auto same = [](const type_kind x, const type_kind y)
+        {
+            return x == y || (x == type_kind::BOOL && y == type_kind::I32) || (x == type_kind::I32 && y == type_kind::BOOL);
+        };
+        if (same(from, inst.type))
+        {
+            emit(c, vm::opcode::MOV, dst, src);
+            return true;
+        }
+
+        using vm::opcode;
+        static constexpr opcode table[4][4] = {
+            //   to I32               to I64               to F32               to F64
+            { opcode::NOP,        opcode::I32_TO_I64, opcode::I32_TO_F32, opcode::I32_TO_F64 }, // from I32
+            { opcode::I64_TO_I32, opcode::NOP,        opcode::I64_TO_F32, opcode::I64_TO_F64 }, // from I64
+            { opcode::F32_TO_I32, opcode::F32_TO_I64, opcode::NOP,        opcode::F32_TO_F64 }, // from F32
+            { opcode::F64_TO_I32, opcode::F64_TO_I64, opcode::F64_TO_F32, opcode::NOP        }, // from F64
+        };
+        const bool numeric_from = from >= type_kind::BOOL && from <= type_kind::F64;
+        const bool numeric_to = inst.type >= type_kind::I32 && inst.type <= type_kind::F64;
+        if (!numeric_from || !numeric_to)
+        {
+            c.error = "unsupported conversion from " + std::string(ir::type_name(from)) + " to " + std::string(ir::type_name(inst.type));
+            return false;
+        }
+        emit(c, table[static_cast<size_t>(kind_of(from))][static_cast<size_t>(kind_of(inst.type))], dst, src);
+        return true;
+    }
+
+    void emit_compare(compiler_t& c, const uint32_t i)
+    {
+        const ir::inst_t& inst = c.fn.insts[i];
+        const kind k = kind_of(c.fn.insts[inst.a].type);
+        uint32_t lhs = c.reg[inst.a];
+        uint32_t rhs = c.reg[inst.b];
+        vm::opcode op;
+        switch (inst.op)
+        {
+            case opcode::EQ: op = vm::opcode::EQ_I32; break;
+            case opcode::NE: op = vm::opcode::NE_I32; break;
+            case opcode::LT: op = vm::opcode::LT_I32; break;
+            case opcode::LE: op = vm::opcode::LE_I32; break;
+            case opcode::GT: op = vm::opcode::LT_I32; std::swap(lhs, rhs); break;
+            default: op = vm::opcode::LE_I32; std::swap(lhs, rhs); break;
+        }
+        emit(c, typed(op, k, 4), c.reg[i], lhs, rhs);
+    }
+
+    // Emits `if cond (== expected): goto label`, fusing a preceding integer comparison.
+    void emit_conditional(compiler_t& c, const uint32_t cond, const bool expected, const uint32_t label)
+    {
+        if (!c.fused[cond])
+        {
+            emit_jump(c, expected ? vm::opcode::JMP_IF : vm::opcode::JMP_IFNOT, c.reg[cond], label);
+            return;
+        }
+
+        const ir::inst_t& inst = c.fn.insts[cond];
+        uint32_t lhs = c.reg[inst.a];
+        uint32_t rhs = c.reg[inst.b];
+        opcode op = inst.op;
+        if (op == opcode::GT || op == opcode::GE)
+        {
+            op = op == opcode::GT ? opcode::LT : opcode::LE;
+            std::swap(lhs, rhs);
+        }
+        if (!expected)
+        {
+            // Integer comparisons negate exactly: !(x < y) == y <= x.
+            switch (op)
+            {
+                case opcode::EQ: op = opcode::NE; break;
+                case opcode::NE: op = opcode::EQ; break;
+                case opcode::LT: op = opcode::LE; std::swap(lhs, rhs); break;
+                default: op = opcode::LT; std::swap(lhs, rhs); break;
+            }
+        }
+        const vm::opcode base = op == opcode::EQ ? vm::opcode::JEQ_I32
+            : op == opcode::NE ? vm::opcode::JNE_I32
+            : op == opcode::LT ? vm::opcode::JLT_I32
+            : vm::opcode::JLE_I32;
+        const uint32_t at = emit(c, typed(base, kind_of(c.fn.insts[inst.a].type), 4), 0, lhs, rhs);
+        c.patches.push_back({ at, label, false });
+    }
+
+    void emit_branch(compiler_t& c, const uint32_t block, const ir::inst_t& inst)
+    {
+        const uint32_t next = block + 1;
+        const uint32_t t = inst.b;
+        const uint32_t f = inst.c;
+        const bool copies_t = has_phis(c.fn, t);
+        bool copies_f = has_phis(c.fn, f);
+        const uint32_t label_t = copies_t ? new_label(c) : t;
+        const uint32_t label_f = copies_f ? new_label(c) : f;
+
+        if (!copies_f && f == next)
+        {
+            emit_conditional(c, inst.a, true, label_t);
+        }
+        else if (!copies_t && t == next)
+        {
+            emit_conditional(c, inst.a, false, label_f);
+        }
+        else
+        {
+            emit_conditional(c, inst.a, true, label_t);
+            if (copies_f)
+            {
+                c.labels[label_f] = static_cast<uint32_t>(c.out.code.size());
+                emit_edge_copies(c, block, f);
+                copies_f = false;
+            }
+            if (f != next)
+                emit_jump(c, vm::opcode::JMP, 0, f);
+        }
+
+        // Remaining critical edges get their copies in stubs placed after the function body.
+        if (copies_t)
+            c.stubs.push_back({ label_t, block, t });
+        if (copies_f)
+            c.stubs.push_back({ label_f, block, f });
+    }
+
+    bool emit_instruction(compiler_t& c, const uint32_t block, const uint32_t i)
+    {
+        const ir::inst_t& inst = c.fn.insts[i];
+        const uint32_t dst = c.reg[i];
+        switch (inst.op)
+        {
+            case opcode::NOP:
+            case opcode::PARAM:
+            case opcode::PHI:
+                return true;
+            case opcode::CONST:
+                if (c.has_reg[i])
+                    emit_const(c, i);
+                return true;
+            case opcode::ADD:
+            case opcode::SUB:
+                if (c.immediate[i] != 0)
+                {
+                    const uint32_t value = c.immediate[i] == 2 ? inst.a : inst.b;
+                    int16_t imm;
+                    small_immediate(c.fn, c.immediate[i] == 2 ? inst.b : inst.a, inst.op == opcode::SUB, imm);
+                    const auto op = inst.type == type_kind::I32 ? vm::opcode::ADDI_I32 : vm::opcode::ADDI_I64;
+                    emit(c, op, dst, c.reg[value], static_cast<uint16_t>(imm));
+                    return true;
+                }
+                [[fallthrough]];
+            case opcode::MUL:
+            case opcode::DIV:
+            case opcode::REM:
+            {
+                const kind k = kind_of(inst.type);
+                const auto base = static_cast<uint32_t>(inst.op) - static_cast<uint32_t>(opcode::ADD);
+                vm::opcode op;
+                if (k <= kind::I64)
+                    op = static_cast<vm::opcode>(static_cast<uint32_t>(k == kind::I32 ? vm::opcode::ADD_I32 : vm::opcode::ADD_I64) + base);
+                else
+                    op = static_cast<vm::opcode>(static_cast<uint32_t>(k == kind::F32 ? vm::opcode::ADD_F32 : vm::opcode::ADD_F64) + base);
+                emit(c, op, dst, c.reg[inst.a], c.reg[inst.b]);
+                return true;
+            }
+            case opcode::AND:
+            case opcode::OR:
+            case opcode::XOR:
+            case opcode::SHL:
+            case opcode::SHR:
+            {
+                const auto base = static_cast<uint32_t>(inst.op) - static_cast<uint32_t>(opcode::AND);
+                const auto first = kind_of(inst.type) == kind::I64 ? vm::opcode::AND_I64 : vm::opcode::AND_I32;
+                emit(c, static_cast<vm::opcode>(static_cast<uint32_t>(first) + base), dst, c.reg[inst.a], c.reg[inst.b]);
+                return true;
+            }
+            case opcode::NEG:
+            {
+                static constexpr vm::opcode neg[] = { vm::opcode::NEG_I32, vm::opcode::NEG_I64, vm::opcode::NEG_F32, vm::opcode::NEG_F64 };
+                emit(c, neg[static_cast<size_t>(kind_of(inst.type))], dst, c.reg[inst.a]);
+                return true;
+            }
+            case opcode::NOT:
+                if (inst.type == type_kind::BOOL)
+                    emit(c, vm::opcode::NOT_BOOL, dst, c.reg[inst.a]);
+                else
+                    emit(c, kind_of(inst.type) == kind::I64 ? vm::opcode::NOT_I64 : vm::opcode::NOT_I32, dst, c.reg[inst.a]);
+                return true;
+            case opcode::EQ:
+            case opcode::NE:
+            case opcode::LT:
+            case opcode::LE:
+            case opcode::GT:
+            case opcode::GE:
+                if (!c.fused[i])
+                    emit_compare(c, i);
+                return true;
+            case opcode::CONVERT:
+                return emit_convert(c, i);
+            case opcode::CALL:
+            {
+                if (inst.aux == static_cast<uint16_t>(ir::call_kind::VIRTUAL))
+                {
+                    const int32_t selector = c.module.functions[inst.a].selector;
+                    std::vector<uint32_t> site = { static_cast<uint32_t>(c.program.sites.size()), inst.c };
+                    for (uint32_t k = 0; k < inst.c; ++k)
+                        site.push_back(c.reg[c.fn.extra[inst.b + k]]);
+                    const uint32_t at = emit_wide(c, vm::opcode::CALL_VIRTUAL, c.has_reg[i] ? dst : 0, operand_offset(c, site));
+                    c.out.code[at].aux = c.has_reg[i];
+                    c.program.sites.push_back({ c.index, at, static_cast<uint32_t>(selector) });
+                    return true;
+                }
+                std::vector<uint32_t> site = { inst.a, inst.c };
+                for (uint32_t k = 0; k < inst.c; ++k)
+                    site.push_back(c.reg[c.fn.extra[inst.b + k]]);
+                const auto op = inst.aux == static_cast<uint16_t>(ir::call_kind::SPAWN) ? vm::opcode::SPAWN : vm::opcode::CALL;
+                const uint32_t at = emit_wide(c, op, c.has_reg[i] ? dst : 0, operand_offset(c, site));
+                c.out.code[at].aux = c.has_reg[i];
+                return true;
+            }
+            case opcode::BUILTIN:
+            {
+                std::vector<uint32_t> site = { inst.c };
+                for (uint32_t k = 0; k < inst.c; ++k)
+                {
+                    const uint32_t v = c.fn.extra[inst.b + k];
+                    site.push_back(c.reg[v]);
+                    site.push_back(static_cast<uint32_t>(c.fn.insts[v].type));
+                }
+                emit_wide(c, vm::opcode::WRITE, 0, operand_offset(c, site));
+                return true;
+            }
+            case opcode::AWAIT:
+            {
+                const uint32_t at = emit(c, vm::opcode::AWAIT, c.has_reg[i] ? dst : 0, c.reg[inst.a]);
+                c.out.code[at].aux = c.has_reg[i];
+                return true;
+            }
+            case opcode::NEW:
+            {
+                // Objects that do not escape live in the frame behind the registers: a header slot, then the data.
+                static_assert(alignof(vm::slot_t) == ir::FRAME_ALIGN);
+                const vm::class_info_t& cls = c.program.classes[inst.a];
+                if (inst.aux == static_cast<uint16_t>(ir::alloc_kind::STACK) && cls.align <= ir::FRAME_ALIGN && inst.a <= UINT16_MAX)
+                {
+                    c.locals.emplace_back(emit(c, vm::opcode::NEW_LOCAL, dst, 0, inst.a), c.local_slots);
+                    c.local_slots += 1 + (std::max<uint32_t>(cls.size, 1) + sizeof(vm::slot_t) - 1) / sizeof(vm::slot_t);
+                    return true;
+                }
+                emit_wide(c, vm::opcode::NEW, dst, inst.a);
+                return true;
+            }
+            case opcode::LOAD:
+            case opcode::STORE:
+            {
+                if (inst.b > UINT16_MAX)
+                {
+                    c.error = "field offset " + std::to_string(inst.b) + " exceeds the bytecode limit";
+                    return false;
+                }
+                const auto mem = static_cast<ir::mem_kind>(inst.aux);
+                if (inst.op == opcode::LOAD)
+                {
+                    static constexpr vm::opcode load[] = {
+                        vm::opcode::LOAD_I8, vm::opcode::LOAD_U8, vm::opcode::LOAD_I16, vm::opcode::LOAD_U16,
+                        vm::opcode::LOAD_I32, vm::opcode::LOAD_U32, vm::opcode::LOAD_64, vm::opcode::LOAD_I32,
+                        vm::opcode::LOAD_64, vm::opcode::LOAD_64, vm::opcode::LOAD_64,
+                    };
+                    emit(c, load[static_cast<size_t>(mem)], dst, c.reg[inst.a], inst.b);
+                }
+                else
+                {
+                    static constexpr vm::opcode store[] = {
+                        vm::opcode::STORE_8, vm::opcode::STORE_8, vm::opcode::STORE_16, vm::opcode::STORE_16,
+                        vm::opcode::STORE_32, vm::opcode::STORE_32, vm::opcode::STORE_64, vm::opcode::STORE_32,
+                        vm::opcode::STORE_64, vm::opcode::STORE_64, vm::opcode::STORE_64,
+                    };
+                    emit(c, store[static_cast<size_t>(mem)], c.reg[inst.a], inst.b, c.reg[inst.c]);
+                }
+                return true;
+            }
+            case opcode::COPY:
+            {
+                const uint32_t offset = operand_offset(c, { c.fn.extra[inst.c], c.fn.extra[inst.c + 1], c.fn.extra[inst.c + 2] });
+                if (offset > UINT16_MAX)
+                {
+                    c.error = "function " + c.fn.name + " has too many copy descriptors";
+                    return false;
+                }
+                emit(c, vm::opcode::COPY, c.reg[inst.a], c.reg[inst.b], offset);
+                return true;
+            }
+            case opcode::JUMP:
+                emit_edge_copies(c, block, inst.a);
+                if (inst.a != block + 1)
+                    emit_jump(c, vm::opcode::JMP, 0, inst.a);
+                return true;
+            case opcode::BRANCH:
+                if (inst.b == inst.c)
+                {
+                    emit_edge_copies(c, block, inst.b);
+                    if (inst.b != block + 1)
+                        emit_jump(c, vm::opcode::JMP, 0, inst.b);
+                    return true;
+                }
+                emit_branch(c, block, inst);
+                return true;
+            case opcode::RETURN:
+                if (inst.a == NONE)
+                    emit(c, vm::opcode::RET_VOID);
+                else
+                    emit(c, vm::opcode::RET, c.reg[inst.a]);
+                return true;
+            default:
+                c.error = "cannot compile " + std::string(ir::opcode_name(inst.op));
+                return false;
+        }
+    }
+
+    bool compile_function(compiler_t& c)
+    {
+        c.cfg = ir::compute_cfg(c.fn);
+        c.out.code.clear();
+        c.out.constants.clear();
+        c.out.operands.clear();
+        c.out.string_constants.clear();
+        c.labels.assign(c.fn.blocks.size(), NONE);
+        c.patches.clear();
+        c.stubs.clear();
+        c.locals.clear();
+        c.local_slots = 0;
+        c.scratch = NONE;
+        std::erase_if(c.program.sites, [&](const vm::call_site_t& site) { return site.function == c.index; });
+        c.out.name = c.fn.name;
+        c.out.param_count = static_cast<uint16_t>(c.fn.params.size());
+        c.out.return_type = c.fn.return_type;
+        c.out.coroutine = parser::has_modifier(c.fn.modifiers, parser::modifier::ASYNC);
+
+        select(c);
+        allocate(c);
+        if (!c.error.empty())
+            return false;
+
+        for (uint32_t b = 0; b < c.fn.blocks.size(); ++b)
+        {
+            c.labels[b] = static_cast<uint32_t>(c.out.code.size());
+            for (uint32_t i = c.fn.blocks[b].first; i < c.fn.blocks[b].first + c.fn.blocks[b].count; ++i)
+            {
+                if (!emit_instruction(c, b, i))
+                    return false;
+            }
+        }
+        for (const stub_t& stub : c.stubs)
+        {
+            c.labels[stub.label] = static_cast<uint32_t>(c.out.code.size());
+            emit_edge_copies(c, stub.pred, stub.succ);
+            emit_jump(c, vm::opcode::JMP, 0, stub.succ);
+        }
+
+        for (const patch_t& patch : c.patches)
+        {
+            vm::instr_t& instr = c.out.code[patch.instr];
+            const uint32_t target = c.labels[patch.label];
+            if (patch.wide)
+            {
+                instr.b = static_cast<uint16_t>(target);
+                instr.c = static_cast<uint16_t>(target >> 16);
+            }
+            else if (target > UINT16_MAX)
+            {
+                c.error = "branch target out of range";
+                return false;
+            }
+            else
+            {
+                instr.a = static_cast<uint16_t>(target);
+            }
+        }
+
+        // The register count is final only now that scratch registers have been handed out.
+        c.out.frame_size = c.out.register_count + c.local_slots;
+        if (c.out.frame_size > MAX_REGISTERS)
+        {
+            c.error = "function " + c.fn.name + " has too many objects in its frame";
+            return false;
+        }
+        for (const auto& [at, slot] : c.locals)
+            c.out.code[at].b = static_cast<uint16_t>(c.out.register_count + slot);
+        return true;
+    }
+
+    // `write_program` output: plain values in native byte order, vectors and strings prefixed by their length.
+    template<typename T>
+    void put(std::string& out, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    void put(std::string& out, const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        put(out, static_cast<uint64_t>(values.size()));
+        out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void put(std::string& out, const std::string& value)
+    {
+        put(out, static_cast<uint64_t>(value.size()));
+        out.append(value);
+    }
+
+    struct reader_t
+    {
+        std::string_view data;
+        bool ok = true; // false once a read ran past the end
+    };
+
+    template<typename T>
+    void get(reader_t& in, T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (in.data.size() < sizeof(value))
+        {
+            in.ok = false;
+            return;
+        }
+        std::memcpy(&value, in.data.data(), sizeof(value));
+        in.data.remove_prefix(sizeof(value));
+    }
+
+    size_t get_count(reader_t& in, const size_t element_size)
+    {
+        uint64_t count = 0;
+        get(in, count);
+        if (!in.ok || count > in.data.size() / element_size)
+        {
+            in.ok = false;
+            return 0;
+        }
+        return count;
+    }
+
+    template<typename T>
+    void get(reader_t& in, std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        values.resize(get_count(in, sizeof(T)));
+        if (values.empty())
+            return;
+        std::memcpy(values.data(), in.data.data(), values.size() * sizeof(T));
+        in.data.remove_prefix(values.size() * sizeof(T));
+    }
+
+    void get(reader_t& in, std::string& value)
+    {
+        value.assign(in.data.substr(0, get_count(in, 1)));
+        in.data.remove_prefix(value.size());
+    }
+}
+
+std::string_view vm::opcode_name(const opcode op)
+{
+    return opcode_t[static_cast<size_t>(op)];
+}
+
+bool vm::compile_program(program_t& program, const ir::module_t& module, const layout::layout_table_t& layouts)
+{
+    program.functions.clear();
+    program.classes.clear();
+    program.sites.clear();
+    program.selectors = module.selectors;
+    program.strings = module.strings;
+    program.entry = -1;
+
+    for (const auto& cls : layouts.classes)
+        program.classes.push_back({ cls.name, static_cast<uint32_t>(cls.size), static_cast<uint32_t>(cls.align), cls.base, {} });
+    for (size_t f = 0; f < module.functions.size(); ++f)
+    {
+        const ir::function_t& fn = module.functions[f];
+        if (fn.selector >= 0)
+            program.classes[fn.owner].methods.emplace_back(static_cast<uint32_t>(fn.selector), static_cast<uint32_t>(f));
+    }
+
+    program.functions.resize(module.functions.size());
+    for (size_t f = 0; f < module.functions.size(); ++f)
+    {
+        compiler_t c = { program, module, module.functions[f], program.functions[f], static_cast<uint32_t>(f), true };
+        if (!compile_function(c) && c.error == "branch target out of range")
+        {
+            // Fused compare-and-branch encodes its target in 16 bits; very large functions go without.
+            c.error.clear();
+            c.fuse = false;
+            compile_function(c);
+        }
+        if (!c.error.empty())
+        {
+            program.error_log.push_back(module.functions[f].name + ": " + c.error);
+            return false;
+        }
+
+        if ((module.functions[f].name == "main" || module.functions[f].name == "Main") && module.functions[f].params.empty())
+            program.entry = static_cast<int32_t>(f);
+    }
+    return true;
+}
+
+void vm::print_program(const program_t& program, std::ostream& out)
+{
+    for (const auto& fn : program.functions)
+    {
+        out << (fn.coroutine ? "async function " : "function ") << fn.name << " (params " << fn.param_count << ", registers " << fn.register_count;
+        if (fn.frame_size != fn.register_count)
+            out << ", frame " << fn.frame_size;
+        out << ")\n";
+        for (size_t pc = 0; pc < fn.code.size(); ++pc)
+        {
+            const instr_t& instr = fn.code[pc];
+            const uint32_t imm = static_cast<uint32_t>(instr.b) | static_cast<uint32_t>(instr.c) << 16;
+            out << "    " << pc << "\t" << opcode_name(instr.op);
+            switch (instr.op)
+            {
+                case opcode::NOP:
+                case opcode::RET_VOID:
+                    break;
+                case opcode::LOADI:
+                    out << " r" << instr.a << ", " << static_cast<int32_t>(imm);
+                    break;
+                case opcode::LOADK:
+                    out << " r" << instr.a << ", k" << imm;
+                    break;
+                case opcode::NEW:
+                    out << " r" << instr.a << ", " << program.classes[imm].name;
+                    break;
+                case opcode::NEW_LOCAL:
+                    out << " r" << instr.a << ", " << program.classes[instr.c].name << " @" << instr.b;
+                    break;
+                case opcode::CALL:
+                case opcode::SPAWN:
+                    out << (instr.aux ? " r" + std::to_string(instr.a) + ", " : " ") << program.functions[fn.operands[imm]].name << "(";
+                    for (uint32_t k = 0; k < fn.operands[imm + 1]; ++k)
+                        out << (k != 0 ? ", r" : "r") << fn.operands[imm + 2 + k];
+                    out << ")";
+                    break;
+                case opcode::CALL_VIRTUAL:
+                    out << (instr.aux ? " r" + std::to_string(instr.a) + ", " : " ") << "site" << fn.operands[imm] << " "
+                        << program.selectors[program.sites[fn.operands[imm]].selector] << "(";
+                    for (uint32_t k = 0; k < fn.operands[imm + 1]; ++k)
+                        out << (k != 0 ? ", r" : "r") << fn.operands[imm + 2 + k];
+                    out << ")";
+                    break;
+                case opcode::WRITE:
+                    out << " (";
+                    for (uint32_t k = 0; k < fn.operands[imm]; ++k)
+                        out << (k != 0 ? ", r" : "r") << fn.operands[imm + 1 + 2 * k];
+                    out << ")";
+                    break;
+                case opcode::JMP:
+                    out << " " << imm;
+                    break;
+                case opcode::JMP_IF:
+                case opcode::JMP_IFNOT:
+                    out << " r" << instr.a << ", " << imm;
+                    break;
+                case opcode::RET:
+                    out << " r" << instr.a;
+                    break;
+                case opcode::AWAIT:
+                    out << (instr.aux ? " r" + std::to_string(instr.a) + ", " : " ") << "r" << instr.b;
+                    break;
+                case opcode::MOV:
+                case opcode::NEG_I32: case opcode::NOT_I32: case opcode::NEG_I64: case opcode::NOT_I64:
+                case opcode::NEG_F32: case opcode::NEG_F64: case opcode::NOT_BOOL:
+                    out << " r" << instr.a << ", r" << instr.b;
+                    break;
+                case opcode::LOAD_I8: case opcode::LOAD_U8: case opcode::LOAD_I16: case opcode::LOAD_U16:
+                case opcode::LOAD_I32: case opcode::LOAD_U32: case opcode::LOAD_64:
+                    out << " r" << instr.a << ", [r" << instr.b << " + " << instr.c << "]";
+                    break;
+                case opcode::STORE_8: case opcode::STORE_16: case opcode::STORE_32: case opcode::STORE_64:
+                    out << " [r" << instr.a << " + " << instr.b << "], r" << instr.c;
+                    break;
+                case opcode::COPY:
+                    out << " [r" << instr.a << " + " << fn.operands[instr.c] << "], [r" << instr.b << " + " << fn.operands[instr.c + 1]
+                        << "], " << fn.operands[instr.c + 2];
+                    break;
+                case opcode::ADDI_I32:
+                case opcode::ADDI_I64:
+                    out << " r" << instr.a << ", r" << instr.b << ", " << static_cast<int16_t>(instr.c);
+                    break;
+                case opcode::JEQ_I32: case opcode::JNE_I32: case opcode::JLT_I32: case opcode::JLE_I32:
+                case opcode::JEQ_I64: case opcode::JNE_I64: case opcode::JLT_I64: case opcode::JLE_I64:
+                    out << " r" << instr.b << ", r" << instr.c << ", " << instr.a;
+                    break;
+                default:
+                    if (instr.op >= opcode::I32_TO_I64 && instr.op <= opcode::F64_TO_F32)
+                        out << " r" << instr.a << ", r" << instr.b;
+                    else
+                        out << " r" << instr.a << ", r" << instr.b << ", r" << instr.c;
+            }
+            out << "\n";
+        }
+    }
+}
+
+std::string vm::write_program(const program_t& program)
+{
+    std::string out;
+    put(out, static_cast<uint64_t>(program.functions.size()));
+    for (const auto& fn : program.functions)
+    {
+        std::vector<slot_t> constants = fn.constants;
+        for (const uint32_t k : fn.string_constants)
+            constants[k].i64 = static_cast<const std::string*>(constants[k].ref) - program.strings.data();
+        put(out, fn.name);
+        put(out, fn.code);
+        put(out, constants);
+        put(out, fn.operands);
+        put(out, fn.string_constants);
+        put(out, fn.register_count);
+        put(out, fn.param_count);
+        put(out, fn.frame_size);
+        put(out, fn.return_type);
+        put(out, fn.coroutine);
+    }
+    put(out, static_cast<uint64_t>(program.classes.size()));
+    for (const auto& cls : program.classes)
+    {
+        put(out, cls.name);
+        put(out, cls.size);
+        put(out, cls.align);
+        put(out, cls.base);
+        put(out, static_cast<uint64_t>(cls.methods.size()));
+        for (const auto& [selector, function] : cls.methods)
+        {
+            put(out, selector);
+            put(out, function);
+        }
+    }
+    put(out, static_cast<uint64_t>(program.selectors.size()));
+    for (const auto& selector : program.selectors)
+        put(out, selector);
+    put(out, program.sites);
+    put(out, static_cast<uint64_t>(program.strings.size()));
+    for (const auto& string : program.strings)
+        put(out, string);
+    put(out, program.entry);
+    return out;
+}
+
+bool vm::read_program(const std::string_view data, program_t& program)
+{
+    reader_t in = { data };
+    program = {};
+    program.functions.resize(get_count(in, 1));
+    for (auto& fn : program.functions)
+    {
+        get(in, fn.name);
+        get(in, fn.code);
+        get(in, fn.constants);
+        get(in, fn.operands);
+        get(in, fn.string_constants);
+        get(in, fn.register_count);
+        get(in, fn.param_count);
+        get(in, fn.frame_size);
+        get(in, fn.return_type);
+        get(in, fn.coroutine);
+    }
+    program.classes.resize(get_count(in, 1));
+    for (auto& cls : program.classes)
+    {
+        get(in, cls.name);
+        get(in, cls.size);
+        get(in, cls.align);
+        get(in, cls.base);
+        cls.methods.resize(get_count(in, 2 * sizeof(uint32_t)));
+        for (auto& [selector, function] : cls.methods)
+        {
+            get(in, selector);
+            get(in, function);
+        }
+    }
+    program.selectors.resize(get_count(in, 1));
+    for (auto& selector : program.selectors)
+        get(in, selector);
+    get(in, program.sites);
+    program.strings.resize(get_count(in, 1));
+    for (auto& string : program.strings)
+        get(in, string);
+    get(in, program.entry);
+    if (!in.ok || !in.data.empty())
+        return false;
+
+    // `strings` is complete, so the string constants can point into it again.
+    for (auto& fn : program.functions)
+    {
+        for (const uint32_t k : fn.string_constants)
+        {
+            if (k >= fn.constants.size() || static_cast<uint64_t>(fn.constants[k].i64) >= program.strings.size())
+                return false;
+            fn.constants[k].ref = &program.strings[fn.constants[k].i64];
+        }
+    }
+    return true;
+}
+
+void vm::flush_errors(const program_t& program)
+{
+    for (const auto& error : program.error_log)
+        std::cerr << "Error: " << error << "\n";
+}
@@ -0,0 +1,302 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "driver.h"
+#include "runtime.h"
+
+namespace
+{
+    constexpr std::string_view default_source = R"(function() -> void { var x: i32 = 0; })";
+
+    // Lexes, parses, lays out, lowers and optimizes `unit.source`; false (with the errors printed) if a
+    // stage fails.
+    bool build(driver::unit_t& unit, const bool run, const bool layout_report)
+    {
+        lexer::lexer_t lexer;
+        lexer::lexer_init(lexer, unit.source);
+        const std::vector<lexer::token_t> tokens = lexer::tokenize(lexer);
+        unit.token_count = tokens.size();
+        unit.lexer_errors = lexer.error_log;
+        lexer::flush_errors(lexer);
+        if (!run)
+            std::cout << "Token count: " << tokens.size() << std::endl;
+
+        parser::parser_init(unit.parser, tokens);
+        if (!parser::parse_program(unit.parser))
+        {
+            std::cerr << "Parsing failed." << "\n";
+            return false;
+        }
+        if (!run)
+            std::cout << "Parsing completed successfully." << "\n";
+
+        layout::layout_init(unit.layouts, unit.parser.module, { .reorder_fields = unit.reorder_fields });
+        if (!layout::compute_layouts(unit.layouts))
+        {
+            layout::flush_errors(unit.layouts);
+            return false;
+        }
+        if (layout_report)
+            layout::print_report(unit.layouts, std::cout);
+
+        if (!ir::lower_module(unit.module, unit.parser, unit.layouts))
+        {
+            ir::flush_errors(unit.module);
+            layout::flush_errors(unit.layouts);
+            return false;
+        }
+        ir::pass_manager_init(unit.passes);
+        if (unit.optimize)
+            ir::run_passes(unit.passes, unit.module);
+        return true;
+    }
+
+    // Compiles the unit's optimized IR to bytecode unless that was already done.
+    bool compile(driver::unit_t& unit)
+    {
+        if (unit.compiled)
+            return true;
+        if (!vm::compile_program(unit.program, unit.module, unit.layouts))
+        {
+            vm::flush_errors(unit.program);
+            unit.program.error_log.clear();
+            return false;
+        }
+        unit.compiled = true;
+        return true;
+    }
+
+    // Prints what `build` would have printed for a unit taken from the cache.
+    void replay(const driver::unit_t& unit, const bool run, const bool layout_report)
+    {
+        for (const auto& error : unit.lexer_errors)
+            std::cerr << error << std::endl;
+        if (!run)
+        {
+            std::cout << "Token count: " << unit.token_count << std::endl;
+            std::cout << "Parsing completed successfully." << "\n";
+        }
+        if (layout_report)
+            layout::print_report(unit.layouts, std::cout);
+    }
+}
+
+uint64_t driver::hash_source(const std::string_view source)
+{
+    // FNV-1a
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char c : source)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+bool driver::build_program(unit_t& unit, const std::string_view source)
+{
+    unit.hash = hash_source(source);
+    unit.reorder_fields = false;
+    unit.optimize = true;
+    unit.source = source;
+    unit.compiled = false;
+    return build(unit, true, false) && compile(unit);
+}
+
+int driver::execute(cache_t& cache, const std::vector<std::string>& args, const std::string& cwd)
+{
+    invocation_t invocation = {};
+    int exit_code = 0;
+    if (!prepare(cache, args, cwd, invocation, exit_code))
+        return exit_code;
+    return run_program(invocation);
+}
+
+bool driver::prepare(cache_t& cache, const std::vector<std::string>& args, const std::string& cwd, invocation_t& invocation,
+    int& exit_code)
+{
+    exit_code = 1;
+    bool layout_report = false;
+    bool dump_ir = false;
+    bool time_passes = false;
+    bool escape_report = false;
+    bool optimize = true;
+    bool dump_bytecode = false;
+    bool vm_stats = false;
+    bool reorder_fields = false;
+    uint32_t threads = 0;
+    std::string path;
+    std::string source(default_source);
+
+    // `lumen-lang run <file>` executes the program's main function on the bytecode VM.
+    const bool run = !args.empty() && args[0] == "run";
+    for (size_t i = run ? 1 : 0; i < args.size(); ++i)
+    {
+        if (const std::string_view arg = args[i]; arg == "--layout-report")
+        {
+            layout_report = true;
+        }
+        else if (arg == "--reorder-fields")
+        {
+            reorder_fields = true;
+        }
+        else if (arg == "--dump-ir")
+        {
+            dump_ir = true;
+        }
+        else if (arg == "--time-passes")
+        {
+            time_passes = true;
+        }
+        else if (arg == "--escape-report")
+        {
+            escape_report = true;
+        }
+        else if (arg == "--dump-bytecode")
+        {
+            dump_bytecode = true;
+        }
+        else if (arg == "--vm-stats")
+        {
+            vm_stats = true;
+        }
+        else if (arg == "--threads" && i + 1 < args.size())
+        {
+            const std::string& count = args[++i];
+            const auto [end, error] = std::from_chars(count.data(), count.data() + count.size(), threads);
+            if (error != std::errc() || end != count.data() + count.size() || threads > 1024)
+            {
+                std::cerr << "Invalid thread count: " << count << "\n";
+                return false;
+            }
+        }
+        else if (arg == "--no-opt")
+        {
+            optimize = false;
+        }
+        else if (arg.starts_with("--"))
+        {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+        else
+        {
+            path = (std::filesystem::path(cwd) / arg).lexically_normal().string();
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+            {
+                std::cerr << "Cannot open " << arg << "\n";
+                return false;
+            }
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            source = buffer.str();
+        }
+    }
+
+    // Only files whose content or build options changed are processed again. The hash only narrows it
+    // down; the source itself decides, so a collision cannot run another file's program.
+    const uint64_t hash = hash_source(source);
+    auto& cached = cache.units[path];
+    const bool hit = cached && cached->hash == hash && cached->reorder_fields == reorder_fields && cached->optimize == optimize
+        && cached->source == source;
+    if (hit)
+    {
+        ++cache.hits;
+        replay(*cached, run, layout_report);
+    }
+    else
+    {
+        ++cache.misses;
+        cached.reset();
+        auto unit = std::make_unique<unit_t>();
+        unit->path = path;
+        unit->hash = hash;
+        unit->reorder_fields = reorder_fields;
+        unit->optimize = optimize;
+        unit->source = std::move(source);
+        if (!build(*unit, run, layout_report))
+        {
+            cache.units.erase(path);
+            return false;
+        }
+        cached = std::move(unit);
+    }
+
+    unit_t& unit = *cached;
+    if (time_passes)
+    {
+        if (hit)
+            std::cerr << "(pass timings from the cached build; no passes ran)\n";
+        ir::print_timings(unit.passes, std::cerr);
+    }
+    if (escape_report)
+        ir::print_allocations(unit.module, unit.layouts, std::cerr);
+    if (dump_ir)
+        ir::print_module(unit.module, std::cout);
+
+    if (!run && !dump_bytecode)
+    {
+        exit_code = 0;
+        return false;
+    }
+
+    if (!compile(unit))
+        return false;
+    if (dump_bytecode)
+        vm::print_program(unit.program, std::cout);
+    exit_code = 0;
+    if (!run)
+        return false;
+
+    invocation = { &unit, threads, vm_stats };
+    return true;
+}
+
+int driver::run_program(const invocation_t& invocation)
+{
+    runtime::scheduler_t scheduler;
+    runtime::scheduler_init(scheduler, invocation.unit->program, std::cout, invocation.threads);
+    int exit_code = 0;
+    const vm::status status = runtime::run(scheduler, exit_code);
+    if (invocation.vm_stats)
+        runtime::print_stats(scheduler, std::cerr);
+    if (status != vm::status::OK)
+    {
+        std::cerr << "Runtime error: " << scheduler.error << "\n";
+        return 1;
+    }
+    return exit_code;
+}
+
+std::string driver::write_invocation(const invocation_t& invocation)
+{
+    std::string out(sizeof(invocation.threads) + 1, '\0');
+    std::memcpy(out.data(), &invocation.threads, sizeof(invocation.threads));
+    out.back() = invocation.vm_stats ? 1 : 0;
+    return out + vm::write_program(invocation.unit->program);
+}
+
+int driver::run_serialized(const std::string_view data)
+{
+    invocation_t invocation = {};
+    const auto unit = std::make_unique<unit_t>();
+    const size_t header = sizeof(invocation.threads) + 1;
+    if (data.size() < header || !vm::read_program(data.substr(header), unit->program))
+    {
+        std::cerr << "Invalid program\n";
+        return 1;
+    }
+    unit->compiled = true;
+    std::memcpy(&invocation.threads, data.data(), sizeof(invocation.threads));
+    invocation.unit = unit.get();
+    invocation.vm_stats = data[header - 1] != 0;
+    return run_program(invocation);
+}
@@ -0,0 +1,77 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#ifndef DRIVER_H
+#define DRIVER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ir.h"
+#include "lang.h"
+#include "layout.h"
+#include "vm.h"
+
+namespace driver
+{
+    // Everything built from one source file. A unit is reused as long as the file's content hash and
+    // the options that shape the build are unchanged.
+    struct unit_t
+    {
+        std::string path;
+        uint64_t hash;
+        bool reorder_fields;
+        bool optimize;
+        std::string source; // tokens point into it
+        size_t token_count;
+        std::vector<std::string> lexer_errors;
+        parser::parser_t parser;
+        layout::layout_table_t layouts;
+        ir::module_t module;
+        ir::pass_manager_t passes;
+        vm::program_t program;
+        bool compiled; // `program` holds the bytecode of `module`
+    };
+
+    struct cache_t
+    {
+        std::unordered_map<std::string, std::unique_ptr<unit_t>> units; // keyed on the absolute path
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    // A `lumen-lang run` whose program is built and ready to execute.
+    struct invocation_t
+    {
+        const unit_t* unit;
+        uint32_t threads;
+        bool vm_stats;
+    };
+
+    uint64_t hash_source(std::string_view source);
+
+    // Builds `source` through to bytecode with the default options, printing only errors. This is the
+    // pipeline `execute` runs, for tests and benchmarks that want the resulting program.
+    bool build_program(unit_t& unit, std::string_view source);
+
+    // Runs one `lumen-lang` invocation; relative paths in `args` are resolved against `cwd`. Output goes
+    // to std::cout and std::cerr, and the result is the process exit code.
+    int execute(cache_t& cache, const std::vector<std::string>& args, const std::string& cwd);
+
+    // `execute` in two steps. `prepare` does everything up to running the program and returns true if
+    // there is one to run, which `run_program` then does; otherwise `exit_code` is the invocation's result.
+    bool prepare(cache_t& cache, const std::vector<std::string>& args, const std::string& cwd, invocation_t& invocation,
+        int& exit_code);
+    int run_program(const invocation_t& invocation);
+
+    // `run_program` in another process: `write_invocation` flattens the program and its run options, and
+    // `lumen-lang run-program` hands what it reads on standard input to `run_serialized`.
+    std::string write_invocation(const invocation_t& invocation);
+    int run_serialized(std::string_view data);
+}
+
+#endif
@@ -0,0 +1,502 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <algorithm>
+#include <iomanip>
+#include <unordered_map>
+#include "ir.h"
+
+using ir::alloc_kind;
+using ir::inst_t;
+using ir::mem_kind;
+using ir::opcode;
+using ir::type_kind;
+using ir::NONE;
+
+namespace
+{
+    // A field of a scalar-replaced object, identified by its byte offset.
+    struct slot_t
+    {
+        uint32_t offset;
+        mem_kind mem;
+        type_kind type;
+        bool loaded;
+    };
+
+    struct candidate_t
+    {
+        uint32_t object;
+        std::vector<slot_t> slots;
+    };
+
+    // Escape results of parameters, keyed on `function << 32 | parameter`.
+    using summary_map_t = std::unordered_map<uint64_t, std::string>;
+
+    uint32_t mem_size(const mem_kind mem)
+    {
+        switch (mem)
+        {
+            case mem_kind::I8:
+            case mem_kind::U8: return 1;
+            case mem_kind::I16:
+            case mem_kind::U16: return 2;
+            case mem_kind::I32:
+            case mem_kind::U32:
+            case mem_kind::F32: return 4;
+            default: return 8;
+        }
+    }
+
+    bool uses(ir::function_t& fn, inst_t& inst, const uint32_t value)
+    {
+        bool found = false;
+        ir::for_each_operand(fn, inst, [&](const uint32_t& operand) { found |= operand == value; });
+        return found;
+    }
+
+    std::string parameter_escapes(ir::module_t& module, uint32_t function, uint32_t index, summary_map_t& summaries,
+        std::vector<uint32_t>& visiting);
+
+    // Returns why the object reference `value` may outlive the current call of `function`, or an empty
+    // string if every use only reads or writes through it.
+    std::string escapes(ir::module_t& module, const uint32_t function, const uint32_t value, summary_map_t& summaries,
+        std::vector<uint32_t>& visiting)
+    {
+        ir::function_t& fn = module.functions[function];
+        for (auto& inst : fn.insts)
+        {
+            if (inst.op == opcode::NOP || !uses(fn, inst, value))
+                continue;
+            switch (inst.op)
+            {
+                case opcode::LOAD:
+                case opcode::COPY:    // copies the fields, not the reference
+                case opcode::BUILTIN: // io.write prints the reference without keeping it
+                case opcode::EQ:
+                case opcode::NE:
+                    break;
+                case opcode::STORE:
+                    if (inst.c == value)
+                        return "stored into a field";
+                    break;
+                case opcode::RETURN:
+                    return "returned";
+                case opcode::PHI:
+                    return "merged with another value";
+                case opcode::CALL:
+                {
+                    if (inst.aux == static_cast<uint16_t>(ir::call_kind::VIRTUAL))
+                        return "passed to a virtual call";
+                    if (inst.aux == static_cast<uint16_t>(ir::call_kind::SPAWN))
+                        return "passed to an async call";
+                    for (uint32_t k = 0; k < inst.c; ++k)
+                    {
+                        if (fn.extra[inst.b + k] != value)
+                            continue;
+                        if (const std::string reason = parameter_escapes(module, inst.a, k, summaries, visiting); !reason.empty())
+                            return "passed to '" + module.functions[inst.a].name + "'";
+                    }
+                    break;
+                }
+                default:
+                    return "used as a value";
+            }
+        }
+        return {};
+    }
+
+    // Summarizes whether a reference passed as parameter `index` of `function` escapes; recursive calls
+    // are assumed to let it escape.
+    std::string parameter_escapes(ir::module_t& module, const uint32_t function, const uint32_t index, summary_map_t& summaries,
+        std::vector<uint32_t>& visiting)
+    {
+        const uint64_t key = static_cast<uint64_t>(function) << 32 | index;
+        if (const auto it = summaries.find(key); it != summaries.end())
+            return it->second;
+        if (std::ranges::find(visiting, function) != visiting.end())
+            return "recursive call";
+
+        const ir::function_t& fn = module.functions[function];
+        if (fn.blocks.empty())
+            return "no body";
+        const auto param = std::ranges::find_if(fn.insts, [&](const inst_t& inst) { return inst.op == opcode::PARAM && inst.a == index; });
+        if (param == fn.insts.end())
+            return {};
+
+        visiting.push_back(function);
+        std::string reason = escapes(module, function, static_cast<uint32_t>(param - fn.insts.begin()), summaries, visiting);
+        visiting.pop_back();
+        summaries.emplace(key, reason);
+        return reason;
+    }
+
+    bool add_slot(std::vector<slot_t>& slots, const uint32_t offset, const mem_kind mem, const type_kind type, const bool loaded)
+    {
+        const auto it = std::ranges::find_if(slots, [&](const slot_t& slot) { return slot.offset == offset; });
+        if (it == slots.end())
+        {
+            slots.push_back({ offset, mem, type, loaded });
+            return true;
+        }
+        if (it->mem != mem || it->type != type)
+            return false;
+        it->loaded |= loaded;
+        return true;
+    }
+
+    // Collects the fields accessed through `object`; false if some use needs the object in memory.
+    bool collect_slots(ir::function_t& fn, const uint32_t object, std::vector<slot_t>& slots)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> copies; // byte ranges copied into the object
+        for (auto& inst : fn.insts)
+        {
+            if (inst.op == opcode::NOP || !uses(fn, inst, object))
+                continue;
+            switch (inst.op)
+            {
+                case opcode::LOAD:
+                    if (!add_slot(slots, inst.b, static_cast<mem_kind>(inst.aux), inst.type, true))
+                        return false;
+                    break;
+                case opcode::STORE:
+                    if (inst.c == object || !add_slot(slots, inst.b, static_cast<mem_kind>(inst.aux), fn.insts[inst.c].type, false))
+                        return false;
+                    break;
+                case opcode::COPY:
+                    if (inst.b == object)
+                        return false;
+                    copies.emplace_back(fn.extra[inst.c], fn.extra[inst.c] + fn.extra[inst.c + 2]);
+                    break;
+                default:
+                    return false;
+            }
+        }
+
+        std::ranges::sort(slots, {}, &slot_t::offset);
+        for (size_t k = 0; k + 1 < slots.size(); ++k)
+        {
+            if (slots[k].offset + mem_size(slots[k].mem) > slots[k + 1].offset)
+                return false;
+        }
+        return std::ranges::all_of(copies, [&](const auto& range)
+        {
+            return std::ranges::all_of(slots, [&](const slot_t& slot)
+            {
+                const uint32_t end = slot.offset + mem_size(slot.mem);
+                return end <= range.first || slot.offset >= range.second || (slot.offset >= range.first && end <= range.second);
+            });
+        });
+    }
+
+    bool dominates(const std::vector<uint32_t>& idom, const uint32_t a, uint32_t b)
+    {
+        while (b != a && b != 0 && idom[b] != NONE)
+            b = idom[b];
+        return b == a;
+    }
+
+    std::vector<std::vector<uint32_t>> dominance_frontiers(const ir::cfg_t& cfg, const std::vector<uint32_t>& idom)
+    {
+        std::vector<std::vector<uint32_t>> frontiers(idom.size());
+        for (uint32_t b = 0; b < idom.size(); ++b)
+        {
+            if (cfg.pred_offsets[b + 1] - cfg.pred_offsets[b] < 2)
+                continue;
+            for (uint32_t i = cfg.pred_offsets[b]; i < cfg.pred_offsets[b + 1]; ++i)
+            {
+                for (uint32_t runner = cfg.preds[i]; runner != idom[b] && runner != NONE; runner = idom[runner])
+                {
+                    if (std::ranges::find(frontiers[runner], b) == frontiers[runner].end())
+                        frontiers[runner].push_back(b);
+                    if (runner == 0)
+                        break;
+                }
+            }
+        }
+        return frontiers;
+    }
+
+    uint32_t resolve(const std::vector<uint32_t>& replacement, uint32_t value)
+    {
+        while (value < replacement.size() && replacement[value] != value)
+            value = replacement[value];
+        return value;
+    }
+
+    // Applies the truncation a store into a narrow field would perform, so the value read back is the same.
+    uint32_t truncate(ir::function_t& fn, const uint32_t block, const uint32_t value, const slot_t& slot, std::vector<uint32_t>& created)
+    {
+        const auto add = [&](const inst_t& inst)
+        {
+            created.push_back(ir::emit(fn, inst));
+            return created.back();
+        };
+        switch (slot.mem)
+        {
+            case mem_kind::U8:
+            case mem_kind::U16:
+            {
+                if (slot.type == type_kind::BOOL)
+                    return value;
+                const uint32_t mask = add({ opcode::CONST, type_kind::I32, 0, block, slot.mem == mem_kind::U8 ? 0xFFu : 0xFFFFu, 0, 0 });
+                return add({ opcode::AND, type_kind::I32, 0, block, value, mask, 0 });
+            }
+            case mem_kind::I8:
+            case mem_kind::I16:
+            {
+                const uint32_t shift = add({ opcode::CONST, type_kind::I32, 0, block, slot.mem == mem_kind::I8 ? 24u : 16u, 0, 0 });
+                const uint32_t high = add({ opcode::SHL, type_kind::I32, 0, block, value, shift, 0 });
+                return add({ opcode::SHR, type_kind::I32, 0, block, high, shift, 0 });
+            }
+            case mem_kind::U32:
+            {
+                const uint32_t mask = add({ opcode::CONST, type_kind::I64, 0, block, 0xFFFFFFFFu, 0, 0 });
+                return add({ opcode::AND, type_kind::I64, 0, block, value, mask, 0 });
+            }
+            default:
+                return value;
+        }
+    }
+
+    // Replaces the fields of `candidate` with SSA values: phis go on the iterated dominance frontier of
+    // the blocks that write a field, and loads take the value reaching them along the dominator tree.
+    void replace_fields(ir::function_t& fn, const candidate_t& candidate, const ir::cfg_t& cfg, const std::vector<uint32_t>& idom,
+        const std::vector<std::vector<uint32_t>>& frontiers, std::vector<uint32_t>& replacement, std::vector<std::vector<uint32_t>>& before)
+    {
+        const uint32_t object = candidate.object;
+        const uint32_t home = fn.insts[object].block;
+        const auto& slots = candidate.slots;
+        const size_t block_count = fn.blocks.size();
+        const auto find_slot = [&](const uint32_t offset)
+        {
+            return static_cast<size_t>(std::ranges::find(slots, offset, &slot_t::offset) - slots.begin());
+        };
+
+        // Blocks that define each field: the allocation itself, stores and copies into the object.
+        std::vector<std::vector<uint32_t>> defs(slots.size(), { home });
+        for (const auto& inst : fn.insts)
+        {
+            if (inst.op == opcode::STORE && inst.a == object)
+                defs[find_slot(inst.b)].push_back(inst.block);
+            else if (inst.op == opcode::COPY && inst.a == object)
+            {
+                for (auto& blocks : defs)
+                    blocks.push_back(inst.block);
+            }
+        }
+
+        std::vector<std::vector<uint32_t>> phis(slots.size(), std::vector<uint32_t>(block_count, NONE));
+        for (size_t s = 0; s < slots.size(); ++s)
+        {
+            if (!slots[s].loaded)
+                continue;
+            std::vector<uint32_t> worklist = defs[s];
+            while (!worklist.empty())
+            {
+                const uint32_t b = worklist.back();
+                worklist.pop_back();
+                for (const uint32_t f : frontiers[b])
+                {
+                    if (f == home || phis[s][f] != NONE || !dominates(idom, home, f))
+                        continue;
+                    phis[s][f] = ir::emit(fn, { opcode::PHI, slots[s].type, 0, f, 0, 0, 0 });
+                    worklist.push_back(f);
+                }
+            }
+        }
+
+        std::vector<std::vector<uint32_t>> ends(slots.size(), std::vector<uint32_t>(block_count, NONE));
+        std::vector<uint32_t> current(slots.size(), NONE);
+        for (uint32_t b = 0; b < block_count; ++b)
+        {
+            if (!dominates(idom, home, b))
+                continue;
+            for (size_t s = 0; s < slots.size(); ++s)
+                current[s] = b == home ? NONE : phis[s][b] != NONE ? phis[s][b] : ends[s][idom[b]];
+
+            for (uint32_t i = fn.blocks[b].first; i < fn.blocks[b].first + fn.blocks[b].count; ++i)
+            {
+                inst_t& inst = fn.insts[i];
+                if (i == object)
+                {
+                    for (size_t s = 0; s < slots.size(); ++s)
+                    {
+                        if (!slots[s].loaded)
+                            continue;
+                        before[i].push_back(ir::emit(fn, { opcode::CONST, slots[s].type, 0, b, 0, 0, 0 }));
+                        current[s] = before[i].back();
+                    }
+                }
+                else if (inst.op == opcode::LOAD && inst.a == object)
+                {
+                    replacement[i] = current[find_slot(inst.b)];
+                    fn.insts[i].op = opcode::NOP;
+                }
+                else if (inst.op == opcode::STORE && inst.a == object)
+                {
+                    const size_t s = find_slot(inst.b);
+                    const slot_t slot = slots[s];
+                    const uint32_t value = resolve(replacement, inst.c);
+                    fn.insts[i].op = opcode::NOP;
+                    if (slot.loaded)
+                        current[s] = truncate(fn, b, value, slot, before[i]);
+                }
+                else if (inst.op == opcode::COPY && inst.a == object)
+                {
+                    const uint32_t dst = fn.extra[inst.c];
+                    const uint32_t src = fn.extra[inst.c + 1];
+                    const uint32_t size = fn.extra[inst.c + 2];
+                    const uint32_t source = inst.b;
+                    fn.insts[i].op = opcode::NOP;
+                    for (size_t s = 0; s < slots.size(); ++s)
+                    {
+                        if (!slots[s].loaded || slots[s].offset < dst || slots[s].offset >= dst + size)
+                            continue;
+                        const uint32_t offset = slots[s].offset - dst + src;
+                        before[i].push_back(ir::emit(fn, { opcode::LOAD, slots[s].type, static_cast<uint16_t>(slots[s].mem), b, source, offset, 0 }));
+                        current[s] = before[i].back();
+                    }
+                }
+            }
+            for (size_t s = 0; s < slots.size(); ++s)
+                ends[s][b] = current[s];
+        }
+
+        for (size_t s = 0; s < slots.size(); ++s)
+        {
+            for (uint32_t b = 0; b < block_count; ++b)
+            {
+                if (phis[s][b] == NONE)
+                    continue;
+                std::vector<uint32_t> pairs;
+                for (uint32_t i = cfg.pred_offsets[b]; i < cfg.pred_offsets[b + 1]; ++i)
+                {
+                    pairs.push_back(cfg.preds[i]);
+                    pairs.push_back(ends[s][cfg.preds[i]]);
+                }
+                inst_t& phi = fn.insts[phis[s][b]];
+                phi.a = ir::append_extra(fn, pairs);
+                phi.b = static_cast<uint32_t>(pairs.size() / 2);
+            }
+        }
+        fn.insts[object].op = opcode::NOP;
+    }
+
+    // Renumbers the function so that the instructions created for an original instruction come directly
+    // in front of it; `compact` keeps that order within each block.
+    void splice(ir::function_t& fn, const std::vector<std::vector<uint32_t>>& before)
+    {
+        std::vector<uint32_t> order;
+        std::vector<uint8_t> placed(fn.insts.size(), 0);
+        for (uint32_t i = 0; i < before.size(); ++i)
+        {
+            for (const uint32_t created : before[i])
+            {
+                order.push_back(created);
+                placed[created] = 1;
+            }
+            order.push_back(i);
+        }
+        for (auto i = static_cast<uint32_t>(before.size()); i < fn.insts.size(); ++i)
+        {
+            if (!placed[i])
+                order.push_back(i);
+        }
+
+        std::vector<uint32_t> index(fn.insts.size());
+        std::vector<inst_t> insts;
+        insts.reserve(fn.insts.size());
+        for (uint32_t k = 0; k < order.size(); ++k)
+        {
+            index[order[k]] = k;
+            insts.push_back(fn.insts[order[k]]);
+        }
+        fn.insts = std::move(insts);
+        for (auto& inst : fn.insts)
+        {
+            if (inst.op != opcode::NOP)
+                ir::for_each_operand(fn, inst, [&](uint32_t& operand) { operand = index[operand]; });
+        }
+    }
+}
+
+bool ir::eliminate_allocations(module_t& module, const uint32_t function)
+{
+    std::erase_if(module.allocations, [&](const allocation_t& allocation) { return allocation.function == function; });
+
+    summary_map_t summaries;
+    std::vector<uint32_t> visiting = { function };
+    std::vector<candidate_t> candidates;
+    bool changed = false;
+    for (uint32_t i = 0; i < module.functions[function].insts.size(); ++i)
+    {
+        function_t& fn = module.functions[function];
+        inst_t& inst = fn.insts[i];
+        if (inst.op != opcode::NEW)
+            continue;
+
+        allocation_t allocation = { function, inst.a, static_cast<alloc_kind>(inst.aux), {} };
+        if (allocation.kind == alloc_kind::HEAP)
+        {
+            allocation.reason = escapes(module, function, i, summaries, visiting);
+            if (candidate_t candidate = { i, {} }; allocation.reason.empty() && collect_slots(fn, i, candidate.slots))
+            {
+                allocation.kind = alloc_kind::SCALAR;
+                candidates.push_back(std::move(candidate));
+            }
+            else if (allocation.reason.empty() && module.class_aligns[inst.a] > FRAME_ALIGN)
+            {
+                allocation.reason = "aligned to " + std::to_string(module.class_aligns[inst.a]) + " bytes, more than a frame provides";
+            }
+            else if (allocation.reason.empty())
+            {
+                allocation.kind = alloc_kind::STACK;
+                inst.aux = static_cast<uint16_t>(alloc_kind::STACK);
+                changed = true;
+            }
+        }
+        module.allocations.push_back(std::move(allocation));
+    }
+    if (candidates.empty())
+        return changed;
+
+    function_t& fn = module.functions[function];
+    const cfg_t cfg = compute_cfg(fn);
+    const std::vector<uint32_t> idom = compute_idom(fn, cfg);
+    const auto frontiers = dominance_frontiers(cfg, idom);
+    std::vector<std::vector<uint32_t>> before(fn.insts.size());
+    std::vector<uint32_t> replacement(fn.insts.size());
+    for (uint32_t i = 0; i < replacement.size(); ++i)
+        replacement[i] = i;
+
+    for (const auto& candidate : candidates)
+        replace_fields(fn, candidate, cfg, idom, frontiers, replacement, before);
+
+    for (auto i = static_cast<uint32_t>(replacement.size()); i < fn.insts.size(); ++i)
+        replacement.push_back(i);
+    replace_uses(fn, replacement);
+    splice(fn, before);
+    compact(fn);
+    return true;
+}
+
+void ir::print_allocations(const module_t& module, const layout::layout_table_t& layouts, std::ostream& out)
+{
+    static constexpr std::string_view kind_t[] = { "heap", "stack", "scalar replaced" };
+
+    size_t eliminated = 0;
+    out << "===== Allocations =====\n";
+    out << std::left << std::setw(20) << "function" << std::setw(16) << "class" << "placement\n";
+    for (const auto& allocation : module.allocations)
+    {
+        eliminated += allocation.kind != alloc_kind::HEAP;
+        out << std::left << std::setw(20) << module.functions[allocation.function].name << std::setw(16)
+            << layouts.classes[allocation.class_id].name << kind_t[static_cast<size_t>(allocation.kind)];
+        if (!allocation.reason.empty())
+            out << " (" << allocation.reason << ")";
+        out << "\n";
+    }
+    out << eliminated << " of " << module.allocations.size() << " allocation(s) removed from the heap\n";
+}
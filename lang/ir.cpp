@@ -0,0 +1,568 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include "ir.h"
+
+static constexpr std::array<std::string_view, static_cast<size_t>(ir::opcode::COUNT)> opcode_t = {
+    "nop", "const", "param", "phi",
+    "add", "sub", "mul", "div", "rem", "and", "or", "xor", "shl", "shr",
+    "neg", "not",
+    "eq", "ne", "lt", "le", "gt", "ge",
+    "convert", "call", "builtin", "await", "new", "load", "store", "copy",
+    "jump", "branch", "return",
+};
+
+static constexpr std::array<std::string_view, 9> type_t = {
+    "void", "bool", "i32", "i64", "f32", "f64", "str", "ref", "task",
+};
+
+bool ir::is_pure(const opcode op)
+{
+    return (op >= opcode::CONST && op <= opcode::CONVERT && op != opcode::DIV && op != opcode::REM) || op == opcode::NEW;
+}
+
+bool ir::is_pure(const function_t& function, const inst_t& inst)
+{
+    // Integer division traps on a zero divisor, so it may only be removed or merged when the divisor is a
+    // non-zero constant. Floating-point division never traps.
+    if (inst.op == opcode::DIV || inst.op == opcode::REM)
+    {
+        if (inst.type == type_kind::F32 || inst.type == type_kind::F64)
+            return true;
+        const inst_t& divisor = function.insts[inst.b];
+        return divisor.op == opcode::CONST && const_bits(divisor) != 0;
+    }
+    return is_pure(inst.op);
+}
+
+bool ir::is_terminator(const opcode op)
+{
+    return op == opcode::JUMP || op == opcode::BRANCH || op == opcode::RETURN;
+}
+
+std::string_view ir::opcode_name(const opcode op)
+{
+    return opcode_t[static_cast<size_t>(op)];
+}
+
+std::string_view ir::type_name(const type_kind type)
+{
+    return type_t[static_cast<size_t>(type)];
+}
+
+uint32_t ir::emit(function_t& function, const inst_t& inst)
+{
+    function.insts.push_back(inst);
+    return static_cast<uint32_t>(function.insts.size() - 1);
+}
+
+uint32_t ir::emit_const(function_t& function, const uint32_t block, const type_kind type, const uint64_t bits)
+{
+    return emit(function, { opcode::CONST, type, 0, block, static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32), 0 });
+}
+
+uint64_t ir::const_bits(const inst_t& inst)
+{
+    return static_cast<uint64_t>(inst.a) | static_cast<uint64_t>(inst.b) << 32;
+}
+
+uint32_t ir::append_extra(function_t& function, const std::vector<uint32_t>& values)
+{
+    const auto offset = static_cast<uint32_t>(function.extra.size());
+    function.extra.insert(function.extra.end(), values.begin(), values.end());
+    return offset;
+}
+
+static void successors(const ir::inst_t& terminator, uint32_t (&out)[2], uint32_t& count)
+{
+    count = 0;
+    if (terminator.op == ir::opcode::JUMP)
+    {
+        out[count++] = terminator.a;
+    }
+    else if (terminator.op == ir::opcode::BRANCH)
+    {
+        out[count++] = terminator.b;
+        if (terminator.c != terminator.b)
+            out[count++] = terminator.c;
+    }
+}
+
+ir::cfg_t ir::compute_cfg(const function_t& function)
+{
+    const size_t n = function.blocks.size();
+    cfg_t cfg;
+    cfg.succ_offsets.assign(n + 1, 0);
+    cfg.pred_offsets.assign(n + 1, 0);
+
+    for (size_t b = 0; b < n; ++b)
+    {
+        const block_t& block = function.blocks[b];
+        uint32_t targets[2];
+        uint32_t count = 0;
+        if (block.count != 0)
+            successors(function.insts[block.first + block.count - 1], targets, count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            cfg.succs.push_back(targets[i]);
+            ++cfg.pred_offsets[targets[i] + 1];
+        }
+        cfg.succ_offsets[b + 1] = static_cast<uint32_t>(cfg.succs.size());
+    }
+
+    for (size_t b = 0; b < n; ++b)
+        cfg.pred_offsets[b + 1] += cfg.pred_offsets[b];
+    cfg.preds.resize(cfg.succs.size());
+    std::vector<uint32_t> fill(cfg.pred_offsets.begin(), cfg.pred_offsets.end() - 1);
+    for (size_t b = 0; b < n; ++b)
+    {
+        for (uint32_t i = cfg.succ_offsets[b]; i < cfg.succ_offsets[b + 1]; ++i)
+            cfg.preds[fill[cfg.succs[i]]++] = static_cast<uint32_t>(b);
+    }
+    return cfg;
+}
+
+std::vector<uint32_t> ir::compute_idom(const function_t& function, const cfg_t& cfg)
+{
+    // Cooper, Harvey & Kennedy; blocks are numbered in reverse post-order after `compact`.
+    std::vector<uint32_t> idom(function.blocks.size(), NONE);
+    if (idom.empty())
+        return idom;
+    idom[0] = 0;
+
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (uint32_t b = 1; b < idom.size(); ++b)
+        {
+            uint32_t new_idom = NONE;
+            for (uint32_t i = cfg.pred_offsets[b]; i < cfg.pred_offsets[b + 1]; ++i)
+            {
+                uint32_t p = cfg.preds[i];
+                if (idom[p] == NONE)
+                    continue;
+                if (new_idom == NONE)
+                {
+                    new_idom = p;
+                    continue;
+                }
+                uint32_t q = new_idom;
+                while (p != q)
+                {
+                    while (p > q)
+                        p = idom[p];
+                    while (q > p)
+                        q = idom[q];
+                }
+                new_idom = p;
+            }
+            if (new_idom != idom[b])
+            {
+                idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+size_t ir::live_count(const function_t& function)
+{
+    return static_cast<size_t>(std::ranges::count_if(function.insts, [](const inst_t& inst) { return inst.op != opcode::NOP; }));
+}
+
+void ir::replace_uses(function_t& function, std::vector<uint32_t>& replacement)
+{
+    const auto resolve = [&](uint32_t value)
+    {
+        uint32_t root = value;
+        while (root < replacement.size() && replacement[root] != root)
+            root = replacement[root];
+        while (value < replacement.size() && replacement[value] != root)
+        {
+            const uint32_t next = replacement[value];
+            replacement[value] = root;
+            value = next;
+        }
+        return root;
+    };
+
+    for (auto& inst : function.insts)
+    {
+        if (inst.op != opcode::NOP)
+            for_each_operand(function, inst, [&](uint32_t& operand) { operand = resolve(operand); });
+    }
+}
+
+void ir::compact(function_t& function)
+{
+    const size_t block_count = function.blocks.size();
+
+    // Bucket the live instructions of each block, keeping phis first and the terminator last.
+    std::vector<std::vector<uint32_t>> members(block_count);
+    for (uint32_t i = 0; i < function.insts.size(); ++i)
+    {
+        if (function.insts[i].op != opcode::NOP)
+            members[function.insts[i].block].push_back(i);
+    }
+    const auto rank = [&](const uint32_t i)
+    {
+        const opcode op = function.insts[i].op;
+        return op == opcode::PHI ? 0 : is_terminator(op) ? 2 : 1;
+    };
+    for (auto& list : members)
+        std::ranges::stable_sort(list, [&](const uint32_t x, const uint32_t y) { return rank(x) < rank(y); });
+
+    // Reverse post-order over the reachable blocks.
+    std::vector<uint32_t> order;
+    std::vector<uint8_t> state(block_count, 0);
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    if (block_count != 0)
+    {
+        stack.emplace_back(0, 0);
+        state[0] = 1;
+    }
+    while (!stack.empty())
+    {
+        auto& [b, next] = stack.back();
+        uint32_t targets[2];
+        uint32_t count = 0;
+        if (!members[b].empty() && is_terminator(function.insts[members[b].back()].op))
+            successors(function.insts[members[b].back()], targets, count);
+        if (next < count)
+        {
+            const uint32_t s = targets[next++];
+            if (state[s] == 0)
+            {
+                state[s] = 1;
+                stack.emplace_back(s, 0);
+            }
+            continue;
+        }
+        order.push_back(b);
+        stack.pop_back();
+    }
+    std::ranges::reverse(order);
+
+    // Merge a block into its predecessor when it is that predecessor's only jump target and has
+    // no other predecessors; the merged block's instructions follow the predecessor's body.
+    std::vector<uint32_t> pred_count(block_count, 0);
+    for (const uint32_t b : order)
+    {
+        uint32_t targets[2];
+        uint32_t count = 0;
+        if (!members[b].empty())
+            successors(function.insts[members[b].back()], targets, count);
+        for (uint32_t t = 0; t < count; ++t)
+            ++pred_count[targets[t]];
+    }
+    std::vector<uint32_t> merged_into(block_count, NONE);
+    for (const uint32_t b : order)
+    {
+        if (merged_into[b] != NONE)
+            continue;
+        while (!members[b].empty() && function.insts[members[b].back()].op == opcode::JUMP)
+        {
+            const uint32_t s = function.insts[members[b].back()].a;
+            if (s == b || s == 0 || pred_count[s] != 1 || merged_into[s] != NONE
+                || (!members[s].empty() && function.insts[members[s].front()].op == opcode::PHI))
+                break;
+            members[b].pop_back();
+            members[b].insert(members[b].end(), members[s].begin(), members[s].end());
+            members[s].clear();
+            merged_into[s] = b;
+        }
+    }
+    std::erase_if(order, [&](const uint32_t b) { return merged_into[b] != NONE; });
+
+    std::vector<uint32_t> block_map(block_count, NONE);
+    for (uint32_t i = 0; i < order.size(); ++i)
+        block_map[order[i]] = i;
+    for (uint32_t b = 0; b < block_count; ++b)
+    {
+        if (merged_into[b] != NONE)
+            block_map[b] = block_map[merged_into[b]];
+    }
+
+    std::vector<uint32_t> value_map(function.insts.size(), NONE);
+    uint32_t next_index = 0;
+    for (const uint32_t b : order)
+    {
+        for (const uint32_t i : members[b])
+            value_map[i] = next_index++;
+    }
+
+    // Actual predecessors in the new numbering, so phis can drop entries of removed edges.
+    std::vector<std::vector<uint32_t>> preds(order.size());
+    for (const uint32_t b : order)
+    {
+        uint32_t targets[2];
+        uint32_t count = 0;
+        if (!members[b].empty())
+            successors(function.insts[members[b].back()], targets, count);
+        for (uint32_t t = 0; t < count; ++t)
+            preds[block_map[targets[t]]].push_back(block_map[b]);
+    }
+
+    const auto map_value = [&](const uint32_t v) { return v < value_map.size() ? value_map[v] : NONE; };
+
+    std::vector<inst_t> insts;
+    std::vector<uint32_t> extra;
+    std::vector<block_t> blocks(order.size(), { 0, 0 });
+    insts.reserve(next_index);
+    for (uint32_t nb = 0; nb < order.size(); ++nb)
+    {
+        blocks[nb].first = static_cast<uint32_t>(insts.size());
+        for (const uint32_t i : members[order[nb]])
+        {
+            inst_t inst = function.insts[i];
+            inst.block = nb;
+            switch (inst.op)
+            {
+                case opcode::PHI:
+                {
+                    const auto offset = static_cast<uint32_t>(extra.size());
+                    for (uint32_t k = 0; k < inst.b; ++k)
+                    {
+                        const uint32_t pred = block_map[function.extra[inst.a + 2 * k]];
+                        const bool is_pred = pred != NONE && std::ranges::find(preds[nb], pred) != preds[nb].end();
+                        bool seen = false;
+                        for (auto e = offset; e < extra.size(); e += 2)
+                            seen |= extra[e] == pred;
+                        if (is_pred && !seen)
+                        {
+                            extra.push_back(pred);
+                            extra.push_back(map_value(function.extra[inst.a + 2 * k + 1]));
+                        }
+                    }
+                    inst.a = offset;
+                    inst.b = static_cast<uint32_t>(extra.size() - offset) / 2;
+                    break;
+                }
+                case opcode::CALL:
+                case opcode::BUILTIN:
+                {
+                    const auto offset = static_cast<uint32_t>(extra.size());
+                    for (uint32_t k = 0; k < inst.c; ++k)
+                        extra.push_back(map_value(function.extra[inst.b + k]));
+                    inst.b = offset;
+                    break;
+                }
+                case opcode::COPY:
+                {
+                    const auto offset = static_cast<uint32_t>(extra.size());
+                    extra.insert(extra.end(), function.extra.begin() + inst.c, function.extra.begin() + inst.c + 3);
+                    inst.a = map_value(inst.a);
+                    inst.b = map_value(inst.b);
+                    inst.c = offset;
+                    break;
+                }
+                case opcode::JUMP:
+                    inst.a = block_map[inst.a];
+                    break;
+                case opcode::BRANCH:
+                    inst.a = map_value(inst.a);
+                    inst.b = block_map[inst.b];
+                    inst.c = block_map[inst.c];
+                    break;
+                default:
+                {
+                    function_t& f = function;
+                    for_each_operand(f, inst, [&](uint32_t& operand) { operand = map_value(operand); });
+                    break;
+                }
+            }
+            insts.push_back(inst);
+        }
+        blocks[nb].count = static_cast<uint32_t>(insts.size()) - blocks[nb].first;
+    }
+
+    function.insts = std::move(insts);
+    function.extra = std::move(extra);
+    function.blocks = std::move(blocks);
+}
+
+bool ir::verify(const function_t& function, std::string& error)
+{
+    const cfg_t cfg = compute_cfg(function);
+    const auto fail = [&](const uint32_t i, const std::string& message)
+    {
+        error = function.name + ": %" + std::to_string(i) + ": " + message;
+        return false;
+    };
+
+    for (uint32_t b = 0; b < function.blocks.size(); ++b)
+    {
+        const block_t& block = function.blocks[b];
+        if (block.count == 0)
+            return fail(block.first, "empty block b" + std::to_string(b));
+
+        bool past_phis = false;
+        for (uint32_t i = block.first; i < block.first + block.count; ++i)
+        {
+            inst_t inst = function.insts[i];
+            if (inst.block != b)
+                return fail(i, "instruction outside of its block range");
+            if (inst.op == opcode::NOP)
+                return fail(i, "nop in compacted function");
+            if (is_terminator(inst.op) != (i == block.first + block.count - 1))
+                return fail(i, "terminator must end its block");
+            if (inst.op == opcode::PHI)
+            {
+                if (past_phis)
+                    return fail(i, "phi after non-phi instruction");
+                if (inst.b != cfg.pred_offsets[b + 1] - cfg.pred_offsets[b])
+                    return fail(i, "phi entries do not match predecessors");
+            }
+            past_phis |= inst.op != opcode::PHI;
+
+            bool ok = true;
+            auto& f = const_cast<function_t&>(function);
+            for_each_operand(f, inst, [&](const uint32_t& operand)
+            {
+                ok &= operand < function.insts.size() && (inst.op == opcode::PHI || operand < i || function.insts[operand].block != b);
+            });
+            if (!ok)
+                return fail(i, "operand is undefined or used before its definition");
+        }
+    }
+    return true;
+}
+
+int32_t ir::find_function(const module_t& module, const std::string_view name)
+{
+    const auto it = std::ranges::find_if(module.functions, [&](const function_t& f) { return f.name == name; });
+    return it != module.functions.end() ? static_cast<int32_t>(it - module.functions.begin()) : -1;
+}
+
+static void print_const(const ir::module_t& module, const ir::inst_t& inst, std::ostream& out)
+{
+    const uint64_t bits = ir::const_bits(inst);
+    switch (inst.type)
+    {
+        case ir::type_kind::BOOL:
+            out << (bits != 0 ? "true" : "false");
+            break;
+        case ir::type_kind::I32:
+            out << static_cast<int32_t>(bits);
+            break;
+        case ir::type_kind::I64:
+            out << static_cast<int64_t>(bits);
+            break;
+        case ir::type_kind::F32:
+            out << std::bit_cast<float>(static_cast<uint32_t>(bits));
+            break;
+        case ir::type_kind::F64:
+            out << std::bit_cast<double>(bits);
+            break;
+        case ir::type_kind::STR:
+            out << '"' << module.strings[bits] << '"';
+            break;
+        default:
+            out << bits;
+    }
+}
+
+void ir::print_function(const module_t& module, const function_t& function, std::ostream& out)
+{
+    out << "function " << function.name << "(";
+    for (size_t i = 0; i < function.params.size(); ++i)
+        out << (i != 0 ? ", " : "") << type_name(function.params[i]);
+    out << ") -> " << type_name(function.return_type) << "\n";
+
+    for (uint32_t b = 0; b < function.blocks.size(); ++b)
+    {
+        out << "b" << b << ":\n";
+        for (uint32_t i = function.blocks[b].first; i < function.blocks[b].first + function.blocks[b].count; ++i)
+        {
+            const inst_t& inst = function.insts[i];
+            out << "    ";
+            if (inst.type != type_kind::VOID)
+                out << "%" << i << " = ";
+            out << opcode_name(inst.op);
+            if (inst.type != type_kind::VOID)
+                out << "." << type_name(inst.type);
+            if (inst.op != opcode::RETURN || inst.a != NONE)
+                out << " ";
+
+            switch (inst.op)
+            {
+                case opcode::CONST:
+                    print_const(module, inst, out);
+                    break;
+                case opcode::PARAM:
+                    out << inst.a;
+                    break;
+                case opcode::PHI:
+                    for (uint32_t k = 0; k < inst.b; ++k)
+                        out << (k != 0 ? ", " : "") << "[b" << function.extra[inst.a + 2 * k] << ": %" << function.extra[inst.a + 2 * k + 1] << "]";
+                    break;
+                case opcode::CALL:
+                case opcode::BUILTIN:
+                    if (inst.op == opcode::CALL)
+                        out << (inst.aux == static_cast<uint16_t>(call_kind::VIRTUAL) ? "virtual "
+                            : inst.aux == static_cast<uint16_t>(call_kind::SPAWN) ? "spawn " : "") << module.functions[inst.a].name;
+                    else
+                        out << "write";
+                    out << "(";
+                    for (uint32_t k = 0; k < inst.c; ++k)
+                        out << (k != 0 ? ", " : "") << "%" << function.extra[inst.b + k];
+                    out << ")";
+                    break;
+                case opcode::NEW:
+                    out << "class#" << inst.a << (inst.aux == static_cast<uint16_t>(alloc_kind::STACK) ? " stack" : "");
+                    break;
+                case opcode::LOAD:
+                    out << "%" << inst.a << "+" << inst.b;
+                    break;
+                case opcode::STORE:
+                    out << "%" << inst.a << "+" << inst.b << ", %" << inst.c;
+                    break;
+                case opcode::COPY:
+                    out << "%" << inst.a << "+" << function.extra[inst.c] << ", %" << inst.b << "+" << function.extra[inst.c + 1]
+                        << ", " << function.extra[inst.c + 2];
+                    break;
+                case opcode::JUMP:
+                    out << "b" << inst.a;
+                    break;
+                case opcode::BRANCH:
+                    out << "%" << inst.a << ", b" << inst.b << ", b" << inst.c;
+                    break;
+                case opcode::RETURN:
+                    if (inst.a != NONE)
+                        out << "%" << inst.a;
+                    break;
+                case opcode::NEG:
+                case opcode::NOT:
+                case opcode::CONVERT:
+                case opcode::AWAIT:
+                    out << "%" << inst.a;
+                    break;
+                default:
+                    out << "%" << inst.a << ", %" << inst.b;
+            }
+            out << "\n";
+        }
+    }
+}
+
+void ir::print_module(const module_t& module, std::ostream& out)
+{
+    for (const auto& function : module.functions)
+    {
+        print_function(module, function, out);
+        out << "\n";
+    }
+}
+
+void ir::flush_errors(const module_t& module)
+{
+    for (const auto& error : module.error_log)
+        std::cerr << error << std::endl;
+}
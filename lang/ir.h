@@ -0,0 +1,281 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#ifndef IR_H
+#define IR_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lang.h"
+#include "layout.h"
+
+namespace ir
+{
+    constexpr uint32_t NONE = UINT32_MAX;
+    constexpr uint32_t FRAME_ALIGN = 8; // strictest alignment of an object kept in a VM frame: one register slot
+
+    enum class type_kind : uint8_t
+    {
+        VOID,
+        BOOL,
+        I32,
+        I64,
+        F32,
+        F64,
+        STR,
+        REF,
+        TASK, // handle of a running `async` call
+    };
+
+    // Width and signedness of a field in memory; values are widened to `type_kind` on load.
+    enum class mem_kind : uint8_t
+    {
+        I8,
+        U8,
+        I16,
+        U16,
+        I32,
+        U32,
+        I64,
+        F32,
+        F64,
+        STR,
+        REF,
+    };
+
+    // `aux` of CALL: virtual calls dispatch on the class of argument 0 at run time; calls to `async`
+    // functions start a task and produce its TASK handle instead of the return value.
+    enum class call_kind : uint8_t
+    {
+        DIRECT,
+        VIRTUAL,
+        SPAWN,
+    };
+
+    // `aux` of NEW: where the object lives. Objects that never escape the function are placed in
+    // its frame; scalar replacement removes the allocation altogether.
+    enum class alloc_kind : uint8_t
+    {
+        HEAP,
+        STACK,
+        SCALAR,
+    };
+
+    enum class builtin : uint8_t
+    {
+        WRITE, // io.write(value)
+    };
+
+    enum class opcode : uint8_t
+    {
+        NOP,
+        CONST,   // a, b = low/high 32 bits of the payload
+        PARAM,   // a = parameter index
+        PHI,     // a = offset into `extra`, b = count of (block, value) pairs
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        REM,
+        AND,
+        OR,
+        XOR,
+        SHL,
+        SHR,
+        NEG,     // a
+        NOT,     // a, logical for BOOL, bitwise otherwise
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+        CONVERT, // a, to the instruction type
+        CALL,    // a = callee function index, b = offset into `extra`, c = argument count, aux = call_kind
+        BUILTIN, // aux = builtin, b = offset into `extra`, c = argument count
+        AWAIT,   // a = task, the result of its call once it has finished
+        NEW,     // a = class layout id, aux = alloc_kind
+        LOAD,    // a = object, b = byte offset, aux = mem_kind
+        STORE,   // a = object, b = byte offset, c = value, aux = mem_kind
+        COPY,    // a = dst object, b = src object, c = offset into `extra` (dst offset, src offset, size)
+        JUMP,    // a = target block
+        BRANCH,  // a = condition, b = true block, c = false block
+        RETURN,  // a = value or NONE
+        COUNT
+    };
+
+    struct inst_t
+    {
+        opcode op;
+        type_kind type;
+        uint16_t aux;
+        uint32_t block;
+        uint32_t a;
+        uint32_t b;
+        uint32_t c;
+    };
+
+    // Instructions of a block are the contiguous range [first, first + count).
+    struct block_t
+    {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct function_t
+    {
+        std::string name;
+        std::vector<inst_t> insts;
+        std::vector<block_t> blocks;
+        std::vector<uint32_t> extra; // variable-length operands: phi pairs, call arguments, copy descriptors
+        std::vector<type_kind> params;
+        type_kind return_type;
+        int32_t decl;   // index into parser::module_t::functions
+        int32_t owner;  // layout id of the class for methods, -1 otherwise
+        int32_t selector; // index into module_t::selectors for instance methods, -1 otherwise
+        uint16_t modifiers;
+    };
+
+    // Outcome of escape analysis for one allocation site.
+    struct allocation_t
+    {
+        uint32_t function;
+        uint32_t class_id;
+        alloc_kind kind;
+        std::string reason; // why an allocation stays on the heap
+    };
+
+    struct module_t
+    {
+        std::vector<function_t> functions;
+        std::vector<allocation_t> allocations;
+        std::vector<uint32_t> class_aligns; // alignment of each class layout, by layout id
+        std::vector<std::string> selectors; // instance method names
+        std::vector<std::string> strings;
+        std::vector<std::string> error_log;
+    };
+
+    // Control flow graph in compressed rows; successors/predecessors of block `b` are
+    // `succs[succ_offsets[b] .. succ_offsets[b + 1])` and likewise for predecessors.
+    struct cfg_t
+    {
+        std::vector<uint32_t> succ_offsets;
+        std::vector<uint32_t> succs;
+        std::vector<uint32_t> pred_offsets;
+        std::vector<uint32_t> preds;
+    };
+
+    struct pass_t
+    {
+        std::string_view name;
+        bool (*run)(module_t& module, uint32_t function); // returns true if the function changed
+    };
+
+    struct pass_timing_t
+    {
+        std::string_view name;
+        std::chrono::nanoseconds time;
+        uint32_t runs;
+        int64_t insts_removed;
+    };
+
+    using pass_hook_t = std::function<void(std::string_view pass, const function_t& function, std::chrono::nanoseconds time)>;
+
+    struct pass_manager_t
+    {
+        std::vector<pass_t> passes;
+        std::vector<pass_timing_t> timings;
+        pass_hook_t hook;
+    };
+
+    bool is_pure(opcode op);
+    bool is_pure(const function_t& function, const inst_t& inst);
+    bool is_terminator(opcode op);
+    std::string_view opcode_name(opcode op);
+    std::string_view type_name(type_kind type);
+
+    uint32_t emit(function_t& function, const inst_t& inst);
+    uint32_t emit_const(function_t& function, uint32_t block, type_kind type, uint64_t bits);
+    uint64_t const_bits(const inst_t& inst);
+    uint32_t append_extra(function_t& function, const std::vector<uint32_t>& values);
+
+    template<typename F>
+    void for_each_operand(function_t& function, inst_t& inst, F&& f);
+
+    cfg_t compute_cfg(const function_t& function);
+    std::vector<uint32_t> compute_idom(const function_t& function, const cfg_t& cfg);
+    size_t live_count(const function_t& function);
+
+    void replace_uses(function_t& function, std::vector<uint32_t>& replacement);
+    void compact(function_t& function);
+    bool verify(const function_t& function, std::string& error);
+
+    bool lower_module(module_t& module, const parser::parser_t& parser, layout::layout_table_t& layouts);
+    int32_t find_function(const module_t& module, std::string_view name);
+
+    bool fold_constants(module_t& module, uint32_t function);
+    bool eliminate_dead_code(module_t& module, uint32_t function);
+    bool number_values(module_t& module, uint32_t function);
+    bool inline_calls(module_t& module, uint32_t function);
+    bool eliminate_allocations(module_t& module, uint32_t function);
+
+    void pass_manager_init(pass_manager_t& manager);
+    void run_passes(pass_manager_t& manager, module_t& module);
+    void print_timings(const pass_manager_t& manager, std::ostream& out);
+    void print_allocations(const module_t& module, const layout::layout_table_t& layouts, std::ostream& out);
+
+    void print_function(const module_t& module, const function_t& function, std::ostream& out);
+    void print_module(const module_t& module, std::ostream& out);
+    void flush_errors(const module_t& module);
+}
+
+template<typename F>
+void ir::for_each_operand(function_t& function, inst_t& inst, F&& f)
+{
+    switch (inst.op)
+    {
+        case opcode::NOP:
+        case opcode::CONST:
+        case opcode::PARAM:
+        case opcode::NEW:
+        case opcode::JUMP:
+            break;
+        case opcode::PHI:
+            for (uint32_t i = 0; i < inst.b; ++i)
+                f(function.extra[inst.a + 2 * i + 1]);
+            break;
+        case opcode::CALL:
+        case opcode::BUILTIN:
+            for (uint32_t i = 0; i < inst.c; ++i)
+                f(function.extra[inst.b + i]);
+            break;
+        case opcode::NEG:
+        case opcode::NOT:
+        case opcode::CONVERT:
+        case opcode::AWAIT:
+        case opcode::LOAD:
+        case opcode::BRANCH:
+            f(inst.a);
+            break;
+        case opcode::RETURN:
+            if (inst.a != NONE)
+                f(inst.a);
+            break;
+        case opcode::STORE:
+            f(inst.a);
+            f(inst.c);
+            break;
+        default: // binary operators and COPY
+            f(inst.a);
+            f(inst.b);
+            break;
+    }
+}
+
+#endif
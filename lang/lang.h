@@ -5,7 +5,9 @@
 #ifndef LANG_H
 #define LANG_H
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -79,11 +81,92 @@ namespace lexer
 
 namespace parser
 {
+    enum class modifier : uint16_t
+    {
+        NONE = 0,
+        PUBLIC = 1 << 0,
+        PRIVATE = 1 << 1,
+        STATIC = 1 << 2,
+        INLINE = 1 << 3,
+        VIRTUAL = 1 << 4,
+        FINAL = 1 << 5,
+        ASYNC = 1 << 6,
+        CONST = 1 << 7,
+        CONSTRUCTOR = 1 << 8,
+    };
+
+    constexpr bool has_modifier(const uint16_t modifiers, const modifier m)
+    {
+        return (modifiers & static_cast<uint16_t>(m)) != 0;
+    }
+
+    struct type_ref_t
+    {
+        std::string_view name;
+        std::vector<std::string_view> args;
+        bool nullable;
+        bool array;
+    };
+
+    struct annotations_t
+    {
+        bool packed;
+        bool deprecated;
+        bool aligned_cache_line; // bare `@aligned`
+        uint32_t aligned;        // `@aligned(N)`, 0 if absent
+    };
+
+    struct param_t
+    {
+        std::string_view name;
+        type_ref_t type;
+    };
+
+    struct field_decl_t
+    {
+        std::string_view name;
+        type_ref_t type;
+        uint16_t modifiers;
+        size_t init_begin; // token range of the initializer, empty if none
+        size_t init_end;
+    };
+
+    struct function_decl_t
+    {
+        std::string_view name;
+        std::vector<param_t> params;
+        type_ref_t return_type;
+        uint16_t modifiers;
+        int32_t owner;     // index into module_t::classes, -1 for free functions
+        size_t body_begin; // token range between the braces
+        size_t body_end;
+    };
+
+    struct class_decl_t
+    {
+        std::string_view name;
+        std::string_view base;
+        std::vector<std::string_view> generics;
+        std::vector<field_decl_t> fields;
+        std::vector<size_t> methods; // indices into module_t::functions
+        annotations_t annotations;
+        uint16_t modifiers;
+    };
+
+    struct module_t
+    {
+        std::string_view package;
+        std::vector<class_decl_t> classes;
+        std::vector<function_decl_t> functions;
+        std::vector<field_decl_t> globals;
+    };
+
     struct parser_t
     {
         size_t token_index;
         std::unique_ptr<std::vector<lexer::token_t>> tokens;
         std::vector<std::string> error_log;
+        module_t module;
     };
 
     void parser_init(parser_t& parser, const std::vector<lexer::token_t>& tokens);
@@ -96,9 +179,16 @@ namespace parser
     inline bool expect_value(parser_t& parser, const std::string_view& value);
 
     bool parse_program(parser_t& parser);
-    bool parse_function(parser_t& parser);
+    bool parse_annotation(parser_t& parser, annotations_t& annotations);
+    bool parse_class(parser_t& parser, const annotations_t& annotations, uint16_t modifiers);
+    bool parse_function(parser_t& parser, uint16_t modifiers = 0, int32_t owner = -1);
     bool parse_expression(parser_t& parser);
-    bool parse_variable(parser_t& parser);
+    bool parse_variable(parser_t& parser, std::vector<field_decl_t>& out, uint16_t modifiers = 0);
+    bool parse_type(parser_t& parser, type_ref_t& type);
+    bool parse_parameters(parser_t& parser, std::vector<param_t>& params);
+    bool skip_block(parser_t& parser, size_t& begin, size_t& end);
+
+    const class_decl_t* find_class(const module_t& module, std::string_view name);
 
     void log_error(parser_t& parser, const std::string& message);
 }
@@ -0,0 +1,369 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <tuple>
+#include "layout.h"
+
+static constexpr std::array<std::tuple<std::string_view, uint32_t, uint32_t>, 12> scalar_t = {{
+    { "u8", 1, 1 },
+    { "i8", 1, 1 },
+    { "boolean", 1, 1 },
+    { "u16", 2, 2 },
+    { "i16", 2, 2 },
+    { "u32", 4, 4 },
+    { "i32", 4, 4 },
+    { "f32", 4, 4 },
+    { "u64", 8, 8 },
+    { "i64", 8, 8 },
+    { "f64", 8, 8 },
+    { "string", 2 * layout::POINTER_SIZE, layout::POINTER_SIZE },
+}};
+
+static constexpr uint32_t align_up(const uint32_t value, const uint32_t align)
+{
+    return (value + align - 1) & ~(align - 1);
+}
+
+static std::string_view substitute(const layout::class_layout_t& layout, const std::string_view name)
+{
+    const auto it = std::ranges::find_if(layout.bindings, [&](const auto& b) { return b.first == name; });
+    return it != layout.bindings.end() ? it->second : name;
+}
+
+static std::string type_name(const std::string_view name, const std::vector<std::string_view>& args)
+{
+    std::string result(name);
+    if (!args.empty())
+    {
+        result += '<';
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            if (i != 0)
+                result += ", ";
+            result += args[i];
+        }
+        result += '>';
+    }
+    return result;
+}
+
+static void reportError(layout::layout_table_t& table, const std::string& msg)
+{
+    table.error_log.push_back(msg);
+}
+
+static bool resolve_field(layout::layout_table_t& table, const uint32_t owner, const parser::field_decl_t& decl, layout::field_layout_t& field)
+{
+    std::vector<std::string_view> args;
+    for (const auto arg : decl.type.args)
+        args.push_back(substitute(table.classes[owner], arg));
+
+    const std::string_view name = substitute(table.classes[owner], decl.type.name);
+    field = { decl.name, type_name(name, args), 0, 0, 1, -1 };
+    if (decl.type.array)
+    {
+        field.type = "[" + field.type + "]";
+        field.size = 2 * layout::POINTER_SIZE;
+        field.align = layout::POINTER_SIZE;
+        return true;
+    }
+    if (decl.type.nullable)
+        field.type += '?';
+
+    if (name == "Unique" || name == "Shared" || (decl.type.nullable && !std::ranges::any_of(scalar_t, [&](const auto& s) { return std::get<0>(s) == name; })))
+    {
+        field.size = layout::POINTER_SIZE;
+        field.align = layout::POINTER_SIZE;
+        return true;
+    }
+
+    if (const auto it = std::ranges::find_if(scalar_t, [&](const auto& s) { return std::get<0>(s) == name; }); it != scalar_t.end())
+    {
+        field.align = std::get<2>(*it);
+        field.size = decl.type.nullable ? align_up(std::get<1>(*it) + 1, field.align) : std::get<1>(*it);
+        return true;
+    }
+
+    if (name == "void" || name == "auto")
+    {
+        reportError(table, "Field '" + std::string(decl.name) + "' of class '" + table.classes[owner].name + "' cannot have type '" + std::string(name) + "'");
+        return false;
+    }
+
+    const int32_t id = layout::layout_of(table, name, args);
+    if (id < 0)
+        return false;
+    if (!table.classes[id].complete)
+    {
+        reportError(table, "Class '" + table.classes[id].name + "' contains itself by value through field '" + std::string(decl.name) + "'");
+        return false;
+    }
+    field.size = table.classes[id].size;
+    field.align = table.classes[id].align;
+    field.class_id = id;
+    return true;
+}
+
+static uint32_t place_fields(std::vector<layout::field_layout_t>& fields, const size_t first, uint32_t offset, const bool packed)
+{
+    for (size_t i = first; i < fields.size(); ++i)
+    {
+        if (!packed)
+            offset = align_up(offset, fields[i].align);
+        fields[i].offset = offset;
+        offset += fields[i].size;
+    }
+    return offset;
+}
+
+static void sort_for_padding(std::vector<layout::field_layout_t>& fields, const size_t first)
+{
+    std::stable_sort(fields.begin() + static_cast<std::ptrdiff_t>(first), fields.end(), [](const auto& a, const auto& b)
+    {
+        return a.align != b.align ? a.align > b.align : a.size > b.size;
+    });
+}
+
+// Calls to a `final` method, or on a receiver of a `final` class, are bound directly, so neither may be
+// overridden.
+static bool check_overrides(layout::layout_table_t& table, const uint32_t id, const int32_t base)
+{
+    const parser::module_t& module = *table.module;
+    const parser::class_decl_t& decl = module.classes[table.classes[id].decl];
+    if (parser::has_modifier(module.classes[table.classes[base].decl].modifiers, parser::modifier::FINAL))
+    {
+        reportError(table, "Class '" + table.classes[id].name + "' cannot extend final class '" + table.classes[base].name + "'");
+        return false;
+    }
+
+    bool ok = true;
+    for (const size_t method : decl.methods)
+    {
+        const std::string name(module.functions[method].name);
+        for (int32_t c = base; c >= 0; c = table.classes[c].base)
+        {
+            const auto& methods = module.classes[table.classes[c].decl].methods;
+            const auto found = std::ranges::find_if(methods, [&](const size_t m) { return module.functions[m].name == name; });
+            if (found == methods.end())
+                continue;
+            if (parser::has_modifier(module.functions[*found].modifiers, parser::modifier::FINAL))
+            {
+                reportError(table, "Method '" + table.classes[id].name + "." + name + "' overrides final method '"
+                    + table.classes[c].name + "." + name + "'");
+                ok = false;
+            }
+            break;
+        }
+    }
+    return ok;
+}
+
+static bool build_layout(layout::layout_table_t& table, const uint32_t id)
+{
+    const parser::class_decl_t& decl = table.module->classes[table.classes[id].decl];
+    const parser::annotations_t& annotations = decl.annotations;
+    const bool packed = annotations.packed;
+    const bool annotated = packed || annotations.aligned != 0 || annotations.aligned_cache_line;
+
+    std::vector<layout::field_layout_t> fields;
+    uint32_t start = 0;
+    uint32_t align = 1;
+    int32_t base = -1;
+    if (!decl.base.empty())
+    {
+        base = layout::layout_of(table, decl.base);
+        if (base < 0)
+            return false;
+        if (!table.classes[base].complete)
+        {
+            reportError(table, "Class '" + table.classes[id].name + "' inherits from itself");
+            return false;
+        }
+        if (!check_overrides(table, id, base))
+            return false;
+        fields = table.classes[base].fields;
+        start = table.classes[base].size;
+        align = table.classes[base].align;
+    }
+    const size_t base_field_count = fields.size();
+
+    for (const auto& field_decl : decl.fields)
+    {
+        if (parser::has_modifier(field_decl.modifiers, parser::modifier::STATIC))
+            continue;
+        layout::field_layout_t field;
+        if (!resolve_field(table, id, field_decl, field))
+            return false;
+        fields.push_back(std::move(field));
+    }
+
+    for (size_t i = base_field_count; i < fields.size() && !packed; ++i)
+        align = std::max(align, fields[i].align);
+    align = std::max(align, annotations.aligned);
+    if (annotations.aligned_cache_line)
+        align = std::max(align, layout::CACHE_LINE_SIZE);
+
+    const uint32_t declared_size = align_up(place_fields(fields, base_field_count, start, packed), align);
+
+    auto sorted = fields;
+    sort_for_padding(sorted, base_field_count);
+    const uint32_t reordered_size = align_up(place_fields(sorted, base_field_count, start, packed), align);
+
+    const bool reorder = table.options.reorder_fields && !annotated && reordered_size < declared_size;
+    if (reorder)
+        fields = std::move(sorted);
+
+    const uint32_t end = fields.empty() ? start : fields.back().offset + fields.back().size;
+    uint32_t data_size = 0;
+    for (const auto& field : fields)
+        data_size += field.size;
+
+    layout::class_layout_t& layout = table.classes[id];
+    layout.base = base;
+    layout.size = reorder ? reordered_size : declared_size;
+    layout.align = align;
+    layout.data_size = data_size;
+    layout.interior_padding = std::max(end, start) - data_size;
+    layout.tail_padding = layout.size - std::max(end, start);
+    layout.declared_size = declared_size;
+    layout.reordered_size = reordered_size;
+    layout.base_field_count = base_field_count;
+    layout.packed = packed;
+    layout.reordered = reorder;
+    layout.fields = std::move(fields);
+    layout.complete = true;
+    return true;
+}
+
+void layout::layout_init(layout_table_t& table, const parser::module_t& module, const layout_options_t options)
+{
+    table.module = &module;
+    table.options = options;
+    table.classes.clear();
+    table.error_log.clear();
+}
+
+bool layout::compute_layouts(layout_table_t& table)
+{
+    for (const auto& decl : table.module->classes)
+    {
+        if (decl.generics.empty())
+            layout_of(table, decl.name);
+    }
+    return table.error_log.empty();
+}
+
+int32_t layout::layout_of(layout_table_t& table, const std::string_view name, const std::vector<std::string_view>& args)
+{
+    const std::string full_name = type_name(name, args);
+    if (const auto it = std::ranges::find_if(table.classes, [&](const class_layout_t& c) { return c.name == full_name; }); it != table.classes.end())
+        return static_cast<int32_t>(it->id);
+
+    const auto decl = std::ranges::find_if(table.module->classes, [&](const parser::class_decl_t& c) { return c.name == name; });
+    if (decl == table.module->classes.end())
+    {
+        reportError(table, "Unknown type '" + full_name + "'");
+        return -1;
+    }
+    if (decl->generics.size() != args.size())
+    {
+        reportError(table, "Class '" + std::string(name) + "' expects " + std::to_string(decl->generics.size()) + " type argument(s), got " + std::to_string(args.size()));
+        return -1;
+    }
+
+    const auto id = static_cast<uint32_t>(table.classes.size());
+    class_layout_t layout = {};
+    layout.name = full_name;
+    layout.id = id;
+    layout.decl = static_cast<int32_t>(decl - table.module->classes.begin());
+    layout.base = -1;
+    for (size_t i = 0; i < args.size(); ++i)
+        layout.bindings.emplace_back(decl->generics[i], args[i]);
+    table.classes.push_back(std::move(layout));
+
+    return build_layout(table, id) ? static_cast<int32_t>(id) : -1;
+}
+
+const layout::class_layout_t* layout::find_layout(const layout_table_t& table, const std::string_view name)
+{
+    const auto it = std::ranges::find_if(table.classes, [&](const class_layout_t& c) { return c.name == name; });
+    return it != table.classes.end() && it->complete ? &*it : nullptr;
+}
+
+const layout::field_layout_t* layout::find_field(const class_layout_t& layout, const std::string_view name)
+{
+    const auto it = std::ranges::find_if(layout.fields, [&](const field_layout_t& f) { return f.name == name; });
+    return it != layout.fields.end() ? &*it : nullptr;
+}
+
+bool layout::is_derived_from(const layout_table_t& table, int32_t id, const int32_t base)
+{
+    while (id >= 0)
+    {
+        if (id == base)
+            return true;
+        id = table.classes[id].base;
+    }
+    return false;
+}
+
+void layout::print_report(const layout_table_t& table, std::ostream& out)
+{
+    uint32_t total_wasted = 0;
+    for (const auto& layout : table.classes)
+    {
+        if (!layout.complete)
+            continue;
+
+        const auto& annotations = table.module->classes[layout.decl].annotations;
+        out << "class " << layout.name;
+        if (layout.base >= 0)
+            out << " extends " << table.classes[layout.base].name;
+        if (annotations.packed)
+            out << " @packed";
+        if (annotations.aligned != 0)
+            out << " @aligned(" << annotations.aligned << ")";
+        if (annotations.aligned_cache_line)
+            out << " @aligned";
+        if (layout.reordered)
+            out << " (reordered)";
+        out << "\n";
+
+        const uint32_t wasted = layout.size - layout.data_size;
+        total_wasted += wasted;
+        out << "    size " << layout.size << ", align " << layout.align << ", data " << layout.data_size
+            << ", wasted " << wasted << " (interior " << layout.interior_padding << ", tail " << layout.tail_padding << ")\n";
+
+        for (size_t i = 0; i < layout.fields.size(); ++i)
+        {
+            const auto& field = layout.fields[i];
+            out << "    +" << field.offset << "\t" << field.name << ": " << field.type << " (" << field.size << ")";
+            if (i < layout.base_field_count)
+                out << " [base]";
+            out << "\n";
+        }
+
+        if (layout.reordered)
+            out << "    reordering saved " << layout.declared_size - layout.size << " bytes\n";
+        else if (layout.reordered_size < layout.size)
+            out << "    reordering would save " << layout.size - layout.reordered_size << " bytes"
+                << (annotations.packed || annotations.aligned != 0 || annotations.aligned_cache_line ? " (disabled by annotations)" : " (--reorder-fields)") << "\n";
+    }
+
+    for (const auto& decl : table.module->classes)
+    {
+        if (!decl.generics.empty() && std::ranges::none_of(table.classes, [&](const class_layout_t& c) { return c.complete && table.module->classes[c.decl].name == decl.name; }))
+            out << "class " << decl.name << "<...> is generic and has no instantiations\n";
+    }
+    out << "total wasted: " << total_wasted << " bytes\n";
+}
+
+void layout::flush_errors(const layout_table_t& table)
+{
+    for (const auto& error : table.error_log)
+        std::cerr << error << std::endl;
+}
@@ -0,0 +1,76 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lang.h"
+
+namespace layout
+{
+    constexpr uint32_t CACHE_LINE_SIZE = 64;
+    constexpr uint32_t POINTER_SIZE = 8;
+
+    struct field_layout_t
+    {
+        std::string_view name;
+        std::string type;
+        uint32_t offset;
+        uint32_t size;
+        uint32_t align;
+        int32_t class_id; // layout id of an embedded class, -1 otherwise
+    };
+
+    struct class_layout_t
+    {
+        std::string name;
+        uint32_t id;
+        int32_t decl;          // index into module_t::classes
+        int32_t base;          // layout id of the base class, -1 if none
+        uint32_t size;
+        uint32_t align;
+        uint32_t data_size;    // sum of field sizes
+        uint32_t interior_padding;
+        uint32_t tail_padding;
+        uint32_t declared_size; // size in declaration order, differs from `size` only when reordered
+        uint32_t reordered_size; // size a padding-minimizing order would give, for the report
+        size_t base_field_count;
+        bool packed;
+        bool reordered;
+        bool complete;
+        std::vector<std::pair<std::string_view, std::string_view>> bindings; // generic parameter -> argument
+        std::vector<field_layout_t> fields; // memory order, base fields first
+    };
+
+    struct layout_options_t
+    {
+        bool reorder_fields; // reorder fields of non-annotated classes to minimize padding
+    };
+
+    struct layout_table_t
+    {
+        const parser::module_t* module;
+        layout_options_t options;
+        std::vector<class_layout_t> classes; // indexed by layout id
+        std::vector<std::string> error_log;
+    };
+
+    void layout_init(layout_table_t& table, const parser::module_t& module, layout_options_t options = {});
+    bool compute_layouts(layout_table_t& table);
+
+    int32_t layout_of(layout_table_t& table, std::string_view name, const std::vector<std::string_view>& args = {});
+    const class_layout_t* find_layout(const layout_table_t& table, std::string_view name);
+    const field_layout_t* find_field(const class_layout_t& layout, std::string_view name);
+    bool is_derived_from(const layout_table_t& table, int32_t id, int32_t base);
+
+    void print_report(const layout_table_t& table, std::ostream& out);
+    void flush_errors(const layout_table_t& table);
+}
+
+#endif
@@ -9,9 +9,10 @@
 #include <iostream>
 #include <unordered_set>
 #include "lang.h"
+#include "unicode.h"
 
 #define WHITESPACE_BITMASK_LOW (1ULL << ' ' | 1ULL << '\t' | 1ULL << '\n' | 1ULL << '\r' | 1ULL << '\v' | 1ULL << '\f')
-#define IS_WHITESPACE(c) (((unsigned char)(c) < 128) && (WHITESPACE_BITMASK_LOW & (1ULL << (c))))
+#define IS_WHITESPACE(c) (((unsigned char)(c) < 64) && (WHITESPACE_BITMASK_LOW & (1ULL << (c))))
 
 static const std::bitset<256> isAlphaTable = []
 {
@@ -146,8 +147,9 @@ inline void ADVANCE(lexer::lexer_t& lexer)
         ++lexer.position;
         lexer.current_char = lexer.position < lexer.source.size() ? lexer.source[lexer.position] : '\0';
 
+        // Columns count code points, so UTF-8 continuation bytes do not move them.
         lexer.line += lexer.current_char == '\n';
-        lexer.column = lexer.current_char == '\n' ? 1 : lexer.column + 1;
+        lexer.column = lexer.current_char == '\n' ? 1 : lexer.column + ((lexer.current_char & 0xC0) != 0x80);
     }
 }
 
@@ -156,6 +158,32 @@ inline char PEEK_NEXT(const lexer::lexer_t& lexer)
     return lexer.position + 1 < lexer.source.size() ? lexer.source[lexer.position + 1] : '\0';
 }
 
+// Byte length of the XID_Start (or XID_Continue) character at `position`, 0 if there is none there.
+static uint32_t unicodeIdentifierLength(const lexer::lexer_t& lexer, const size_t position, const bool start)
+{
+    if (position >= lexer.source.size())
+        return 0;
+    const auto [value, length] = unicode::decode(lexer.source.substr(position));
+    return length != 0 && (start ? unicode::is_xid_start(value) : unicode::is_xid_continue(value)) ? length : 0;
+}
+
+// ASCII identifier characters go through the tables; only bytes from 0x80 up are decoded.
+static void skipIdentifier(lexer::lexer_t& lexer)
+{
+    while (true)
+    {
+        while (isAlnum(lexer.current_char) || lexer.current_char == '_')
+            ADVANCE(lexer);
+        if (static_cast<unsigned char>(lexer.current_char) < 0x80)
+            return;
+        const uint32_t length = unicodeIdentifierLength(lexer, lexer.position, false);
+        if (length == 0)
+            return;
+        for (uint32_t i = 0; i < length; ++i)
+            ADVANCE(lexer);
+    }
+}
+
 void lexer::lexer_init(lexer_t& lexer, const std::string_view source)
 {
     lexer.source = source;
@@ -166,6 +194,15 @@ void lexer::lexer_init(lexer_t& lexer, const std::string_view source)
     lexer.column = 1;
     lexer.tokens.clear();
     lexer.error_log.clear();
+
+    if (!unicode::validate_utf8(source))
+    {
+        const std::string_view before = source.substr(0, unicode::find_invalid_utf8(source));
+        const size_t line_start = before.rfind('\n') + 1; // 0 on the first line
+        const auto line = std::ranges::count(before, '\n') + 1;
+        const auto column = std::ranges::count_if(before.substr(line_start), [](const char c) { return (c & 0xC0) != 0x80; }) + 1;
+        reportError(lexer, "Invalid UTF-8 at line " + std::to_string(line) + ", column " + std::to_string(column));
+    }
 }
 
 void lexer::skip_whitespace_comment(lexer_t& lexer)
@@ -230,10 +267,7 @@ lexer::token_t lexer::handle_annotation(lexer_t& lexer)
 lexer::token_t lexer::handle_identifier(lexer_t& lexer)
 {
     const auto start = lexer.position;
-    while (isAlnum(lexer.current_char) || lexer.current_char == '_')
-    {
-        ADVANCE(lexer);
-    }
+    skipIdentifier(lexer);
 
     if (lexer.current_char == '.' && PEEK_NEXT(lexer) == '.' && lexer.source[lexer.position + 2] == '.')
     {
@@ -243,13 +277,10 @@ lexer::token_t lexer::handle_identifier(lexer_t& lexer)
         return { token_type::IDENTIFIER, lexer.source.substr(start, lexer.position - start) };
     }
 
-    while (lexer.current_char == '.' && isAlpha(PEEK_NEXT(lexer)))
+    while (lexer.current_char == '.' && (isAlpha(PEEK_NEXT(lexer)) || unicodeIdentifierLength(lexer, lexer.position + 1, true) != 0))
     {
         ADVANCE(lexer);
-        while (isAlnum(lexer.current_char) || lexer.current_char == '_')
-        {
-            ADVANCE(lexer);
-        }
+        skipIdentifier(lexer);
     }
 
     std::string_view identifier = lexer.source.substr(start, lexer.position - start);
@@ -423,9 +454,16 @@ lexer::token_t lexer::handle_type(lexer_t& lexer)
 
 lexer::token_t lexer::handle_unknown(lexer_t& lexer)
 {
-    const std::string error_msg = "Unknown character '" + std::string(1, lexer.current_char) + "' at line " + std::to_string(lexer.line) + ", column " + std::to_string(lexer.column);
-    reportError(lexer, error_msg);
-    ADVANCE(lexer);
+    // One error per character; bytes that are not UTF-8 at all were reported by `lexer_init`.
+    const auto start = lexer.position;
+    const uint32_t length = static_cast<unsigned char>(lexer.current_char) < 0x80 ? 1 : unicode::decode(lexer.source.substr(start)).length;
+    if (length != 0)
+    {
+        const std::string error_msg = "Unknown character '" + std::string(lexer.source.substr(start, length)) + "' at line " + std::to_string(lexer.line) + ", column " + std::to_string(lexer.column);
+        reportError(lexer, error_msg);
+    }
+    for (uint32_t i = 0; i < std::max(length, 1u); ++i)
+        ADVANCE(lexer);
     return { token_type::UNKNOWN, {} };
 }
 
@@ -469,6 +507,10 @@ lexer::token_t lexer::next_token(lexer_t& lexer)
                 {
                     lexer.state = state_i::PUNCTUAL_STATE;
                 }
+                else if (static_cast<unsigned char>(lexer.current_char) >= 0x80 && unicodeIdentifierLength(lexer, lexer.position, true) != 0)
+                {
+                    lexer.state = state_i::IDENTIFIER_STATE;
+                }
                 else
                 {
                     lexer.state = state_i::UNKNOWN_STATE;
@@ -0,0 +1,1600 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+// Lowers parsed function bodies straight from their token ranges into SSA form, building phis on
+// the fly as in Braun et al., "Simple and Efficient Construction of Static Single Assignment Form".
+//
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <map>
+#include <unordered_map>
+#include "ir.h"
+
+using ir::opcode;
+using ir::type_kind;
+using ir::NONE;
+
+namespace
+{
+    struct value_t
+    {
+        uint32_t id;
+        type_kind type;
+        int32_t class_id; // static class of a REF, index into `lowering_t::tasks` for a TASK, -1 if unknown
+        bool literal;     // untyped literal, adopts the type of the other operand
+    };
+
+    struct variable_t
+    {
+        std::string_view name;
+        uint32_t var;
+        type_kind type;
+        int32_t class_id;
+        bool constant;
+    };
+
+    struct resolved_type_t
+    {
+        type_kind type;
+        ir::mem_kind mem;
+        int32_t class_id;
+        bool embedded; // class stored by value inside another object
+    };
+
+    enum class lvalue_kind : uint8_t
+    {
+        VARIABLE,
+        FIELD,
+    };
+
+    struct lvalue_t
+    {
+        lvalue_kind kind;
+        size_t variable;   // index into scope
+        uint32_t object;
+        uint32_t offset;
+        resolved_type_t field;
+    };
+
+    struct pending_t
+    {
+        int32_t decl;
+        int32_t owner;
+        uint32_t function;
+    };
+
+    struct lowering_t
+    {
+        ir::module_t& module;
+        const parser::parser_t& parser;
+        layout::layout_table_t& layouts;
+        const std::vector<lexer::token_t>& tokens;
+
+        std::map<std::pair<int32_t, int32_t>, uint32_t> function_ids {}; // (decl, owner layout) -> function
+        std::vector<pending_t> worklist {};
+        std::vector<std::pair<int32_t, int32_t>> dispatched {}; // (receiver layout, method decl) of virtual call sites
+        std::vector<std::pair<type_kind, int32_t>> tasks {}; // (type, class) a `Task<T>` produces when awaited
+
+        uint32_t function = 0;
+        int32_t owner = 0;
+        size_t pos = 0;
+        size_t end = 0;
+        uint32_t block = 0;
+        bool ok = false;
+
+        std::vector<variable_t> scope {};
+        std::vector<type_kind> var_types {};
+        std::vector<std::vector<uint32_t>> preds {};
+        std::vector<uint8_t> sealed {};
+        std::vector<uint8_t> closed {}; // block already has its terminator
+        std::vector<std::unordered_map<uint32_t, uint32_t>> defs {}; // per block: variable -> value
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> incomplete {}; // per block: (variable, phi)
+        std::vector<uint32_t> replacement {};
+        std::vector<std::pair<uint32_t, uint32_t>> loops {}; // (continue target, break target)
+    };
+
+    constexpr std::array<std::tuple<std::string_view, type_kind, ir::mem_kind>, 12> scalar_t = {{
+        { "boolean", type_kind::BOOL, ir::mem_kind::U8 },
+        { "i8", type_kind::I32, ir::mem_kind::I8 },
+        { "u8", type_kind::I32, ir::mem_kind::U8 },
+        { "i16", type_kind::I32, ir::mem_kind::I16 },
+        { "u16", type_kind::I32, ir::mem_kind::U16 },
+        { "i32", type_kind::I32, ir::mem_kind::I32 },
+        { "u32", type_kind::I64, ir::mem_kind::U32 },
+        { "i64", type_kind::I64, ir::mem_kind::I64 },
+        { "u64", type_kind::I64, ir::mem_kind::I64 },
+        { "f32", type_kind::F32, ir::mem_kind::F32 },
+        { "f64", type_kind::F64, ir::mem_kind::F64 },
+        { "string", type_kind::STR, ir::mem_kind::STR },
+    }};
+
+    constexpr std::array<std::pair<std::string_view, opcode>, 18> binary_t = {{
+        { "||", opcode::OR }, { "&&", opcode::AND },
+        { "|", opcode::OR }, { "&", opcode::AND },
+        { "==", opcode::EQ }, { "!=", opcode::NE },
+        { "<", opcode::LT }, { "<=", opcode::LE }, { ">", opcode::GT }, { ">=", opcode::GE },
+        { "<<", opcode::SHL }, { ">>", opcode::SHR },
+        { "+", opcode::ADD }, { "-", opcode::SUB },
+        { "*", opcode::MUL }, { "/", opcode::DIV }, { "%", opcode::REM },
+        { "^", opcode::XOR },
+    }};
+
+    int precedence(const std::string_view op)
+    {
+        if (op == "||") return 1;
+        if (op == "&&") return 2;
+        if (op == "|") return 3;
+        if (op == "^") return 4;
+        if (op == "&") return 5;
+        if (op == "==" || op == "!=") return 6;
+        if (op == "<" || op == "<=" || op == ">" || op == ">=") return 7;
+        if (op == "<<" || op == ">>") return 8;
+        if (op == "+" || op == "-") return 9;
+        if (op == "*" || op == "/" || op == "%") return 10;
+        return 0;
+    }
+
+    ir::function_t& current(lowering_t& ctx)
+    {
+        return ctx.module.functions[ctx.function];
+    }
+
+    void error(lowering_t& ctx, const std::string& message)
+    {
+        if (ctx.ok)
+            ctx.module.error_log.push_back("In function '" + current(ctx).name + "': " + message);
+        ctx.ok = false;
+    }
+
+    lexer::token_t peek(const lowering_t& ctx, const size_t ahead = 0)
+    {
+        return ctx.pos + ahead < ctx.end ? ctx.tokens[ctx.pos + ahead] : lexer::token_t{ lexer::token_type::END_OF_FILE, "" };
+    }
+
+    bool accept(lowering_t& ctx, const std::string_view value)
+    {
+        if (ctx.pos < ctx.end && ctx.tokens[ctx.pos].value == value && ctx.tokens[ctx.pos].type != lexer::token_type::STRING)
+        {
+            ++ctx.pos;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(lowering_t& ctx, const std::string_view value)
+    {
+        if (!accept(ctx, value))
+            error(ctx, "Expected '" + std::string(value) + "' but found '" + std::string(peek(ctx).value) + "'");
+    }
+
+    // --- types --------------------------------------------------------------------------------
+
+    std::string_view substitute(const lowering_t& ctx, const int32_t owner, const std::string_view name)
+    {
+        if (owner < 0)
+            return name;
+        const auto& bindings = ctx.layouts.classes[owner].bindings;
+        const auto it = std::ranges::find_if(bindings, [&](const auto& b) { return b.first == name; });
+        return it != bindings.end() ? it->second : name;
+    }
+
+    int32_t task_type(lowering_t& ctx, const type_kind type, const int32_t class_id)
+    {
+        const std::pair<type_kind, int32_t> result = { type, class_id };
+        const auto it = std::ranges::find(ctx.tasks, result);
+        if (it != ctx.tasks.end())
+            return static_cast<int32_t>(it - ctx.tasks.begin());
+        ctx.tasks.push_back(result);
+        return static_cast<int32_t>(ctx.tasks.size() - 1);
+    }
+
+    bool resolve_type(lowering_t& ctx, const parser::type_ref_t& ref, const int32_t owner, resolved_type_t& out)
+    {
+        const std::string_view name = substitute(ctx, owner, ref.name);
+        out = { type_kind::REF, ir::mem_kind::REF, -1, false };
+        if (ref.array)
+        {
+            error(ctx, "Array types are not supported by the IR yet");
+            return false;
+        }
+        if (name == "void")
+        {
+            out.type = type_kind::VOID;
+            return true;
+        }
+        if (const auto it = std::ranges::find_if(scalar_t, [&](const auto& s) { return std::get<0>(s) == name; }); it != scalar_t.end())
+        {
+            if (ref.nullable)
+            {
+                error(ctx, "Nullable scalar types are not supported by the IR yet");
+                return false;
+            }
+            out.type = std::get<1>(*it);
+            out.mem = std::get<2>(*it);
+            return true;
+        }
+
+        std::vector<std::string_view> args;
+        for (const auto arg : ref.args)
+            args.push_back(substitute(ctx, owner, arg));
+
+        if (name == "Task")
+        {
+            resolved_type_t result;
+            if (args.size() != 1)
+            {
+                error(ctx, "Task expects one type argument");
+                return false;
+            }
+            if (!resolve_type(ctx, { args[0], {}, false, false }, -1, result))
+                return false;
+            out.type = type_kind::TASK;
+            out.class_id = task_type(ctx, result.type, result.class_id);
+            return true;
+        }
+
+        if (name == "Unique" || name == "Shared")
+        {
+            if (args.size() != 1)
+            {
+                error(ctx, std::string(name) + " expects one type argument");
+                return false;
+            }
+            out.class_id = layout::layout_of(ctx.layouts, args[0]);
+            return out.class_id >= 0;
+        }
+
+        out.class_id = layout::layout_of(ctx.layouts, name, args);
+        out.embedded = !ref.nullable;
+        if (out.class_id < 0)
+        {
+            error(ctx, "Unknown type '" + std::string(name) + "'");
+            return false;
+        }
+        return true;
+    }
+
+    // Finds the declaration of a field by walking the class and its bases.
+    const parser::field_decl_t* field_decl(const lowering_t& ctx, int32_t class_id, const std::string_view name, int32_t& owner)
+    {
+        while (class_id >= 0)
+        {
+            const auto& decl = ctx.parser.module.classes[ctx.layouts.classes[class_id].decl];
+            const auto it = std::ranges::find_if(decl.fields, [&](const auto& f) { return f.name == name; });
+            if (it != decl.fields.end())
+            {
+                owner = class_id;
+                return &*it;
+            }
+            class_id = ctx.layouts.classes[class_id].base;
+        }
+        return nullptr;
+    }
+
+    // --- ssa construction ---------------------------------------------------------------------
+
+    uint32_t new_block(lowering_t& ctx)
+    {
+        current(ctx).blocks.push_back({ 0, 0 });
+        ctx.preds.emplace_back();
+        ctx.sealed.push_back(false);
+        ctx.closed.push_back(false);
+        ctx.defs.emplace_back();
+        ctx.incomplete.emplace_back();
+        return static_cast<uint32_t>(current(ctx).blocks.size() - 1);
+    }
+
+    uint32_t emit(lowering_t& ctx, const opcode op, const type_kind type, const uint32_t a = 0, const uint32_t b = 0, const uint32_t c = 0, const uint16_t aux = 0)
+    {
+        ctx.closed[ctx.block] |= ir::is_terminator(op);
+        return ir::emit(current(ctx), { op, type, aux, ctx.block, a, b, c });
+    }
+
+    uint32_t resolve(lowering_t& ctx, uint32_t value)
+    {
+        while (value < ctx.replacement.size() && ctx.replacement[value] != value)
+            value = ctx.replacement[value];
+        return value;
+    }
+
+    uint32_t zero(lowering_t& ctx, const uint32_t block, const type_kind type)
+    {
+        return ir::emit_const(current(ctx), block, type == type_kind::VOID ? type_kind::I32 : type, 0);
+    }
+
+    uint32_t read_variable(lowering_t& ctx, uint32_t var, uint32_t block);
+
+    uint32_t try_remove_trivial_phi(lowering_t& ctx, const uint32_t phi)
+    {
+        ir::function_t& fn = current(ctx);
+        uint32_t same = NONE;
+        for (uint32_t k = 0; k < fn.insts[phi].b; ++k)
+        {
+            const uint32_t op = resolve(ctx, fn.extra[fn.insts[phi].a + 2 * k + 1]);
+            if (op == same || op == phi)
+                continue;
+            if (same != NONE)
+                return phi;
+            same = op;
+        }
+        if (same == NONE)
+            same = zero(ctx, fn.insts[phi].block, fn.insts[phi].type);
+
+        if (ctx.replacement.size() < fn.insts.size())
+        {
+            const auto old_size = ctx.replacement.size();
+            ctx.replacement.resize(fn.insts.size());
+            for (auto i = old_size; i < ctx.replacement.size(); ++i)
+                ctx.replacement[i] = static_cast<uint32_t>(i);
+        }
+        ctx.replacement[phi] = same;
+        fn.insts[phi].op = opcode::NOP;
+        return same;
+    }
+
+    uint32_t add_phi_operands(lowering_t& ctx, const uint32_t var, const uint32_t phi)
+    {
+        const uint32_t block = current(ctx).insts[phi].block;
+        std::vector<uint32_t> pairs;
+        for (const uint32_t pred : ctx.preds[block])
+        {
+            pairs.push_back(pred);
+            pairs.push_back(read_variable(ctx, var, pred));
+        }
+        ir::function_t& fn = current(ctx);
+        fn.insts[phi].a = ir::append_extra(fn, pairs);
+        fn.insts[phi].b = static_cast<uint32_t>(pairs.size() / 2);
+        return try_remove_trivial_phi(ctx, phi);
+    }
+
+    uint32_t new_phi(lowering_t& ctx, const uint32_t block, const uint32_t var)
+    {
+        return ir::emit(current(ctx), { opcode::PHI, ctx.var_types[var], 0, block, 0, 0, 0 });
+    }
+
+    uint32_t read_variable(lowering_t& ctx, const uint32_t var, const uint32_t block)
+    {
+        if (const auto it = ctx.defs[block].find(var); it != ctx.defs[block].end())
+            return resolve(ctx, it->second);
+
+        uint32_t value;
+        if (!ctx.sealed[block])
+        {
+            value = new_phi(ctx, block, var);
+            ctx.incomplete[block].emplace_back(var, value);
+        }
+        else if (ctx.preds[block].size() == 1)
+        {
+            value = read_variable(ctx, var, ctx.preds[block][0]);
+        }
+        else if (ctx.preds[block].empty())
+        {
+            value = zero(ctx, block, ctx.var_types[var]);
+        }
+        else
+        {
+            value = new_phi(ctx, block, var);
+            ctx.defs[block][var] = value;
+            value = add_phi_operands(ctx, var, value);
+        }
+        ctx.defs[block][var] = value;
+        return value;
+    }
+
+    void seal(lowering_t& ctx, const uint32_t block)
+    {
+        for (const auto& [var, phi] : ctx.incomplete[block])
+            add_phi_operands(ctx, var, phi);
+        ctx.incomplete[block].clear();
+        ctx.sealed[block] = true;
+    }
+
+    bool terminated(const lowering_t& ctx)
+    {
+        return ctx.closed[ctx.block];
+    }
+
+    void jump(lowering_t& ctx, const uint32_t target)
+    {
+        if (terminated(ctx))
+            return;
+        emit(ctx, opcode::JUMP, type_kind::VOID, target);
+        ctx.preds[target].push_back(ctx.block);
+    }
+
+    void branch(lowering_t& ctx, const uint32_t condition, const uint32_t on_true, const uint32_t on_false)
+    {
+        emit(ctx, opcode::BRANCH, type_kind::VOID, condition, on_true, on_false);
+        ctx.preds[on_true].push_back(ctx.block);
+        ctx.preds[on_false].push_back(ctx.block);
+    }
+
+    // Continues lowering into a fresh unreachable block after `return`, `break` or `continue`.
+    void start_dead_block(lowering_t& ctx)
+    {
+        ctx.block = new_block(ctx);
+        seal(ctx, ctx.block);
+    }
+
+    // --- values -------------------------------------------------------------------------------
+
+    value_t constant(lowering_t& ctx, const type_kind type, const uint64_t bits, const bool literal = false)
+    {
+        return { ir::emit_const(current(ctx), ctx.block, type, bits), type, -1, literal };
+    }
+
+    int rank(const type_kind type)
+    {
+        switch (type)
+        {
+            case type_kind::I32: return 1;
+            case type_kind::I64: return 2;
+            case type_kind::F32: return 3;
+            case type_kind::F64: return 4;
+            default: return 0;
+        }
+    }
+
+    bool is_float(const type_kind type)
+    {
+        return type == type_kind::F32 || type == type_kind::F64;
+    }
+
+    value_t convert(lowering_t& ctx, const value_t& value, const type_kind type, const int32_t class_id = -1)
+    {
+        if (value.type == type)
+        {
+            if (type == type_kind::REF && class_id >= 0 && value.class_id >= 0 && !layout::is_derived_from(ctx.layouts, value.class_id, class_id))
+                error(ctx, "Cannot convert '" + ctx.layouts.classes[value.class_id].name + "' to '" + ctx.layouts.classes[class_id].name + "'");
+            if (type == type_kind::TASK && class_id >= 0 && value.class_id >= 0 && value.class_id != class_id)
+                error(ctx, "Cannot convert between tasks of different result types");
+            return { value.id, type, type == type_kind::REF && value.class_id < 0 ? class_id : value.class_id, false };
+        }
+        if (type == type_kind::BOOL && rank(value.type) != 0)
+        {
+            const value_t z = constant(ctx, value.type, 0);
+            return { emit(ctx, opcode::NE, type_kind::BOOL, value.id, z.id), type_kind::BOOL, -1, false };
+        }
+        if (rank(type) != 0 && (rank(value.type) != 0 || value.type == type_kind::BOOL))
+            return { emit(ctx, opcode::CONVERT, type, value.id), type, -1, false };
+
+        error(ctx, "Cannot convert '" + std::string(ir::type_name(value.type)) + "' to '" + std::string(ir::type_name(type)) + "'");
+        return { value.id, type, class_id, false };
+    }
+
+    type_kind common_type(const value_t& lhs, const value_t& rhs)
+    {
+        const type_kind l = lhs.type == type_kind::BOOL ? type_kind::I32 : lhs.type;
+        const type_kind r = rhs.type == type_kind::BOOL ? type_kind::I32 : rhs.type;
+        if (lhs.literal != rhs.literal && is_float(l) == is_float(r))
+            return lhs.literal ? r : l;
+        return rank(l) >= rank(r) ? l : r;
+    }
+
+    value_t lower_expression(lowering_t& ctx, int min_precedence = 1);
+    void lower_statement(lowering_t& ctx);
+
+    value_t load_lvalue(lowering_t& ctx, const lvalue_t& lvalue)
+    {
+        if (lvalue.kind == lvalue_kind::VARIABLE)
+        {
+            const variable_t& variable = ctx.scope[lvalue.variable];
+            return { read_variable(ctx, variable.var, ctx.block), variable.type, variable.class_id, false };
+        }
+        if (lvalue.field.embedded)
+        {
+            // Embedded objects are read by value into a fresh object.
+            const auto& cls = ctx.layouts.classes[lvalue.field.class_id];
+            const uint32_t copy = emit(ctx, opcode::NEW, type_kind::REF, cls.id);
+            const uint32_t extra = ir::append_extra(current(ctx), { 0, lvalue.offset, cls.size });
+            emit(ctx, opcode::COPY, type_kind::VOID, copy, lvalue.object, extra);
+            return { copy, type_kind::REF, lvalue.field.class_id, false };
+        }
+        const uint32_t id = emit(ctx, opcode::LOAD, lvalue.field.type, lvalue.object, lvalue.offset, 0, static_cast<uint16_t>(lvalue.field.mem));
+        return { id, lvalue.field.type, lvalue.field.class_id, false };
+    }
+
+    void store_lvalue(lowering_t& ctx, const lvalue_t& lvalue, const value_t& value)
+    {
+        if (lvalue.kind == lvalue_kind::VARIABLE)
+        {
+            const variable_t& variable = ctx.scope[lvalue.variable];
+            const value_t converted = convert(ctx, value, variable.type, variable.class_id);
+            ctx.defs[ctx.block][variable.var] = converted.id;
+            return;
+        }
+
+        const value_t converted = convert(ctx, value, lvalue.field.type, lvalue.field.class_id);
+        if (lvalue.field.embedded)
+        {
+            const auto& cls = ctx.layouts.classes[lvalue.field.class_id];
+            const uint32_t extra = ir::append_extra(current(ctx), { lvalue.offset, 0, cls.size });
+            emit(ctx, opcode::COPY, type_kind::VOID, lvalue.object, converted.id, extra);
+            return;
+        }
+        emit(ctx, opcode::STORE, type_kind::VOID, lvalue.object, lvalue.offset, converted.id, static_cast<uint16_t>(lvalue.field.mem));
+    }
+
+    size_t find_variable(const lowering_t& ctx, const std::string_view name)
+    {
+        for (auto i = ctx.scope.size(); i-- > 0;)
+        {
+            if (ctx.scope[i].name == name)
+                return i;
+        }
+        return SIZE_MAX;
+    }
+
+    size_t declare(lowering_t& ctx, const std::string_view name, const type_kind type, const int32_t class_id, const bool constant)
+    {
+        const auto var = static_cast<uint32_t>(ctx.var_types.size());
+        ctx.var_types.push_back(type);
+        ctx.scope.push_back({ name, var, type, class_id, constant });
+        return ctx.scope.size() - 1;
+    }
+
+    std::vector<std::string_view> split_path(const std::string_view path)
+    {
+        std::vector<std::string_view> segments;
+        size_t start = 0;
+        for (size_t dot; (dot = path.find('.', start)) != std::string_view::npos; start = dot + 1)
+            segments.push_back(path.substr(start, dot - start));
+        segments.push_back(path.substr(start));
+        return segments;
+    }
+
+    // Resolves `segments[first..]` as a chain of field accesses on `object`.
+    bool resolve_fields(lowering_t& ctx, value_t object, const std::vector<std::string_view>& segments, const size_t first, lvalue_t& out)
+    {
+        uint32_t offset = 0;
+        int32_t class_id = object.class_id;
+        for (size_t i = first; i < segments.size(); ++i)
+        {
+            if (object.type != type_kind::REF || class_id < 0)
+            {
+                error(ctx, "'" + std::string(segments[i]) + "' is not a member of a non-class value");
+                return false;
+            }
+            const auto* field = layout::find_field(ctx.layouts.classes[class_id], segments[i]);
+            int32_t owner = -1;
+            const auto* decl = field_decl(ctx, class_id, segments[i], owner);
+            if (!field || !decl)
+            {
+                error(ctx, "Class '" + ctx.layouts.classes[class_id].name + "' has no field '" + std::string(segments[i]) + "'");
+                return false;
+            }
+            resolved_type_t type;
+            if (!resolve_type(ctx, decl->type, owner, type))
+                return false;
+
+            out = { lvalue_kind::FIELD, 0, object.id, offset + field->offset, type };
+            if (i + 1 == segments.size())
+                return true;
+
+            if (type.embedded)
+            {
+                offset += field->offset;
+                class_id = type.class_id;
+            }
+            else
+            {
+                object = load_lvalue(ctx, out);
+                offset = 0;
+                class_id = object.class_id;
+            }
+        }
+        return true;
+    }
+
+    bool self_value(lowering_t& ctx, value_t& out)
+    {
+        const size_t self = find_variable(ctx, "self");
+        if (self == SIZE_MAX)
+            return false;
+        out = load_lvalue(ctx, { lvalue_kind::VARIABLE, self, 0, 0, {} });
+        return true;
+    }
+
+    bool resolve_path(lowering_t& ctx, const std::vector<std::string_view>& segments, lvalue_t& out)
+    {
+        const size_t variable = find_variable(ctx, segments[0]);
+        if (variable == SIZE_MAX)
+        {
+            // Bare field names inside methods refer to `self`.
+            value_t self;
+            if (ctx.owner >= 0 && self_value(ctx, self) && layout::find_field(ctx.layouts.classes[ctx.owner], segments[0]))
+                return resolve_fields(ctx, self, segments, 0, out);
+            error(ctx, "Unknown identifier '" + std::string(segments[0]) + "'");
+            return false;
+        }
+        out = { lvalue_kind::VARIABLE, variable, 0, 0, { ctx.scope[variable].type, ir::mem_kind::REF, ctx.scope[variable].class_id, false } };
+        if (segments.size() == 1)
+            return true;
+        return resolve_fields(ctx, load_lvalue(ctx, out), segments, 1, out);
+    }
+
+    // --- calls --------------------------------------------------------------------------------
+
+    uint32_t function_id(lowering_t& ctx, const int32_t decl, const int32_t owner)
+    {
+        if (const auto it = ctx.function_ids.find({ decl, owner }); it != ctx.function_ids.end())
+            return it->second;
+
+        const parser::function_decl_t& fd = ctx.parser.module.functions[decl];
+        ir::function_t fn = {};
+        fn.decl = decl;
+        fn.owner = owner;
+        fn.selector = -1;
+        fn.modifiers = fd.modifiers;
+        if (owner >= 0 && !parser::has_modifier(fd.modifiers, parser::modifier::STATIC) && !parser::has_modifier(fd.modifiers, parser::modifier::CONSTRUCTOR))
+        {
+            auto& selectors = ctx.module.selectors;
+            const auto it = std::ranges::find(selectors, fd.name);
+            fn.selector = static_cast<int32_t>(it - selectors.begin());
+            if (it == selectors.end())
+                selectors.emplace_back(fd.name);
+        }
+        fn.name = owner >= 0 ? ctx.layouts.classes[owner].name + "." + std::string(fd.name) : std::string(fd.name);
+        if (fd.name.empty())
+            fn.name = "<anonymous#" + std::to_string(decl) + ">";
+
+        const auto id = static_cast<uint32_t>(ctx.module.functions.size());
+        ctx.function_ids[{ decl, owner }] = id;
+        ctx.module.functions.push_back(std::move(fn));
+        ctx.worklist.push_back({ decl, owner, id });
+        return id;
+    }
+
+    bool signature(lowering_t& ctx, const uint32_t id)
+    {
+        ir::function_t& fn = ctx.module.functions[id];
+        if (!fn.params.empty() || fn.return_type != type_kind::VOID)
+            return true;
+
+        const parser::function_decl_t& fd = ctx.parser.module.functions[fn.decl];
+        std::vector<type_kind> params;
+        if (fn.owner >= 0 && !parser::has_modifier(fd.modifiers, parser::modifier::STATIC))
+            params.push_back(type_kind::REF);
+        for (const auto& param : fd.params)
+        {
+            resolved_type_t type;
+            if (!resolve_type(ctx, param.type, fn.owner, type))
+                return false;
+            params.push_back(type.type);
+        }
+
+        type_kind return_type = type_kind::VOID;
+        if (!parser::has_modifier(fd.modifiers, parser::modifier::CONSTRUCTOR) && !fd.return_type.name.empty())
+        {
+            resolved_type_t type;
+            if (!resolve_type(ctx, fd.return_type, fn.owner, type))
+                return false;
+            return_type = type.type;
+        }
+
+        ir::function_t& f = ctx.module.functions[id];
+        f.params = std::move(params);
+        f.return_type = return_type;
+        return true;
+    }
+
+    // Finds a method by name on a class or its bases; returns the declaring layout in `owner`.
+    int32_t find_method(const lowering_t& ctx, int32_t class_id, const std::string_view name, int32_t& owner)
+    {
+        while (class_id >= 0)
+        {
+            const auto& cls = ctx.parser.module.classes[ctx.layouts.classes[class_id].decl];
+            for (const size_t m : cls.methods)
+            {
+                if (ctx.parser.module.functions[m].name == name)
+                {
+                    owner = class_id;
+                    return static_cast<int32_t>(m);
+                }
+            }
+            class_id = ctx.layouts.classes[class_id].base;
+        }
+        return -1;
+    }
+
+    // A call dispatches at run time if the method, or one it overrides, is `virtual`, unless the
+    // receiver's class or the method itself is `final` so no further override can exist.
+    ir::call_kind dispatch_kind(const lowering_t& ctx, const int32_t receiver, const int32_t method, const int32_t owner)
+    {
+        const auto& module = ctx.parser.module;
+        if (parser::has_modifier(module.functions[method].modifiers, parser::modifier::FINAL)
+            || parser::has_modifier(module.classes[ctx.layouts.classes[receiver].decl].modifiers, parser::modifier::FINAL))
+            return ir::call_kind::DIRECT;
+
+        const std::string_view name = module.functions[method].name;
+        for (int32_t c = owner; c >= 0; c = ctx.layouts.classes[c].base)
+        {
+            for (const size_t m : module.classes[ctx.layouts.classes[c].decl].methods)
+            {
+                if (module.functions[m].name == name && parser::has_modifier(module.functions[m].modifiers, parser::modifier::VIRTUAL))
+                    return ir::call_kind::VIRTUAL;
+            }
+        }
+        return ir::call_kind::DIRECT;
+    }
+
+    std::vector<value_t> lower_arguments(lowering_t& ctx)
+    {
+        std::vector<value_t> args;
+        expect(ctx, "(");
+        if (accept(ctx, ")"))
+            return args;
+        do
+        {
+            args.push_back(lower_expression(ctx));
+        }
+        while (ctx.ok && accept(ctx, ","));
+        expect(ctx, ")");
+        return args;
+    }
+
+    value_t call(lowering_t& ctx, const int32_t decl, const int32_t owner, const value_t* self, const std::vector<value_t>& args,
+        const ir::call_kind kind = ir::call_kind::DIRECT)
+    {
+        const uint32_t id = function_id(ctx, decl, owner);
+        if (!signature(ctx, id))
+            return constant(ctx, type_kind::I32, 0);
+
+        const auto params = ctx.module.functions[id].params;
+        const size_t first = self ? 1 : 0;
+        if (params.size() != args.size() + first)
+        {
+            error(ctx, "'" + ctx.module.functions[id].name + "' expects " + std::to_string(params.size() - first) + " argument(s), got " + std::to_string(args.size()));
+            return constant(ctx, type_kind::I32, 0);
+        }
+
+        std::vector<uint32_t> operands;
+        if (self)
+            operands.push_back(self->id);
+        for (size_t i = 0; i < args.size(); ++i)
+            operands.push_back(convert(ctx, args[i], params[i + first]).id);
+
+        const type_kind type = ctx.module.functions[id].return_type;
+        const uint32_t extra = ir::append_extra(current(ctx), operands);
+        int32_t class_id = -1;
+        if (type == type_kind::REF)
+        {
+            const parser::function_decl_t& fd = ctx.parser.module.functions[decl];
+            resolved_type_t resolved;
+            if (resolve_type(ctx, fd.return_type, owner, resolved))
+                class_id = resolved.class_id;
+        }
+
+        // Calling an `async` function starts it as a task; the value is its handle.
+        if (parser::has_modifier(ctx.parser.module.functions[decl].modifiers, parser::modifier::ASYNC))
+        {
+            if (kind == ir::call_kind::VIRTUAL)
+                error(ctx, "Async method '" + ctx.module.functions[id].name + "' cannot be called virtually");
+            const uint32_t task = emit(ctx, opcode::CALL, type_kind::TASK, id, extra, static_cast<uint32_t>(operands.size()), static_cast<uint16_t>(ir::call_kind::SPAWN));
+            return { task, type_kind::TASK, task_type(ctx, type, class_id), false };
+        }
+        return { emit(ctx, opcode::CALL, type, id, extra, static_cast<uint32_t>(operands.size()), static_cast<uint16_t>(kind)), type, class_id, false };
+    }
+
+    value_t construct(lowering_t& ctx, const int32_t class_id)
+    {
+        const uint32_t object = emit(ctx, opcode::NEW, type_kind::REF, static_cast<uint32_t>(class_id));
+        const value_t self = { object, type_kind::REF, class_id, false };
+
+        // Field initializers run from the outermost base inwards.
+        std::vector<int32_t> chain;
+        for (int32_t c = class_id; c >= 0; c = ctx.layouts.classes[c].base)
+            chain.push_back(c);
+        for (auto it = chain.rbegin(); it != chain.rend() && ctx.ok; ++it)
+        {
+            for (const auto& field : ctx.parser.module.classes[ctx.layouts.classes[*it].decl].fields)
+            {
+                if (field.init_begin == field.init_end || parser::has_modifier(field.modifiers, parser::modifier::STATIC))
+                    continue;
+                const size_t saved_pos = ctx.pos;
+                const size_t saved_end = ctx.end;
+                ctx.pos = field.init_begin;
+                ctx.end = field.init_end;
+                const value_t value = lower_expression(ctx);
+                ctx.pos = saved_pos;
+                ctx.end = saved_end;
+
+                lvalue_t lvalue;
+                if (resolve_fields(ctx, self, { field.name }, 0, lvalue))
+                    store_lvalue(ctx, lvalue, value);
+            }
+        }
+
+        // `Class({ field = value, ... })` initializes fields by name.
+        if (peek(ctx).value == "(" && peek(ctx, 1).value == "{")
+        {
+            accept(ctx, "(");
+            accept(ctx, "{");
+            while (ctx.ok && !accept(ctx, "}"))
+            {
+                const std::string_view name = peek(ctx).value;
+                ++ctx.pos;
+                expect(ctx, "=");
+                const value_t value = lower_expression(ctx);
+                lvalue_t lvalue;
+                if (ctx.ok && resolve_fields(ctx, self, { name }, 0, lvalue))
+                    store_lvalue(ctx, lvalue, value);
+                if (!accept(ctx, ","))
+                {
+                    expect(ctx, "}");
+                    break;
+                }
+            }
+            expect(ctx, ")");
+            return self;
+        }
+
+        const std::vector<value_t> args = peek(ctx).value == "(" ? lower_arguments(ctx) : std::vector<value_t>{};
+        int32_t owner = -1;
+        const auto& cls = ctx.parser.module.classes[ctx.layouts.classes[class_id].decl];
+        if (const int32_t ctor = find_method(ctx, class_id, cls.name, owner); ctor >= 0 && owner == class_id)
+        {
+            call(ctx, ctor, class_id, &self, args);
+            return self;
+        }
+
+        // Without a constructor, positional arguments initialize the class's own fields in order.
+        size_t i = 0;
+        for (const auto& field : cls.fields)
+        {
+            if (i == args.size())
+                break;
+            if (parser::has_modifier(field.modifiers, parser::modifier::STATIC))
+                continue;
+            lvalue_t lvalue;
+            if (resolve_fields(ctx, self, { field.name }, 0, lvalue))
+                store_lvalue(ctx, lvalue, args[i++]);
+        }
+        if (i != args.size())
+            error(ctx, "Too many arguments to construct '" + ctx.layouts.classes[class_id].name + "'");
+        return self;
+    }
+
+    bool parse_type_args(lowering_t& ctx, std::vector<std::string_view>& args)
+    {
+        if (!accept(ctx, "<"))
+            return true;
+        do
+        {
+            args.push_back(substitute(ctx, ctx.owner, peek(ctx).value));
+            ++ctx.pos;
+        }
+        while (accept(ctx, ","));
+        expect(ctx, ">");
+        return ctx.ok;
+    }
+
+    bool is_class_name(const lowering_t& ctx, const std::string_view name)
+    {
+        return parser::find_class(ctx.parser.module, name) != nullptr;
+    }
+
+    value_t lower_call(lowering_t& ctx, const std::vector<std::string_view>& segments, const value_t* receiver)
+    {
+        const std::string_view name = segments.back();
+        if (!receiver && segments.size() == 2 && segments[0] == "io" && name == "write")
+        {
+            std::vector<uint32_t> operands;
+            for (const auto& arg : lower_arguments(ctx))
+                operands.push_back(arg.id);
+            const uint32_t extra = ir::append_extra(current(ctx), operands);
+            return { emit(ctx, opcode::BUILTIN, type_kind::VOID, 0, extra, static_cast<uint32_t>(operands.size()), static_cast<uint16_t>(ir::builtin::WRITE)), type_kind::VOID, -1, false };
+        }
+
+        if (!receiver && segments.size() == 1)
+        {
+            const auto& functions = ctx.parser.module.functions;
+            const auto it = std::ranges::find_if(functions, [&](const auto& f) { return f.owner < 0 && f.name == name; });
+            if (it != functions.end())
+            {
+                const auto args = lower_arguments(ctx);
+                return call(ctx, static_cast<int32_t>(it - functions.begin()), -1, nullptr, args);
+            }
+        }
+
+        // Static method on a class name: `Player.dot(...)`.
+        if (!receiver && segments.size() == 2 && is_class_name(ctx, segments[0]))
+        {
+            const int32_t class_id = layout::layout_of(ctx.layouts, segments[0]);
+            int32_t owner = -1;
+            const int32_t method = class_id >= 0 ? find_method(ctx, class_id, name, owner) : -1;
+            if (method < 0 || !parser::has_modifier(ctx.parser.module.functions[method].modifiers, parser::modifier::STATIC))
+            {
+                error(ctx, "Class '" + std::string(segments[0]) + "' has no static method '" + std::string(name) + "'");
+                return constant(ctx, type_kind::I32, 0);
+            }
+            const auto args = lower_arguments(ctx);
+            return call(ctx, method, owner, nullptr, args);
+        }
+
+        value_t object;
+        if (receiver)
+        {
+            object = *receiver;
+            if (segments.size() > 1)
+            {
+                lvalue_t lvalue;
+                if (!resolve_fields(ctx, object, { segments.begin(), segments.end() - 1 }, 0, lvalue))
+                    return constant(ctx, type_kind::I32, 0);
+                object = load_lvalue(ctx, lvalue);
+            }
+        }
+        else if (segments.size() == 1)
+        {
+            if (!self_value(ctx, object))
+            {
+                error(ctx, "Unknown function '" + std::string(name) + "'");
+                return constant(ctx, type_kind::I32, 0);
+            }
+        }
+        else
+        {
+            lvalue_t lvalue;
+            if (!resolve_path(ctx, { segments.begin(), segments.end() - 1 }, lvalue))
+                return constant(ctx, type_kind::I32, 0);
+            object = load_lvalue(ctx, lvalue);
+        }
+
+        int32_t owner = -1;
+        const int32_t method = object.type == type_kind::REF && object.class_id >= 0 ? find_method(ctx, object.class_id, name, owner) : -1;
+        if (method < 0)
+        {
+            error(ctx, "Unknown method '" + std::string(name) + "'");
+            return constant(ctx, type_kind::I32, 0);
+        }
+        const auto args = lower_arguments(ctx);
+        if (parser::has_modifier(ctx.parser.module.functions[method].modifiers, parser::modifier::STATIC))
+            return call(ctx, method, owner, nullptr, args);
+        const ir::call_kind kind = dispatch_kind(ctx, object.class_id, method, owner);
+        if (kind == ir::call_kind::VIRTUAL)
+            ctx.dispatched.emplace_back(object.class_id, method);
+        return call(ctx, method, owner, &object, args, kind);
+    }
+
+    // --- expressions --------------------------------------------------------------------------
+
+    value_t lower_literal(lowering_t& ctx, const std::string_view text)
+    {
+        const bool hex = text.starts_with("0x") || text.starts_with("0X");
+        if (!hex && text.find_first_of(".eE") != std::string_view::npos)
+        {
+            double value = 0;
+            std::from_chars(text.data(), text.data() + text.size(), value);
+            return constant(ctx, type_kind::F64, std::bit_cast<uint64_t>(value), true);
+        }
+
+        uint64_t value = 0;
+        const auto digits = hex ? text.substr(2) : text;
+        if (std::from_chars(digits.data(), digits.data() + digits.size(), value, hex ? 16 : 10).ec != std::errc{})
+            error(ctx, "Invalid integer literal '" + std::string(text) + "'");
+        return value <= INT32_MAX ? constant(ctx, type_kind::I32, value, true) : constant(ctx, type_kind::I64, value, true);
+    }
+
+    value_t lower_string(lowering_t& ctx, const std::string_view text)
+    {
+        std::string value;
+        for (size_t i = 1; i + 1 < text.size(); ++i)
+        {
+            if (text[i] == '\\' && i + 2 < text.size())
+            {
+                switch (text[++i])
+                {
+                    case 'n': value += '\n'; break;
+                    case 't': value += '\t'; break;
+                    case '0': value += '\0'; break;
+                    default: value += text[i];
+                }
+                continue;
+            }
+            value += text[i];
+        }
+
+        auto& strings = ctx.module.strings;
+        auto it = std::ranges::find(strings, value);
+        if (it == strings.end())
+            it = strings.insert(strings.end(), std::move(value));
+        return constant(ctx, type_kind::STR, static_cast<uint64_t>(it - strings.begin()));
+    }
+
+    value_t lower_postfix(lowering_t& ctx, value_t value)
+    {
+        while (ctx.ok && peek(ctx).type == lexer::token_type::OPERATOR && peek(ctx).value == ".")
+        {
+            ++ctx.pos;
+            const auto segments = split_path(peek(ctx).value);
+            ++ctx.pos;
+            if (peek(ctx).value == "(")
+            {
+                value = lower_call(ctx, segments, &value);
+                continue;
+            }
+            lvalue_t lvalue;
+            if (!resolve_fields(ctx, value, segments, 0, lvalue))
+                break;
+            value = load_lvalue(ctx, lvalue);
+        }
+        return value;
+    }
+
+    value_t lower_primary(lowering_t& ctx)
+    {
+        const auto [type, text] = peek(ctx);
+        if (type == lexer::token_type::END_OF_FILE)
+        {
+            error(ctx, "Unexpected end of expression");
+            return constant(ctx, type_kind::I32, 0);
+        }
+        ++ctx.pos;
+
+        if (type == lexer::token_type::LITERAL)
+            return lower_literal(ctx, text);
+        if (type == lexer::token_type::STRING)
+            return lower_string(ctx, text);
+        if (text == "true" || text == "false")
+            return constant(ctx, type_kind::BOOL, text == "true");
+        if (text == "null")
+            return constant(ctx, type_kind::REF, 0);
+        if (text == "(")
+        {
+            const value_t value = lower_expression(ctx);
+            expect(ctx, ")");
+            return lower_postfix(ctx, value);
+        }
+        if (text == "-" || text == "!" || text == "~")
+        {
+            value_t operand = lower_expression(ctx, 11);
+            if (text == "!")
+            {
+                operand = convert(ctx, operand, type_kind::BOOL);
+                return { emit(ctx, opcode::NOT, type_kind::BOOL, operand.id), type_kind::BOOL, -1, false };
+            }
+            if (operand.type == type_kind::BOOL)
+                operand = convert(ctx, operand, type_kind::I32);
+            if (rank(operand.type) == 0 || (text == "~" && is_float(operand.type)))
+                error(ctx, "Invalid operand to unary '" + std::string(text) + "'");
+            return { emit(ctx, text == "-" ? opcode::NEG : opcode::NOT, operand.type, operand.id), operand.type, -1, operand.literal };
+        }
+        if (text == "await")
+        {
+            // Anything but a task is already there and is used as is.
+            const value_t task = lower_expression(ctx, 11);
+            if (task.type != type_kind::TASK || task.class_id < 0)
+                return task;
+            const auto [type, class_id] = ctx.tasks[task.class_id];
+            return { emit(ctx, opcode::AWAIT, type, task.id), type, class_id, false };
+        }
+        if (text == "new")
+        {
+            const std::string_view name = peek(ctx).value;
+            ++ctx.pos;
+            std::vector<std::string_view> args;
+            if (!parse_type_args(ctx, args))
+                return constant(ctx, type_kind::REF, 0);
+            const int32_t class_id = layout::layout_of(ctx.layouts, substitute(ctx, ctx.owner, name), args);
+            if (class_id < 0)
+            {
+                error(ctx, "Unknown class '" + std::string(name) + "'");
+                return constant(ctx, type_kind::REF, 0);
+            }
+            return lower_postfix(ctx, construct(ctx, class_id));
+        }
+
+        if (type != lexer::token_type::IDENTIFIER)
+        {
+            error(ctx, "Unexpected token '" + std::string(text) + "' in expression");
+            return constant(ctx, type_kind::I32, 0);
+        }
+
+        const auto segments = split_path(text);
+        if (segments.size() == 1 && is_class_name(ctx, text) && find_variable(ctx, text) == SIZE_MAX)
+        {
+            std::vector<std::string_view> args;
+            if (!parse_type_args(ctx, args))
+                return constant(ctx, type_kind::REF, 0);
+            const int32_t class_id = layout::layout_of(ctx.layouts, text, args);
+            if (class_id < 0)
+            {
+                error(ctx, "Unknown class '" + std::string(text) + "'");
+                return constant(ctx, type_kind::REF, 0);
+            }
+            return lower_postfix(ctx, construct(ctx, class_id));
+        }
+
+        if (peek(ctx).value == "(")
+            return lower_postfix(ctx, lower_call(ctx, segments, nullptr));
+
+        lvalue_t lvalue;
+        if (!resolve_path(ctx, segments, lvalue))
+            return constant(ctx, type_kind::I32, 0);
+        return lower_postfix(ctx, load_lvalue(ctx, lvalue));
+    }
+
+    value_t lower_logical(lowering_t& ctx, value_t lhs, const bool is_and)
+    {
+        lhs = convert(ctx, lhs, type_kind::BOOL);
+        const value_t short_value = constant(ctx, type_kind::BOOL, is_and ? 0 : 1);
+        const uint32_t from = ctx.block;
+        const uint32_t rhs_block = new_block(ctx);
+        const uint32_t merge = new_block(ctx);
+        if (is_and)
+            branch(ctx, lhs.id, rhs_block, merge);
+        else
+            branch(ctx, lhs.id, merge, rhs_block);
+
+        seal(ctx, rhs_block);
+        ctx.block = rhs_block;
+        const value_t rhs = convert(ctx, lower_expression(ctx, is_and ? 3 : 2), type_kind::BOOL);
+        const uint32_t rhs_end = ctx.block;
+        jump(ctx, merge);
+
+        seal(ctx, merge);
+        ctx.block = merge;
+        const uint32_t extra = ir::append_extra(current(ctx), { from, short_value.id, rhs_end, rhs.id });
+        return { emit(ctx, opcode::PHI, type_kind::BOOL, extra, 2), type_kind::BOOL, -1, false };
+    }
+
+    value_t binary(lowering_t& ctx, const opcode op, value_t lhs, value_t rhs, const std::string_view text)
+    {
+        const bool comparison = op >= opcode::EQ && op <= opcode::GE;
+        if (lhs.type == type_kind::REF || rhs.type == type_kind::REF || lhs.type == type_kind::STR || rhs.type == type_kind::STR)
+        {
+            if ((op == opcode::EQ || op == opcode::NE) && lhs.type == rhs.type)
+                return { emit(ctx, op, type_kind::BOOL, lhs.id, rhs.id), type_kind::BOOL, -1, false };
+            error(ctx, "Invalid operands to '" + std::string(text) + "'");
+            return lhs;
+        }
+        if (comparison && lhs.type == type_kind::BOOL && rhs.type == type_kind::BOOL && (op == opcode::EQ || op == opcode::NE))
+            return { emit(ctx, op, type_kind::BOOL, lhs.id, rhs.id), type_kind::BOOL, -1, false };
+
+        const type_kind type = (op == opcode::AND || op == opcode::OR || op == opcode::XOR) && lhs.type == type_kind::BOOL && rhs.type == type_kind::BOOL
+            ? type_kind::BOOL
+            : common_type(lhs, rhs);
+        if (is_float(type) && (op == opcode::AND || op == opcode::OR || op == opcode::XOR || op == opcode::SHL || op == opcode::SHR))
+        {
+            error(ctx, "Invalid floating point operands to '" + std::string(text) + "'");
+            return lhs;
+        }
+        lhs = convert(ctx, lhs, type);
+        rhs = convert(ctx, rhs, type);
+        const bool literal = lhs.literal && rhs.literal;
+        return { emit(ctx, op, comparison ? type_kind::BOOL : type, lhs.id, rhs.id), comparison ? type_kind::BOOL : type, -1, literal };
+    }
+
+    value_t lower_expression(lowering_t& ctx, const int min_precedence)
+    {
+        value_t lhs = lower_primary(ctx);
+        while (ctx.ok)
+        {
+            const auto [type, text] = peek(ctx);
+            const int prec = type == lexer::token_type::OPERATOR ? precedence(text) : 0;
+            if (prec < min_precedence || prec == 0)
+                break;
+            ++ctx.pos;
+
+            if (text == "&&" || text == "||")
+            {
+                lhs = lower_logical(ctx, lhs, text == "&&");
+                continue;
+            }
+            const value_t rhs = lower_expression(ctx, prec + 1);
+            const auto op = std::ranges::find_if(binary_t, [&](const auto& b) { return b.first == text; })->second;
+            lhs = binary(ctx, op, lhs, rhs, text);
+        }
+        return lhs;
+    }
+
+    // --- statements ---------------------------------------------------------------------------
+
+    void lower_variable(lowering_t& ctx)
+    {
+        const bool constant_var = peek(ctx).value == "const";
+        ++ctx.pos;
+        const std::string_view name = peek(ctx).value;
+        ++ctx.pos;
+        expect(ctx, ":");
+
+        parser::type_ref_t ref = {};
+        if (const auto [type, text] = peek(ctx); type == lexer::token_type::NULLABLE_TYPE)
+        {
+            ref.name = text.substr(0, text.size() - 1);
+            ref.nullable = true;
+        }
+        else if (type == lexer::token_type::TYPE || type == lexer::token_type::IDENTIFIER)
+        {
+            ref.name = text;
+        }
+        else
+        {
+            error(ctx, "Expected type for variable '" + std::string(name) + "'");
+            return;
+        }
+        ++ctx.pos;
+        if (ref.name.starts_with('['))
+        {
+            ref.array = true;
+            ref.name = ref.name.substr(1, ref.name.size() - 2);
+        }
+        if (!parse_type_args(ctx, ref.args))
+            return;
+
+        resolved_type_t type = { type_kind::VOID, ir::mem_kind::REF, -1, false };
+        const bool is_auto = ref.name == "auto";
+        if (!is_auto && !resolve_type(ctx, ref, ctx.owner, type))
+            return;
+
+        value_t init;
+        if (accept(ctx, "="))
+        {
+            init = lower_expression(ctx);
+            if (is_auto)
+                type = { init.literal && init.type == type_kind::F64 ? type_kind::F64 : init.type, ir::mem_kind::REF, init.class_id, false };
+        }
+        else if (is_auto)
+        {
+            error(ctx, "'auto' variable '" + std::string(name) + "' needs an initializer");
+            return;
+        }
+        else
+        {
+            init = constant(ctx, type.type, 0);
+        }
+        expect(ctx, ";");
+
+        const size_t variable = declare(ctx, name, type.type, type.class_id, constant_var);
+        store_lvalue(ctx, { lvalue_kind::VARIABLE, variable, 0, 0, {} }, init);
+    }
+
+    void lower_assignment(lowering_t& ctx, const lvalue_t& lvalue, const std::string_view op)
+    {
+        if (lvalue.kind == lvalue_kind::VARIABLE && ctx.scope[lvalue.variable].constant)
+            error(ctx, "Cannot assign to constant '" + std::string(ctx.scope[lvalue.variable].name) + "'");
+
+        value_t value = lower_expression(ctx);
+        if (op != "=")
+        {
+            const std::string_view arithmetic = op.substr(0, op.size() - 1);
+            const auto it = std::ranges::find_if(binary_t, [&](const auto& b) { return b.first == arithmetic; });
+            value = binary(ctx, it->second, load_lvalue(ctx, lvalue), value, arithmetic);
+        }
+        store_lvalue(ctx, lvalue, value);
+    }
+
+    bool is_assignment(const std::string_view op)
+    {
+        return op == "=" || (op.size() >= 2 && op.back() == '=' && op != "==" && op != "!=" && op != "<=" && op != ">=");
+    }
+
+    void lower_simple_statement(lowering_t& ctx)
+    {
+        if (peek(ctx).type == lexer::token_type::IDENTIFIER && peek(ctx, 1).type == lexer::token_type::OPERATOR && is_assignment(peek(ctx, 1).value))
+        {
+            const auto segments = split_path(peek(ctx).value);
+            const std::string_view op = peek(ctx, 1).value;
+            ctx.pos += 2;
+            lvalue_t lvalue;
+            if (resolve_path(ctx, segments, lvalue))
+                lower_assignment(ctx, lvalue, op);
+            return;
+        }
+
+        lower_expression(ctx);
+    }
+
+    size_t skip_until(const lowering_t& ctx, size_t pos, const std::string_view stop)
+    {
+        int depth = 0;
+        for (; pos < ctx.end; ++pos)
+        {
+            const std::string_view value = ctx.tokens[pos].value;
+            if (ctx.tokens[pos].type == lexer::token_type::PUNCTUAL)
+            {
+                if (depth == 0 && value == stop)
+                    return pos;
+                depth += (value == "(" || value == "{") - (value == ")" || value == "}");
+            }
+        }
+        return pos;
+    }
+
+    void lower_block(lowering_t& ctx)
+    {
+        const size_t depth = ctx.scope.size();
+        while (ctx.ok && !accept(ctx, "}"))
+        {
+            if (ctx.pos >= ctx.end)
+            {
+                error(ctx, "Expected '}'");
+                break;
+            }
+            lower_statement(ctx);
+        }
+        ctx.scope.resize(depth);
+    }
+
+    uint32_t lower_condition(lowering_t& ctx)
+    {
+        expect(ctx, "(");
+        const value_t condition = convert(ctx, lower_expression(ctx), type_kind::BOOL);
+        expect(ctx, ")");
+        return condition.id;
+    }
+
+    void lower_statement(lowering_t& ctx)
+    {
+        const std::string_view keyword = peek(ctx).type == lexer::token_type::STRING ? std::string_view{} : peek(ctx).value;
+        if (accept(ctx, ";"))
+            return;
+
+        if (accept(ctx, "{"))
+        {
+            lower_block(ctx);
+        }
+        else if (accept(ctx, "if"))
+        {
+            const uint32_t condition = lower_condition(ctx);
+            const uint32_t then_block = new_block(ctx);
+            const uint32_t else_block = new_block(ctx);
+            branch(ctx, condition, then_block, else_block);
+
+            seal(ctx, then_block);
+            ctx.block = then_block;
+            lower_statement(ctx);
+            const uint32_t then_end = ctx.block;
+
+            seal(ctx, else_block);
+            ctx.block = else_block;
+            if (accept(ctx, "else"))
+                lower_statement(ctx);
+            const uint32_t else_end = ctx.block;
+
+            const uint32_t merge = new_block(ctx);
+            ctx.block = then_end;
+            jump(ctx, merge);
+            ctx.block = else_end;
+            jump(ctx, merge);
+            seal(ctx, merge);
+            ctx.block = merge;
+        }
+        else if (accept(ctx, "while"))
+        {
+            const uint32_t header = new_block(ctx);
+            jump(ctx, header);
+            ctx.block = header;
+            const uint32_t condition = lower_condition(ctx);
+            const uint32_t body = new_block(ctx);
+            const uint32_t exit = new_block(ctx);
+            branch(ctx, condition, body, exit);
+
+            seal(ctx, body);
+            ctx.block = body;
+            ctx.loops.emplace_back(header, exit);
+            lower_statement(ctx);
+            ctx.loops.pop_back();
+            jump(ctx, header);
+
+            seal(ctx, header);
+            seal(ctx, exit);
+            ctx.block = exit;
+        }
+        else if (accept(ctx, "for"))
+        {
+            const size_t depth = ctx.scope.size();
+            expect(ctx, "(");
+            if (peek(ctx).value == "var" || peek(ctx).value == "const")
+            {
+                lower_variable(ctx);
+            }
+            else if (!accept(ctx, ";"))
+            {
+                lower_simple_statement(ctx);
+                expect(ctx, ";");
+            }
+
+            const uint32_t header = new_block(ctx);
+            jump(ctx, header);
+            ctx.block = header;
+            uint32_t condition;
+            if (peek(ctx).value == ";")
+                condition = constant(ctx, type_kind::BOOL, 1).id;
+            else
+                condition = convert(ctx, lower_expression(ctx), type_kind::BOOL).id;
+            expect(ctx, ";");
+
+            const size_t step_begin = ctx.pos;
+            const size_t step_end = skip_until(ctx, ctx.pos, ")");
+            ctx.pos = step_end;
+            expect(ctx, ")");
+
+            const uint32_t body = new_block(ctx);
+            const uint32_t step = new_block(ctx);
+            const uint32_t exit = new_block(ctx);
+            branch(ctx, condition, body, exit);
+
+            seal(ctx, body);
+            ctx.block = body;
+            ctx.loops.emplace_back(step, exit);
+            lower_statement(ctx);
+            ctx.loops.pop_back();
+            jump(ctx, step);
+
+            seal(ctx, step);
+            ctx.block = step;
+            if (step_begin != step_end)
+            {
+                const size_t saved_pos = ctx.pos;
+                const size_t saved_end = ctx.end;
+                ctx.pos = step_begin;
+                ctx.end = step_end;
+                lower_simple_statement(ctx);
+                ctx.pos = saved_pos;
+                ctx.end = saved_end;
+            }
+            jump(ctx, header);
+
+            seal(ctx, header);
+            seal(ctx, exit);
+            ctx.block = exit;
+            ctx.scope.resize(depth);
+        }
+        else if (accept(ctx, "return"))
+        {
+            const type_kind return_type = current(ctx).return_type;
+            if (accept(ctx, ";"))
+            {
+                if (return_type != type_kind::VOID)
+                    error(ctx, "Missing return value");
+                emit(ctx, opcode::RETURN, type_kind::VOID, NONE);
+            }
+            else
+            {
+                value_t value = lower_expression(ctx);
+                expect(ctx, ";");
+                if (return_type == type_kind::VOID)
+                    error(ctx, "Returning a value from a void function");
+                value = convert(ctx, value, return_type);
+                emit(ctx, opcode::RETURN, type_kind::VOID, value.id);
+            }
+            start_dead_block(ctx);
+        }
+        else if (keyword == "break" || keyword == "continue")
+        {
+            ++ctx.pos;
+            expect(ctx, ";");
+            if (ctx.loops.empty())
+            {
+                error(ctx, "'" + std::string(keyword) + "' outside of a loop");
+                return;
+            }
+            jump(ctx, keyword == "break" ? ctx.loops.back().second : ctx.loops.back().first);
+            start_dead_block(ctx);
+        }
+        else if (keyword == "var" || keyword == "const")
+        {
+            lower_variable(ctx);
+        }
+        else
+        {
+            lower_simple_statement(ctx);
+            expect(ctx, ";");
+        }
+    }
+
+    void lower_function(lowering_t& ctx, const pending_t& pending)
+    {
+        ctx.function = pending.function;
+        ctx.owner = pending.owner;
+        ctx.ok = true;
+        if (!signature(ctx, pending.function))
+            return;
+
+        const parser::function_decl_t& decl = ctx.parser.module.functions[pending.decl];
+        ctx.scope.clear();
+        ctx.var_types.clear();
+        ctx.preds.clear();
+        ctx.sealed.clear();
+        ctx.closed.clear();
+        ctx.defs.clear();
+        ctx.incomplete.clear();
+        ctx.replacement.clear();
+        ctx.loops.clear();
+
+        ctx.block = new_block(ctx);
+        seal(ctx, ctx.block);
+
+        const auto params = current(ctx).params;
+        size_t index = 0;
+        if (pending.owner >= 0 && !parser::has_modifier(decl.modifiers, parser::modifier::STATIC))
+        {
+            const size_t self = declare(ctx, "self", type_kind::REF, pending.owner, true);
+            ctx.defs[ctx.block][ctx.scope[self].var] = emit(ctx, opcode::PARAM, type_kind::REF, 0);
+            ++index;
+        }
+        for (const auto& param : decl.params)
+        {
+            resolved_type_t type;
+            resolve_type(ctx, param.type, pending.owner, type);
+            const size_t variable = declare(ctx, param.name, params[index], type.class_id, false);
+            ctx.defs[ctx.block][ctx.scope[variable].var] = emit(ctx, opcode::PARAM, params[index], static_cast<uint32_t>(index));
+            ++index;
+        }
+
+        ctx.pos = decl.body_begin;
+        ctx.end = decl.body_end;
+        while (ctx.ok && ctx.pos < ctx.end)
+            lower_statement(ctx);
+
+        if (!terminated(ctx))
+        {
+            const type_kind return_type = current(ctx).return_type;
+            emit(ctx, opcode::RETURN, type_kind::VOID, return_type == type_kind::VOID ? NONE : zero(ctx, ctx.block, return_type));
+        }
+
+        ir::function_t& fn = current(ctx);
+        for (auto i = static_cast<uint32_t>(ctx.replacement.size()); i < fn.insts.size(); ++i)
+            ctx.replacement.push_back(i);
+        ir::replace_uses(fn, ctx.replacement);
+        ir::compact(fn);
+    }
+}
+
+bool ir::lower_module(module_t& module, const parser::parser_t& parser, layout::layout_table_t& layouts)
+{
+    lowering_t ctx = { module, parser, layouts, *parser.tokens };
+
+    for (size_t i = 0; i < parser.module.functions.size(); ++i)
+    {
+        const auto& decl = parser.module.functions[i];
+        if (decl.owner < 0)
+        {
+            function_id(ctx, static_cast<int32_t>(i), -1);
+            continue;
+        }
+        const auto& cls = parser.module.classes[decl.owner];
+        if (cls.generics.empty())
+        {
+            const int32_t owner = layout::layout_of(layouts, cls.name);
+            if (owner >= 0)
+                function_id(ctx, static_cast<int32_t>(i), owner);
+        }
+    }
+
+    bool ok = true;
+    for (size_t dispatched = 0; !ctx.worklist.empty();)
+    {
+        while (!ctx.worklist.empty())
+        {
+            const pending_t pending = ctx.worklist.front();
+            ctx.worklist.erase(ctx.worklist.begin());
+            lower_function(ctx, pending);
+            ok &= ctx.ok;
+        }
+
+        // Every override a virtual call can reach must exist, including methods of generic instances.
+        for (; dispatched < ctx.dispatched.size(); ++dispatched)
+        {
+            const auto [receiver, method] = ctx.dispatched[dispatched];
+            for (size_t c = 0; c < layouts.classes.size(); ++c)
+            {
+                const auto id = static_cast<int32_t>(c);
+                int32_t owner = -1;
+                if (!layout::is_derived_from(layouts, id, receiver))
+                    continue;
+                if (const int32_t m = find_method(ctx, id, parser.module.functions[method].name, owner); m >= 0)
+                    function_id(ctx, m, owner);
+            }
+        }
+    }
+
+    module.class_aligns.clear();
+    for (const auto& cls : layouts.classes)
+        module.class_aligns.push_back(cls.align);
+    return ok && module.error_log.empty();
+}
@@ -3,12 +3,10 @@
 //
 // TODO: Implement type solver
 // TODO: Implement ast builder
-// TODO: Implement parse_package
-// TODO: Implement parse_import
-// TODO: Implement parse_annotation
 // TODO: Implement parse_enum
-// TODO: Implement parse_class
 
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 #include "lang.h"
 
@@ -16,6 +14,8 @@ void parser::parser_init(parser_t& parser, const std::vector<lexer::token_t>& to
 {
     parser.tokens = std::make_unique<std::vector<lexer::token_t>>(tokens);
     parser.token_index = 0;
+    parser.error_log.clear();
+    parser.module = {};
 }
 
 lexer::token_t parser::peek(const parser_t& parser)
@@ -61,19 +61,53 @@ void parser::log_error(parser_t& parser, const std::string& message)
 
 bool parser::parse_program(parser_t& parser)
 {
+    annotations_t annotations = {};
+    uint16_t modifiers = 0;
     while (parser.token_index < parser.tokens->size())
     {
-        if (const auto&[type, value] = peek(parser); value == "function")
+        if (const auto&[type, value] = peek(parser); type == lexer::token_type::ANNOTATION)
         {
-            if (!parse_function(parser))
+            if (!parse_annotation(parser, annotations))
+                return false;
+            continue;
+        }
+        else if (value == "package" || value == "using" || value == "import")
+        {
+            consume(parser);
+            const lexer::token_t path = peek(parser);
+            if (!expect_type(parser, lexer::token_type::IDENTIFIER) || !expect_value(parser, ";"))
+            {
+                log_error(parser, "Expected path and ';' after '" + std::string(value) + "'.");
+                return false;
+            }
+            if (value == "package")
+                parser.module.package = path.value;
+        }
+        else if (value == "final" || value == "inline" || value == "async")
+        {
+            consume(parser);
+            modifiers |= static_cast<uint16_t>(value == "final" ? modifier::FINAL : value == "inline" ? modifier::INLINE : modifier::ASYNC);
+            continue;
+        }
+        else if (value == "class")
+        {
+            if (!parse_class(parser, annotations, modifiers))
+            {
+                log_error(parser, "Failed to parse class.");
+                return false;
+            }
+        }
+        else if (value == "function")
+        {
+            if (!parse_function(parser, modifiers))
             {
                 log_error(parser, "Failed to parse function.");
                 return false;
             }
         }
-        else if (value == "var")
+        else if (value == "var" || value == "const")
         {
-            if (!parse_variable(parser))
+            if (!parse_variable(parser, parser.module.globals, modifiers))
             {
                 log_error(parser, "Failed to parse variable.");
                 return false;
@@ -88,67 +122,314 @@ bool parser::parse_program(parser_t& parser)
             log_error(parser, "Unexpected token: " + std::string(value));
             return false;
         }
+        annotations = {};
+        modifiers = 0;
     }
 
     return true;
 }
 
-bool parser::parse_function(parser_t& parser)
+bool parser::parse_annotation(parser_t& parser, annotations_t& annotations)
 {
-    consume(parser);
-    expect_type(parser, lexer::token_type::IDENTIFIER); // Optional function name check for anonymous functions
+    const auto [type, value] = next(parser);
+    if (value == "@packed")
+    {
+        annotations.packed = true;
+    }
+    else if (value == "@deprecated")
+    {
+        annotations.deprecated = true;
+    }
+    else if (value == "@aligned")
+    {
+        if (!expect_value(parser, "("))
+        {
+            annotations.aligned_cache_line = true;
+            return true;
+        }
 
-    if (!expect_value(parser, "(") || !expect_value(parser, ")"))
+        const std::string_view literal = peek(parser).value;
+        uint32_t alignment = 0;
+        if (!expect_type(parser, lexer::token_type::LITERAL)
+            || std::from_chars(literal.data(), literal.data() + literal.size(), alignment).ec != std::errc{}
+            || alignment == 0 || (alignment & (alignment - 1)) != 0)
+        {
+            log_error(parser, "Expected a power-of-two alignment in '@aligned(...)'.");
+            return false;
+        }
+        if (!expect_value(parser, ")"))
+        {
+            log_error(parser, "Expected ')' after alignment.");
+            return false;
+        }
+        annotations.aligned = alignment;
+    }
+    else
     {
-        log_error(parser, "Expected '()' after function name.");
+        log_error(parser, "Unknown annotation: " + std::string(value));
         return false;
     }
+    return true;
+}
 
-    if (!expect_value(parser, "->"))
+bool parser::parse_type(parser_t& parser, type_ref_t& type)
+{
+    const auto [token_type, value] = peek(parser);
+    type = {};
+    if (token_type == lexer::token_type::NULLABLE_TYPE)
+    {
+        type.nullable = true;
+        type.name = value.substr(0, value.size() - 1);
+    }
+    else if (token_type == lexer::token_type::TYPE || token_type == lexer::token_type::IDENTIFIER)
+    {
+        type.name = value;
+    }
+    else
     {
-        log_error(parser, "Expected '->' after '()'.");
         return false;
     }
+    consume(parser);
 
-    auto type_found = false;
-    for (const auto& type : {lexer::token_type::IDENTIFIER, lexer::token_type::TYPE, lexer::token_type::NULLABLE_TYPE})
+    if (type.name.starts_with('['))
     {
-        if (expect_type(parser, type))
+        type.array = true;
+        type.name = type.name.substr(1, type.name.size() - 2);
+    }
+
+    if (expect_value(parser, "<"))
+    {
+        do
         {
-            type_found = true;
+            type_ref_t arg;
+            if (!parse_type(parser, arg))
+            {
+                log_error(parser, "Expected type argument.");
+                return false;
+            }
+            // Layouts are keyed on plain argument names, so anything more would be dropped.
+            if (!arg.args.empty() || arg.nullable || arg.array)
+            {
+                log_error(parser, "Type arguments must be plain type names.");
+                return false;
+            }
+            type.args.push_back(arg.name);
+        }
+        while (expect_value(parser, ","));
+
+        if (!expect_value(parser, ">"))
+        {
+            log_error(parser, "Expected '>' after type arguments.");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parser::parse_parameters(parser_t& parser, std::vector<param_t>& params)
+{
+    if (!expect_value(parser, "("))
+        return false;
+    if (expect_value(parser, ")"))
+        return true;
+
+    do
+    {
+        param_t param = { peek(parser).value, {} };
+        if (!expect_type(parser, lexer::token_type::IDENTIFIER) || !expect_value(parser, ":") || !parse_type(parser, param.type))
+        {
+            log_error(parser, "Expected 'name: type' in parameter list.");
+            return false;
+        }
+        params.push_back(std::move(param));
+    }
+    while (expect_value(parser, ","));
+
+    return expect_value(parser, ")");
+}
+
+bool parser::skip_block(parser_t& parser, size_t& begin, size_t& end)
+{
+    if (!expect_value(parser, "{"))
+        return false;
+
+    begin = parser.token_index;
+    size_t depth = 1;
+    while (parser.token_index < parser.tokens->size())
+    {
+        const auto [type, value] = peek(parser);
+        if (type == lexer::token_type::END_OF_FILE)
             break;
+        if (type == lexer::token_type::PUNCTUAL)
+            depth += (value == "{") - (value == "}");
+        if (depth == 0)
+        {
+            end = parser.token_index;
+            consume(parser);
+            return true;
         }
+        consume(parser);
     }
-    if (!type_found)
+    return false;
+}
+
+bool parser::parse_class(parser_t& parser, const annotations_t& annotations, const uint16_t modifiers)
+{
+    consume(parser);
+
+    class_decl_t decl = {};
+    decl.name = peek(parser).value;
+    decl.annotations = annotations;
+    decl.modifiers = modifiers;
+    if (!expect_type(parser, lexer::token_type::IDENTIFIER))
     {
-        log_error(parser, "Expected return type after '->'.");
+        log_error(parser, "Expected class name after 'class'.");
         return false;
     }
 
+    if (expect_value(parser, "<"))
+    {
+        do
+        {
+            decl.generics.push_back(peek(parser).value);
+            if (!expect_type(parser, lexer::token_type::IDENTIFIER))
+            {
+                log_error(parser, "Expected generic parameter name.");
+                return false;
+            }
+        }
+        while (expect_value(parser, ","));
+
+        if (!expect_value(parser, ">"))
+        {
+            log_error(parser, "Expected '>' after generic parameters.");
+            return false;
+        }
+    }
+
+    if (expect_value(parser, "extends"))
+    {
+        decl.base = peek(parser).value;
+        if (!expect_type(parser, lexer::token_type::IDENTIFIER))
+        {
+            log_error(parser, "Expected base class name after 'extends'.");
+            return false;
+        }
+    }
+
     if (!expect_value(parser, "{"))
     {
-        log_error(parser, "Expected '{' to start function body.");
+        log_error(parser, "Expected '{' to start class body.");
         return false;
     }
 
+    const auto owner = static_cast<int32_t>(parser.module.classes.size());
+    parser.module.classes.push_back(std::move(decl));
+
     while (!expect_value(parser, "}"))
     {
-        consume(parser);
+        uint16_t member_modifiers = 0;
+        for (bool more = true; more;)
+        {
+            const std::string_view value = peek(parser).value;
+            modifier m = modifier::NONE;
+            if (value == "public") m = modifier::PUBLIC;
+            else if (value == "private") m = modifier::PRIVATE;
+            else if (value == "static") m = modifier::STATIC;
+            else if (value == "inline") m = modifier::INLINE;
+            else if (value == "virtual") m = modifier::VIRTUAL;
+            else if (value == "final") m = modifier::FINAL;
+            else if (value == "async") m = modifier::ASYNC;
+
+            more = m != modifier::NONE;
+            if (more)
+            {
+                member_modifiers |= static_cast<uint16_t>(m);
+                consume(parser);
+            }
+        }
+
+        if (const auto [type, value] = peek(parser); value == "var" || value == "const")
+        {
+            if (!parse_variable(parser, parser.module.classes[owner].fields, member_modifiers))
+                return false;
+        }
+        else if (value == "function" || type == lexer::token_type::IDENTIFIER)
+        {
+            if (value == parser.module.classes[owner].name)
+                member_modifiers |= static_cast<uint16_t>(modifier::CONSTRUCTOR);
+            if (!parse_function(parser, member_modifiers, owner))
+                return false;
+        }
+        else
+        {
+            log_error(parser, "Unexpected token in class body: " + std::string(value));
+            return false;
+        }
     }
 
+    expect_value(parser, ";");
     return true;
 }
 
-bool parser::parse_variable(parser_t& parser)
+bool parser::parse_function(parser_t& parser, const uint16_t modifiers, const int32_t owner)
 {
-    consume(parser);
+    function_decl_t decl = {};
+    decl.modifiers = modifiers;
+    decl.owner = owner;
+
+    expect_value(parser, "function");
+    decl.name = peek(parser).value;
+    if (!expect_type(parser, lexer::token_type::IDENTIFIER)) // Anonymous functions have no name
+        decl.name = {};
+
+    if (!parse_parameters(parser, decl.params))
+    {
+        log_error(parser, "Expected parameter list after function name.");
+        return false;
+    }
+
+    if (expect_value(parser, "->"))
+    {
+        if (!parse_type(parser, decl.return_type))
+        {
+            log_error(parser, "Expected return type after '->'.");
+            return false;
+        }
+    }
+    else if (!has_modifier(modifiers, modifier::CONSTRUCTOR))
+    {
+        log_error(parser, "Expected '->' after parameter list.");
+        return false;
+    }
+
+    if (!skip_block(parser, decl.body_begin, decl.body_end))
+    {
+        log_error(parser, "Expected '{ ... }' function body.");
+        return false;
+    }
+
+    if (owner >= 0)
+        parser.module.classes[owner].methods.push_back(parser.module.functions.size());
+    parser.module.functions.push_back(std::move(decl));
+    return true;
+}
+
+bool parser::parse_variable(parser_t& parser, std::vector<field_decl_t>& out, const uint16_t modifiers)
+{
+    field_decl_t decl = {};
+    decl.modifiers = modifiers;
+    if (next(parser).value == "const")
+        decl.modifiers |= static_cast<uint16_t>(modifier::CONST);
+
+    decl.name = peek(parser).value;
     if (!expect_type(parser, lexer::token_type::IDENTIFIER))
     {
         log_error(parser, "Expected variable name after 'var'.");
         return false;
     }
 
-    if (!expect_value(parser, ":") || !expect_type(parser, lexer::token_type::TYPE))
+    if (!expect_value(parser, ":") || !parse_type(parser, decl.type))
     {
         log_error(parser, "Expected type after variable name.");
         return false;
@@ -156,8 +437,20 @@ bool parser::parse_variable(parser_t& parser)
 
     if (expect_value(parser, "="))
     {
-        if (!expect_type(parser, lexer::token_type::LITERAL) &&
-            !expect_type(parser, lexer::token_type::IDENTIFIER))
+        decl.init_begin = parser.token_index;
+        size_t depth = 0;
+        while (parser.token_index < parser.tokens->size())
+        {
+            const auto [type, value] = peek(parser);
+            if (type == lexer::token_type::END_OF_FILE || (depth == 0 && value == ";"))
+                break;
+            if (type == lexer::token_type::PUNCTUAL)
+                depth += (value == "(" || value == "{") - (value == ")" || value == "}");
+            consume(parser);
+        }
+        decl.init_end = parser.token_index;
+
+        if (decl.init_begin == decl.init_end)
         {
             log_error(parser, "Expected value after '='.");
             return false;
@@ -170,5 +463,12 @@ bool parser::parse_variable(parser_t& parser)
         return false;
     }
 
+    out.push_back(std::move(decl));
     return true;
 }
+
+const parser::class_decl_t* parser::find_class(const module_t& module, const std::string_view name)
+{
+    const auto it = std::ranges::find_if(module.classes, [&](const class_decl_t& c) { return c.name == name; });
+    return it != module.classes.end() ? &*it : nullptr;
+}
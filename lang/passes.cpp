@@ -0,0 +1,720 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <unordered_map>
+#include "ir.h"
+
+using ir::inst_t;
+using ir::opcode;
+using ir::type_kind;
+using ir::NONE;
+
+namespace
+{
+    constexpr size_t INLINE_LIMIT = 64; // callee size, in instructions, above which `inline` is ignored
+
+    std::vector<uint32_t> identity(const size_t size)
+    {
+        std::vector<uint32_t> map(size);
+        for (uint32_t i = 0; i < size; ++i)
+            map[i] = i;
+        return map;
+    }
+
+    void grow(std::vector<uint32_t>& replacement, const size_t size)
+    {
+        for (auto i = static_cast<uint32_t>(replacement.size()); i < size; ++i)
+            replacement.push_back(i);
+    }
+
+    uint32_t resolve(std::vector<uint32_t>& replacement, uint32_t value)
+    {
+        while (value < replacement.size() && replacement[value] != value)
+            value = replacement[value];
+        return value;
+    }
+
+    bool is_const(const ir::function_t& fn, const uint32_t value)
+    {
+        return value < fn.insts.size() && fn.insts[value].op == opcode::CONST;
+    }
+
+    bool is_commutative(const opcode op)
+    {
+        return op == opcode::ADD || op == opcode::MUL || op == opcode::AND || op == opcode::OR
+            || op == opcode::XOR || op == opcode::EQ || op == opcode::NE;
+    }
+
+    template<typename T>
+    bool compare(const opcode op, const T a, const T b, uint64_t& out)
+    {
+        switch (op)
+        {
+            case opcode::EQ: out = a == b; return true;
+            case opcode::NE: out = a != b; return true;
+            case opcode::LT: out = a < b; return true;
+            case opcode::LE: out = a <= b; return true;
+            case opcode::GT: out = a > b; return true;
+            case opcode::GE: out = a >= b; return true;
+            default: return false;
+        }
+    }
+
+    template<typename T>
+    bool fold_int(const opcode op, const T a, const T b, T& out)
+    {
+        using U = std::make_unsigned_t<T>;
+        constexpr unsigned mask = sizeof(T) * 8 - 1;
+        switch (op)
+        {
+            case opcode::ADD: out = static_cast<T>(static_cast<U>(a) + static_cast<U>(b)); return true;
+            case opcode::SUB: out = static_cast<T>(static_cast<U>(a) - static_cast<U>(b)); return true;
+            case opcode::MUL: out = static_cast<T>(static_cast<U>(a) * static_cast<U>(b)); return true;
+            case opcode::DIV:
+            case opcode::REM:
+                if (b == 0 || (a == std::numeric_limits<T>::min() && b == -1))
+                    return false;
+                out = op == opcode::DIV ? a / b : a % b;
+                return true;
+            case opcode::AND: out = a & b; return true;
+            case opcode::OR: out = a | b; return true;
+            case opcode::XOR: out = a ^ b; return true;
+            case opcode::SHL: out = static_cast<T>(static_cast<U>(a) << (b & mask)); return true;
+            case opcode::SHR: out = a >> (b & mask); return true;
+            default: return false;
+        }
+    }
+
+    template<typename T>
+    bool fold_float(const opcode op, const T a, const T b, T& out)
+    {
+        switch (op)
+        {
+            case opcode::ADD: out = a + b; return true;
+            case opcode::SUB: out = a - b; return true;
+            case opcode::MUL: out = a * b; return true;
+            case opcode::DIV: out = a / b; return true;
+            case opcode::REM: out = std::fmod(a, b); return true;
+            default: return false;
+        }
+    }
+
+    bool evaluate_binary(const opcode op, const type_kind type, const uint64_t x, const uint64_t y, uint64_t& out)
+    {
+        const bool comparison = op >= opcode::EQ && op <= opcode::GE;
+        switch (type)
+        {
+            case type_kind::BOOL:
+                if (comparison)
+                    return compare(op, x != 0, y != 0, out);
+                if (op != opcode::AND && op != opcode::OR && op != opcode::XOR)
+                    return false;
+                out = op == opcode::AND ? (x & y) : op == opcode::OR ? (x | y) : (x ^ y);
+                return true;
+            case type_kind::I32:
+            {
+                const auto a = static_cast<int32_t>(x);
+                const auto b = static_cast<int32_t>(y);
+                if (comparison)
+                    return compare(op, a, b, out);
+                int32_t r;
+                if (!fold_int(op, a, b, r))
+                    return false;
+                out = static_cast<uint32_t>(r);
+                return true;
+            }
+            case type_kind::I64:
+            {
+                const auto a = static_cast<int64_t>(x);
+                const auto b = static_cast<int64_t>(y);
+                if (comparison)
+                    return compare(op, a, b, out);
+                int64_t r;
+                if (!fold_int(op, a, b, r))
+                    return false;
+                out = static_cast<uint64_t>(r);
+                return true;
+            }
+            case type_kind::F32:
+            {
+                const auto a = std::bit_cast<float>(static_cast<uint32_t>(x));
+                const auto b = std::bit_cast<float>(static_cast<uint32_t>(y));
+                if (comparison)
+                    return compare(op, a, b, out);
+                float r;
+                if (!fold_float(op, a, b, r))
+                    return false;
+                out = std::bit_cast<uint32_t>(r);
+                return true;
+            }
+            case type_kind::F64:
+            {
+                const auto a = std::bit_cast<double>(x);
+                const auto b = std::bit_cast<double>(y);
+                if (comparison)
+                    return compare(op, a, b, out);
+                double r;
+                if (!fold_float(op, a, b, r))
+                    return false;
+                out = std::bit_cast<uint64_t>(r);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    template<typename F>
+    bool float_to_int(const F value, const type_kind to, uint64_t& out)
+    {
+        if (!std::isfinite(value))
+            return false;
+        if (to == type_kind::I32)
+        {
+            if (value <= static_cast<F>(INT32_MIN) - 1 || value >= static_cast<F>(INT32_MAX) + 1)
+                return false;
+            out = static_cast<uint32_t>(static_cast<int32_t>(value));
+            return true;
+        }
+        if (value < static_cast<F>(INT64_MIN) || value >= static_cast<F>(INT64_MAX))
+            return false;
+        out = static_cast<uint64_t>(static_cast<int64_t>(value));
+        return true;
+    }
+
+    bool evaluate_convert(const type_kind from, const type_kind to, const uint64_t x, uint64_t& out)
+    {
+        int64_t integer;
+        switch (from)
+        {
+            case type_kind::BOOL: integer = x != 0; break;
+            case type_kind::I32: integer = static_cast<int32_t>(x); break;
+            case type_kind::I64: integer = static_cast<int64_t>(x); break;
+            case type_kind::F32:
+            {
+                const auto f = std::bit_cast<float>(static_cast<uint32_t>(x));
+                if (to == type_kind::F64)
+                {
+                    out = std::bit_cast<uint64_t>(static_cast<double>(f));
+                    return true;
+                }
+                return float_to_int(f, to, out);
+            }
+            case type_kind::F64:
+            {
+                const auto d = std::bit_cast<double>(x);
+                if (to == type_kind::F32)
+                {
+                    out = std::bit_cast<uint32_t>(static_cast<float>(d));
+                    return true;
+                }
+                return float_to_int(d, to, out);
+            }
+            default:
+                return false;
+        }
+
+        switch (to)
+        {
+            case type_kind::I32: out = static_cast<uint32_t>(static_cast<int32_t>(integer)); return true;
+            case type_kind::I64: out = static_cast<uint64_t>(integer); return true;
+            case type_kind::F32: out = std::bit_cast<uint32_t>(static_cast<float>(integer)); return true;
+            case type_kind::F64: out = std::bit_cast<uint64_t>(static_cast<double>(integer)); return true;
+            default: return false;
+        }
+    }
+
+    void make_const(inst_t& inst, const uint64_t bits)
+    {
+        inst.op = opcode::CONST;
+        inst.a = static_cast<uint32_t>(bits);
+        inst.b = static_cast<uint32_t>(bits >> 32);
+        inst.c = 0;
+    }
+
+    bool is_int(const type_kind type)
+    {
+        return type == type_kind::I32 || type == type_kind::I64;
+    }
+
+    // Algebraic identities on integers; returns the replacement value or NONE.
+    uint32_t simplify(const ir::function_t& fn, const inst_t& inst)
+    {
+        if (!is_int(inst.type))
+            return NONE;
+        const bool rhs_const = is_const(fn, inst.b);
+        const bool lhs_const = is_const(fn, inst.a);
+        const uint64_t rhs = rhs_const ? ir::const_bits(fn.insts[inst.b]) : 1;
+        const uint64_t lhs = lhs_const ? ir::const_bits(fn.insts[inst.a]) : 1;
+        switch (inst.op)
+        {
+            case opcode::ADD:
+            case opcode::OR:
+            case opcode::XOR:
+                if (rhs_const && rhs == 0)
+                    return inst.a;
+                if (lhs_const && lhs == 0)
+                    return inst.b;
+                return NONE;
+            case opcode::SUB:
+            case opcode::SHL:
+            case opcode::SHR:
+                return rhs_const && rhs == 0 ? inst.a : NONE;
+            case opcode::MUL:
+                if (rhs_const && rhs == 1)
+                    return inst.a;
+                if (lhs_const && lhs == 1)
+                    return inst.b;
+                return NONE;
+            case opcode::DIV:
+                return rhs_const && rhs == 1 ? inst.a : NONE;
+            default:
+                return NONE;
+        }
+    }
+
+    struct value_key_t
+    {
+        opcode op;
+        type_kind type;
+        uint16_t aux;
+        uint32_t a;
+        uint32_t b;
+        uint32_t c;
+
+        bool operator==(const value_key_t&) const = default;
+    };
+
+    struct value_key_hash_t
+    {
+        size_t operator()(const value_key_t& key) const
+        {
+            uint64_t h = static_cast<uint64_t>(key.op) | static_cast<uint64_t>(key.type) << 8 | static_cast<uint64_t>(key.aux) << 16;
+            h = h * 0x9E3779B97F4A7C15ull ^ key.a;
+            h = h * 0x9E3779B97F4A7C15ull ^ key.b;
+            h = h * 0x9E3779B97F4A7C15ull ^ key.c;
+            return static_cast<size_t>(h ^ h >> 29);
+        }
+    };
+}
+
+bool ir::fold_constants(module_t& module, const uint32_t function)
+{
+    function_t& fn = module.functions[function];
+    std::vector<uint32_t> replacement = identity(fn.insts.size());
+    bool changed = false;
+
+    for (uint32_t i = 0; i < fn.insts.size(); ++i)
+    {
+        inst_t& inst = fn.insts[i];
+        for_each_operand(fn, inst, [&](uint32_t& operand) { operand = resolve(replacement, operand); });
+
+        switch (inst.op)
+        {
+            case opcode::ADD: case opcode::SUB: case opcode::MUL: case opcode::DIV: case opcode::REM:
+            case opcode::AND: case opcode::OR: case opcode::XOR: case opcode::SHL: case opcode::SHR:
+            case opcode::EQ: case opcode::NE: case opcode::LT: case opcode::LE: case opcode::GT: case opcode::GE:
+            {
+                uint64_t result;
+                if (is_const(fn, inst.a) && is_const(fn, inst.b)
+                    && evaluate_binary(inst.op, fn.insts[inst.a].type, const_bits(fn.insts[inst.a]), const_bits(fn.insts[inst.b]), result))
+                {
+                    make_const(inst, result);
+                    changed = true;
+                }
+                else if (const uint32_t same = simplify(fn, inst); same != NONE)
+                {
+                    replacement[i] = same;
+                    inst.op = opcode::NOP;
+                    changed = true;
+                }
+                break;
+            }
+            case opcode::NEG:
+            case opcode::NOT:
+            {
+                if (!is_const(fn, inst.a))
+                    break;
+                const uint64_t x = const_bits(fn.insts[inst.a]);
+                uint64_t result;
+                if (inst.type == type_kind::BOOL)
+                    result = x == 0;
+                else if (inst.op == opcode::NOT)
+                    result = inst.type == type_kind::I32 ? static_cast<uint32_t>(~x) : ~x;
+                else if (inst.type == type_kind::F32)
+                    result = x ^ 0x80000000ull;
+                else if (inst.type == type_kind::F64)
+                    result = x ^ 0x8000000000000000ull;
+                else if (!evaluate_binary(opcode::SUB, inst.type, 0, x, result))
+                    break;
+                make_const(inst, result);
+                changed = true;
+                break;
+            }
+            case opcode::CONVERT:
+            {
+                uint64_t result;
+                if (is_const(fn, inst.a) && evaluate_convert(fn.insts[inst.a].type, inst.type, const_bits(fn.insts[inst.a]), result))
+                {
+                    make_const(inst, result);
+                    changed = true;
+                }
+                break;
+            }
+            case opcode::PHI:
+            {
+                uint32_t same = NONE;
+                bool trivial = true;
+                for (uint32_t k = 0; k < inst.b && trivial; ++k)
+                {
+                    const uint32_t value = resolve(replacement, fn.extra[inst.a + 2 * k + 1]);
+                    if (value == i || value == same)
+                        continue;
+                    trivial = same == NONE;
+                    same = value;
+                }
+                if (trivial && same != NONE)
+                {
+                    replacement[i] = same;
+                    inst.op = opcode::NOP;
+                    changed = true;
+                }
+                break;
+            }
+            case opcode::BRANCH:
+                if (is_const(fn, inst.a) || inst.b == inst.c)
+                {
+                    const uint32_t target = inst.b == inst.c || const_bits(fn.insts[inst.a]) != 0 ? inst.b : inst.c;
+                    inst = { opcode::JUMP, type_kind::VOID, 0, inst.block, target, 0, 0 };
+                    changed = true;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (changed)
+    {
+        replace_uses(fn, replacement);
+        compact(fn);
+    }
+    return changed;
+}
+
+bool ir::eliminate_dead_code(module_t& module, const uint32_t function)
+{
+    function_t& fn = module.functions[function];
+    std::vector<uint8_t> live(fn.insts.size(), 0);
+    std::vector<uint32_t> worklist;
+    for (uint32_t i = 0; i < fn.insts.size(); ++i)
+    {
+        const opcode op = fn.insts[i].op;
+        if (op != opcode::NOP && !is_pure(fn, fn.insts[i]) && op != opcode::LOAD)
+        {
+            live[i] = 1;
+            worklist.push_back(i);
+        }
+    }
+
+    while (!worklist.empty())
+    {
+        inst_t inst = fn.insts[worklist.back()];
+        worklist.pop_back();
+        for_each_operand(fn, inst, [&](const uint32_t& operand)
+        {
+            if (operand < live.size() && !live[operand])
+            {
+                live[operand] = 1;
+                worklist.push_back(operand);
+            }
+        });
+    }
+
+    bool changed = false;
+    for (uint32_t i = 0; i < fn.insts.size(); ++i)
+    {
+        if (!live[i] && fn.insts[i].op != opcode::NOP)
+        {
+            fn.insts[i].op = opcode::NOP;
+            changed = true;
+        }
+    }
+
+    const size_t blocks = fn.blocks.size();
+    compact(fn);
+    return changed || blocks != fn.blocks.size();
+}
+
+bool ir::number_values(module_t& module, const uint32_t function)
+{
+    function_t& fn = module.functions[function];
+    const cfg_t cfg = compute_cfg(fn);
+    const std::vector<uint32_t> idom = compute_idom(fn, cfg);
+
+    std::vector<std::vector<uint32_t>> children(fn.blocks.size());
+    for (uint32_t b = 1; b < idom.size(); ++b)
+    {
+        if (idom[b] != NONE)
+            children[idom[b]].push_back(b);
+    }
+
+    std::vector<uint32_t> replacement = identity(fn.insts.size());
+    std::unordered_map<value_key_t, uint32_t, value_key_hash_t> table;
+    std::vector<value_key_t> scope;           // keys inserted along the current dominator path
+    std::vector<std::pair<uint32_t, size_t>> stack; // (block, scope size on entry); block NONE marks exit
+    bool changed = false;
+
+    if (!fn.blocks.empty())
+        stack.emplace_back(0, 0);
+    while (!stack.empty())
+    {
+        const auto [b, mark] = stack.back();
+        stack.pop_back();
+        if (b == NONE)
+        {
+            while (scope.size() > mark)
+            {
+                table.erase(scope.back());
+                scope.pop_back();
+            }
+            continue;
+        }
+
+        stack.emplace_back(NONE, scope.size());
+        for (uint32_t i = fn.blocks[b].first; i < fn.blocks[b].first + fn.blocks[b].count; ++i)
+        {
+            inst_t& inst = fn.insts[i];
+            for_each_operand(fn, inst, [&](uint32_t& operand) { operand = resolve(replacement, operand); });
+            if (!is_pure(fn, inst) || inst.op == opcode::PHI || inst.op == opcode::NEW)
+                continue;
+
+            value_key_t key = { inst.op, inst.type, inst.aux, inst.a, inst.b, inst.c };
+            if (is_commutative(inst.op) && key.a > key.b)
+                std::swap(key.a, key.b);
+            if (const auto it = table.find(key); it != table.end())
+            {
+                replacement[i] = it->second;
+                inst.op = opcode::NOP;
+                changed = true;
+                continue;
+            }
+            table.emplace(key, i);
+            scope.push_back(key);
+        }
+        for (const uint32_t child : children[b])
+            stack.emplace_back(child, 0);
+    }
+
+    if (changed)
+    {
+        replace_uses(fn, replacement);
+        compact(fn);
+    }
+    return changed;
+}
+
+bool ir::inline_calls(module_t& module, const uint32_t function)
+{
+    std::vector<uint32_t> calls;
+    for (uint32_t i = 0; i < module.functions[function].insts.size(); ++i)
+    {
+        const inst_t& inst = module.functions[function].insts[i];
+        if (inst.op != opcode::CALL || inst.a == function || inst.aux != static_cast<uint16_t>(call_kind::DIRECT))
+            continue;
+        const function_t& callee = module.functions[inst.a];
+        if (parser::has_modifier(callee.modifiers, parser::modifier::INLINE) && !callee.blocks.empty() && callee.insts.size() <= INLINE_LIMIT)
+            calls.push_back(i);
+    }
+    if (calls.empty())
+        return false;
+
+    function_t& fn = module.functions[function];
+    std::vector<uint32_t> replacement = identity(fn.insts.size());
+    for (const uint32_t call : calls)
+    {
+        const inst_t site = fn.insts[call];
+        const function_t& callee = module.functions[site.a];
+        const uint32_t block = site.block;
+
+        // Split the caller block after the call; its phis stay at the head of the block.
+        const auto cont = static_cast<uint32_t>(fn.blocks.size());
+        fn.blocks.push_back({ 0, 0 });
+        uint32_t terminator = NONE;
+        for (uint32_t i = call + 1; i < fn.insts.size(); ++i)
+        {
+            if (fn.insts[i].block == block && fn.insts[i].op != opcode::PHI && fn.insts[i].op != opcode::NOP)
+            {
+                fn.insts[i].block = cont;
+                if (is_terminator(fn.insts[i].op))
+                    terminator = i;
+            }
+        }
+        if (terminator != NONE)
+        {
+            const inst_t& t = fn.insts[terminator];
+            const uint32_t targets[2] = { t.op == opcode::JUMP ? t.a : t.b, t.op == opcode::BRANCH ? t.c : NONE };
+            for (auto& inst : fn.insts)
+            {
+                if (inst.op != opcode::PHI || (inst.block != targets[0] && inst.block != targets[1]))
+                    continue;
+                for (uint32_t k = 0; k < inst.b; ++k)
+                {
+                    if (fn.extra[inst.a + 2 * k] == block)
+                        fn.extra[inst.a + 2 * k] = cont;
+                }
+            }
+        }
+
+        // Copy the callee body, mapping its parameters to the call arguments.
+        const auto block_base = static_cast<uint32_t>(fn.blocks.size());
+        fn.blocks.resize(fn.blocks.size() + callee.blocks.size(), { 0, 0 });
+        std::vector<uint32_t> map(callee.insts.size());
+        auto next = static_cast<uint32_t>(fn.insts.size());
+        for (uint32_t j = 0; j < callee.insts.size(); ++j)
+            map[j] = callee.insts[j].op == opcode::PARAM ? fn.extra[site.b + callee.insts[j].a] : next++;
+
+        std::vector<uint32_t> returns;
+        for (uint32_t j = 0; j < callee.insts.size(); ++j)
+        {
+            inst_t inst = callee.insts[j];
+            if (inst.op == opcode::PARAM)
+                continue;
+            inst.block += block_base;
+            switch (inst.op)
+            {
+                case opcode::PHI:
+                {
+                    std::vector<uint32_t> pairs;
+                    for (uint32_t k = 0; k < inst.b; ++k)
+                    {
+                        pairs.push_back(callee.extra[inst.a + 2 * k] + block_base);
+                        pairs.push_back(map[callee.extra[inst.a + 2 * k + 1]]);
+                    }
+                    inst.a = append_extra(fn, pairs);
+                    break;
+                }
+                case opcode::CALL:
+                case opcode::BUILTIN:
+                {
+                    std::vector<uint32_t> args;
+                    for (uint32_t k = 0; k < inst.c; ++k)
+                        args.push_back(map[callee.extra[inst.b + k]]);
+                    inst.b = append_extra(fn, args);
+                    break;
+                }
+                case opcode::COPY:
+                    inst.a = map[inst.a];
+                    inst.b = map[inst.b];
+                    inst.c = append_extra(fn, { callee.extra[inst.c], callee.extra[inst.c + 1], callee.extra[inst.c + 2] });
+                    break;
+                case opcode::JUMP:
+                    inst.a += block_base;
+                    break;
+                case opcode::BRANCH:
+                    inst.a = map[inst.a];
+                    inst.b += block_base;
+                    inst.c += block_base;
+                    break;
+                case opcode::RETURN:
+                    if (inst.a != NONE)
+                    {
+                        returns.push_back(inst.block);
+                        returns.push_back(map[inst.a]);
+                    }
+                    inst = { opcode::JUMP, type_kind::VOID, 0, inst.block, cont, 0, 0 };
+                    break;
+                default:
+                    for_each_operand(fn, inst, [&](uint32_t& operand) { operand = map[operand]; });
+            }
+            emit(fn, inst);
+        }
+
+        emit(fn, { opcode::JUMP, type_kind::VOID, 0, block, block_base, 0, 0 });
+        if (returns.size() > 2)
+        {
+            const uint32_t offset = append_extra(fn, returns);
+            const uint32_t phi = emit(fn, { opcode::PHI, site.type, 0, cont, offset, static_cast<uint32_t>(returns.size() / 2), 0 });
+            grow(replacement, fn.insts.size());
+            replacement[call] = phi;
+        }
+        else
+        {
+            // With no value returned on any path the result is never observed; its uses get a zero.
+            const uint32_t result = !returns.empty() ? returns[1]
+                : site.type != type_kind::VOID ? emit_const(fn, cont, site.type, 0) : call;
+            grow(replacement, fn.insts.size());
+            replacement[call] = result;
+        }
+        fn.insts[call].op = opcode::NOP;
+    }
+
+    replace_uses(fn, replacement);
+    compact(fn);
+    return true;
+}
+
+void ir::pass_manager_init(pass_manager_t& manager)
+{
+    manager.passes = {
+        { "inline", inline_calls },
+        { "fold", fold_constants },
+        { "escape", eliminate_allocations },
+        { "fold", fold_constants },
+        { "gvn", number_values },
+        { "dce", eliminate_dead_code },
+    };
+    manager.timings.clear();
+}
+
+void ir::run_passes(pass_manager_t& manager, module_t& module)
+{
+    manager.timings.resize(manager.passes.size());
+    for (size_t p = 0; p < manager.passes.size(); ++p)
+    {
+        const pass_t& pass = manager.passes[p];
+        pass_timing_t& timing = manager.timings[p];
+        timing.name = pass.name;
+
+        for (uint32_t f = 0; f < module.functions.size(); ++f)
+        {
+            const auto before = static_cast<int64_t>(live_count(module.functions[f]));
+            const auto start = std::chrono::steady_clock::now();
+            pass.run(module, f);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+            timing.time += elapsed;
+            timing.runs += 1;
+            timing.insts_removed += before - static_cast<int64_t>(live_count(module.functions[f]));
+            if (manager.hook)
+                manager.hook(pass.name, module.functions[f], elapsed);
+        }
+    }
+}
+
+void ir::print_timings(const pass_manager_t& manager, std::ostream& out)
+{
+    std::chrono::nanoseconds total{};
+    for (const auto& timing : manager.timings)
+        total += timing.time;
+
+    out << "===== Pass timings =====\n";
+    out << std::left << std::setw(10) << "pass" << std::right << std::setw(12) << "time (us)" << std::setw(9) << "%"
+        << std::setw(8) << "runs" << std::setw(10) << "removed" << "\n";
+    for (const auto& timing : manager.timings)
+    {
+        const double us = static_cast<double>(timing.time.count()) / 1000.0;
+        const double percent = total.count() != 0 ? 100.0 * static_cast<double>(timing.time.count()) / static_cast<double>(total.count()) : 0.0;
+        out << std::left << std::setw(10) << timing.name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << us << std::setw(8) << percent << "%" << std::setw(8) << timing.runs
+            << std::setw(10) << timing.insts_removed << "\n";
+    }
+    out << std::left << std::setw(10) << "total" << std::right << std::setw(12) << static_cast<double>(total.count()) / 1000.0 << "\n";
+    out << std::defaultfloat;
+}
@@ -0,0 +1,163 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "server.h"
+
+namespace
+{
+    constexpr size_t MAX_FRAME = 1 << 30;
+
+    bool write_all(const int fd, const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t n = ::write(fd, data, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool read_all(const int fd, char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            const ssize_t n = ::read(fd, data, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    template<typename T>
+    bool read_number(const int fd, T& value)
+    {
+        char line[24];
+        size_t length = 0;
+        while (true)
+        {
+            if (length == sizeof(line) || !read_all(fd, line + length, 1))
+                return false;
+            if (line[length] == '\n')
+                break;
+            ++length;
+        }
+        const auto [end, error] = std::from_chars(line, line + length, value);
+        return error == std::errc() && end == line + length && length != 0;
+    }
+
+    bool write_number(const int fd, const long long value)
+    {
+        const std::string line = std::to_string(value) + "\n";
+        return write_all(fd, line.data(), line.size());
+    }
+
+    bool read_string(const int fd, std::string& out)
+    {
+        size_t size;
+        if (!read_number(fd, size) || size > MAX_FRAME)
+            return false;
+        out.resize(size);
+        return read_all(fd, out.data(), size);
+    }
+
+    bool write_string(const int fd, const std::string& value)
+    {
+        return write_number(fd, static_cast<long long>(value.size())) && write_all(fd, value.data(), value.size());
+    }
+}
+
+bool server::read_request(const int fd, request_t& request)
+{
+    size_t count;
+    if (!read_number(fd, count) || count == 0 || count > MAX_FRAME || !read_string(fd, request.cwd))
+        return false;
+    request.args.resize(count - 1);
+    for (auto& arg : request.args)
+    {
+        if (!read_string(fd, arg))
+            return false;
+    }
+    return true;
+}
+
+bool server::write_request(const int fd, const request_t& request)
+{
+    if (!write_number(fd, static_cast<long long>(request.args.size() + 1)) || !write_string(fd, request.cwd))
+        return false;
+    for (const auto& arg : request.args)
+    {
+        if (!write_string(fd, arg))
+            return false;
+    }
+    return true;
+}
+
+bool server::read_response(const int fd, response_t& response)
+{
+    return read_number(fd, response.exit_code) && read_string(fd, response.out) && read_string(fd, response.err);
+}
+
+bool server::write_response(const int fd, const response_t& response)
+{
+    return write_number(fd, response.exit_code) && write_string(fd, response.out) && write_string(fd, response.err);
+}
+
+std::string server::default_socket()
+{
+    if (const char* runtime = std::getenv("XDG_RUNTIME_DIR"); runtime != nullptr && *runtime != '\0')
+        return std::string(runtime) + "/lumen-lang.sock";
+    return "/tmp/lumen-lang-" + std::to_string(::getuid()) + ".sock";
+}
+
+int server::forward(const std::string& socket_path, const std::vector<std::string>& args)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Socket path is too long: " << socket_path << "\n";
+        return 1;
+    }
+    socket_path.copy(address.sun_path, socket_path.size());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        std::cerr << "Cannot connect to a lumen-lang server at " << socket_path << " (start one with `lumen-lang serve`)\n";
+        if (fd >= 0)
+            ::close(fd);
+        return 1;
+    }
+
+    std::error_code error;
+    const request_t request = { std::filesystem::current_path(error).string(), args };
+    response_t response = {};
+    const bool ok = write_request(fd, request) && read_response(fd, response);
+    ::close(fd);
+    if (!ok)
+    {
+        std::cerr << "Lost the connection to the lumen-lang server\n";
+        return 1;
+    }
+    std::cout << response.out << std::flush;
+    std::cerr << response.err << std::flush;
+    return response.exit_code;
+}
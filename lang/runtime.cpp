@@ -0,0 +1,486 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iomanip>
+#include <new>
+#include "runtime.h"
+
+namespace
+{
+    constexpr int64_t DEQUE_CAPACITY = 256;
+    constexpr size_t CHUNK_SLOTS = 1 << 15;
+    constexpr uint32_t MIN_SIZE_CLASS = 3;
+    constexpr uint32_t SPIN_ROUNDS = 64; // failed searches for work before a worker goes to sleep
+    constexpr size_t TASK_SLOTS = (sizeof(runtime::task_t) + sizeof(vm::slot_t) - 1) / sizeof(vm::slot_t);
+
+    int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    vm::slot_t* carve(runtime::pool_t& pool, const size_t slots)
+    {
+        if (pool.cursor == nullptr || static_cast<size_t>(pool.limit - pool.cursor) < slots)
+        {
+            const size_t size = std::max(CHUNK_SLOTS, slots);
+            pool.chunks.push_back(std::make_unique_for_overwrite<vm::slot_t[]>(size));
+            pool.cursor = pool.chunks.back().get();
+            pool.limit = pool.cursor + size;
+        }
+        vm::slot_t* block = pool.cursor;
+        pool.cursor += slots;
+        return block;
+    }
+
+    runtime::ring_t* grow(runtime::deque_t& deque, const runtime::ring_t* ring, const int64_t top, const int64_t bottom)
+    {
+        const int64_t capacity = (ring->mask + 1) * 2;
+        auto bigger = std::make_unique<runtime::ring_t>(capacity - 1, std::make_unique<std::atomic<runtime::task_t*>[]>(capacity));
+        for (int64_t i = top; i < bottom; ++i)
+            bigger->slots[i & bigger->mask].store(ring->slots[i & ring->mask].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        runtime::ring_t* result = bigger.get();
+        deque.rings.push_back(std::move(bigger));
+        deque.ring.store(result, std::memory_order_release);
+        return result;
+    }
+
+    void wake(runtime::scheduler_t& scheduler, const bool all)
+    {
+        scheduler.epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (all)
+            scheduler.epoch.notify_all();
+        else
+            scheduler.epoch.notify_one();
+    }
+
+    bool has_work(const runtime::scheduler_t& scheduler)
+    {
+        return std::ranges::any_of(scheduler.workers, [](const auto& worker)
+        {
+            return worker->deque.bottom.load(std::memory_order_seq_cst) > worker->deque.top.load(std::memory_order_seq_cst);
+        });
+    }
+
+    void fail(runtime::scheduler_t& scheduler, const std::string& error)
+    {
+        {
+            const std::lock_guard guard(scheduler.lock);
+            if (!scheduler.failed.load(std::memory_order_relaxed))
+                scheduler.error = error;
+            scheduler.failed.store(true, std::memory_order_seq_cst);
+        }
+        wake(scheduler, true);
+    }
+
+    void work(runtime::worker_t& worker);
+
+    void start(runtime::scheduler_t& scheduler)
+    {
+        scheduler.started = true;
+        for (size_t i = 1; i < scheduler.workers.size(); ++i)
+            scheduler.threads.emplace_back(work, std::ref(*scheduler.workers[i]));
+    }
+
+    // Makes `task` runnable on `worker`. Sleepers register before their last look for work and the
+    // fence orders the push before the check for them, so either the sleeper sees the task or it is woken.
+    void schedule(runtime::worker_t& worker, runtime::task_t* task)
+    {
+        runtime::scheduler_t& scheduler = *worker.scheduler;
+        if (!scheduler.started)
+            start(scheduler);
+        runtime::push(worker.deque, task);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (scheduler.sleepers.load(std::memory_order_relaxed) != 0)
+            wake(scheduler, false);
+    }
+
+    // Sleeps until work may have shown up or `awaited` has finished.
+    void sleep(runtime::worker_t& worker, runtime::task_t* awaited)
+    {
+        runtime::scheduler_t& scheduler = *worker.scheduler;
+        const uint32_t epoch = scheduler.epoch.load(std::memory_order_seq_cst);
+        scheduler.sleepers.fetch_add(1, std::memory_order_seq_cst);
+        if (awaited != nullptr)
+            awaited->blocked.store(true, std::memory_order_seq_cst);
+        const bool done = awaited != nullptr && awaited->waiters.load(std::memory_order_seq_cst) == runtime::FINISHED;
+        if (!done && !scheduler.stopping.load(std::memory_order_seq_cst) && !scheduler.failed.load(std::memory_order_seq_cst) && !has_work(scheduler))
+            scheduler.epoch.wait(epoch, std::memory_order_seq_cst);
+        scheduler.sleepers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    runtime::task_t* find_task(runtime::worker_t& worker)
+    {
+        if (runtime::task_t* task = runtime::pop(worker.deque))
+            return task;
+        const auto& workers = worker.scheduler->workers;
+        if (workers.size() == 1)
+            return nullptr;
+
+        worker.seed ^= worker.seed << 13;
+        worker.seed ^= worker.seed >> 7;
+        worker.seed ^= worker.seed << 17;
+        const size_t first = worker.seed % workers.size();
+        for (size_t k = 0; k < workers.size(); ++k)
+        {
+            runtime::worker_t& victim = *workers[(first + k) % workers.size()];
+            if (&victim == &worker)
+                continue;
+            if (runtime::task_t* task = runtime::steal(victim.deque))
+            {
+                ++worker.steals;
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    runtime::task_t* create(runtime::worker_t& worker, const uint32_t function)
+    {
+        const vm::function_t& fn = worker.scheduler->program->functions[function];
+        auto* task = new (carve(worker.pool, TASK_SLOTS)) runtime::task_t{};
+        task->frame = runtime::allocate_frame(worker.pool, fn.frame_size, task->size_class);
+        task->function = function;
+        if (worker.scheduler->record_latency)
+            task->spawned = now();
+        ++worker.spawned;
+        return task;
+    }
+
+    // Adds `waiter` to the tasks resumed when `awaited` finishes; false if it already has.
+    bool park(runtime::task_t& waiter, runtime::task_t& awaited)
+    {
+        uintptr_t head = awaited.waiters.load(std::memory_order_acquire);
+        do
+        {
+            if (head == runtime::FINISHED)
+                return false;
+            waiter.next = reinterpret_cast<runtime::task_t*>(head);
+        }
+        while (!awaited.waiters.compare_exchange_weak(head, reinterpret_cast<uintptr_t>(&waiter), std::memory_order_release, std::memory_order_acquire));
+        return true;
+    }
+
+    void finish(runtime::worker_t& worker, runtime::task_t& task)
+    {
+        runtime::free_frame(worker.pool, task.frame, task.size_class);
+        task.frame = nullptr;
+        if (worker.scheduler->record_latency)
+            worker.latencies.push_back(now() - task.spawned);
+
+        auto* waiter = reinterpret_cast<runtime::task_t*>(task.waiters.exchange(runtime::FINISHED, std::memory_order_seq_cst));
+        while (waiter != nullptr)
+        {
+            runtime::task_t* next = waiter->next;
+            schedule(worker, waiter);
+            waiter = next;
+        }
+        if (task.blocked.load(std::memory_order_seq_cst))
+            wake(*worker.scheduler, true);
+    }
+
+    // Runs `task` until it returns or suspends; a suspended task is parked on the task it awaits, or
+    // scheduled again right away if that one finished in the meantime.
+    vm::status run_task(runtime::worker_t& worker, runtime::task_t& task, vm::slot_t* base, const uint32_t depth)
+    {
+        const vm::status status = vm::resume(worker.vm, task, base, depth);
+        if (status == vm::status::SUSPENDED)
+        {
+            ++worker.suspensions;
+            if (!park(task, *worker.vm.awaited))
+                schedule(worker, &task);
+            return vm::status::OK;
+        }
+        if (status == vm::status::ERROR)
+        {
+            fail(*worker.scheduler, worker.vm.error);
+            return status;
+        }
+        finish(worker, task);
+        return status;
+    }
+
+    void work(runtime::worker_t& worker)
+    {
+        runtime::scheduler_t& scheduler = *worker.scheduler;
+        uint32_t idle = 0;
+        while (!scheduler.stopping.load(std::memory_order_relaxed) && !scheduler.failed.load(std::memory_order_relaxed))
+        {
+            if (runtime::task_t* task = find_task(worker))
+            {
+                run_task(worker, *task, worker.vm.stack.get(), 0);
+                idle = 0;
+            }
+            else if (++idle < SPIN_ROUNDS)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                sleep(worker, nullptr);
+                idle = 0;
+            }
+        }
+    }
+}
+
+void runtime::deque_init(deque_t& deque, const int64_t capacity)
+{
+    deque.rings.clear();
+    deque.rings.push_back(std::make_unique<ring_t>(capacity - 1, std::make_unique<std::atomic<task_t*>[]>(capacity)));
+    deque.ring.store(deque.rings.back().get(), std::memory_order_relaxed);
+    deque.top.store(0, std::memory_order_relaxed);
+    deque.bottom.store(0, std::memory_order_relaxed);
+}
+
+void runtime::push(deque_t& deque, task_t* task)
+{
+    const int64_t bottom = deque.bottom.load(std::memory_order_relaxed);
+    const int64_t top = deque.top.load(std::memory_order_acquire);
+    ring_t* ring = deque.ring.load(std::memory_order_relaxed);
+    if (bottom - top > ring->mask)
+        ring = grow(deque, ring, top, bottom);
+    ring->slots[bottom & ring->mask].store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    deque.bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+runtime::task_t* runtime::pop(deque_t& deque)
+{
+    const int64_t bottom = deque.bottom.load(std::memory_order_relaxed) - 1;
+    const ring_t* ring = deque.ring.load(std::memory_order_relaxed);
+    deque.bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = deque.top.load(std::memory_order_relaxed);
+    if (top > bottom)
+    {
+        deque.bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    task_t* task = ring->slots[bottom & ring->mask].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // The last task goes to whoever wins it, the owner or a thief.
+        if (!deque.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            task = nullptr;
+        deque.bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+runtime::task_t* runtime::steal(deque_t& deque)
+{
+    int64_t top = deque.top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = deque.bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+        return nullptr;
+    const ring_t* ring = deque.ring.load(std::memory_order_acquire);
+    task_t* task = ring->slots[top & ring->mask].load(std::memory_order_relaxed);
+    if (!deque.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return task;
+}
+
+vm::slot_t* runtime::allocate_frame(pool_t& pool, const uint32_t slots, uint32_t& size_class)
+{
+    size_class = std::max<uint32_t>(MIN_SIZE_CLASS, std::bit_width(std::max<uint32_t>(slots, 1) - 1));
+    if (vm::slot_t* frame = pool.free[size_class])
+    {
+        pool.free[size_class] = static_cast<vm::slot_t*>(frame->ref);
+        return frame;
+    }
+    return carve(pool, size_t{ 1 } << size_class);
+}
+
+void runtime::free_frame(pool_t& pool, vm::slot_t* frame, const uint32_t size_class)
+{
+    frame->ref = pool.free[size_class];
+    pool.free[size_class] = frame;
+}
+
+void runtime::scheduler_init(scheduler_t& scheduler, const vm::program_t& program, std::ostream& out, uint32_t threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    scheduler.program = &program;
+    scheduler.workers.clear();
+    scheduler.threads.clear();
+    scheduler.started = false;
+    scheduler.record_latency = false;
+    scheduler.stopping.store(false);
+    scheduler.failed.store(false);
+    scheduler.sleepers.store(0);
+    scheduler.epoch.store(0);
+    scheduler.error.clear();
+    for (uint32_t i = 0; i < threads; ++i)
+    {
+        auto worker = std::make_unique<worker_t>();
+        deque_init(worker->deque, DEQUE_CAPACITY);
+        vm::vm_init(worker->vm, program, out);
+        worker->vm.worker = worker.get();
+        worker->vm.out_lock = threads > 1 ? &scheduler.lock : nullptr;
+        worker->scheduler = &scheduler;
+        worker->index = i;
+        worker->seed = 0x9E3779B97F4A7C15ull * (i + 1);
+        scheduler.workers.push_back(std::move(worker));
+    }
+}
+
+void runtime::shutdown(scheduler_t& scheduler)
+{
+    scheduler.stopping.store(true, std::memory_order_seq_cst);
+    wake(scheduler, true);
+    for (auto& thread : scheduler.threads)
+        thread.join();
+    scheduler.threads.clear();
+}
+
+runtime::task_t* runtime::spawn(worker_t& worker, const uint32_t function, const vm::slot_t* regs, const uint32_t* args, const uint32_t count)
+{
+    task_t* task = create(worker, function);
+    for (uint32_t k = 0; k < count; ++k)
+        task->frame[k] = regs[args[k]];
+    schedule(worker, task);
+    return task;
+}
+
+// Waits for `task` from synchronous code, running other tasks in the meantime with their calls placed
+// from `base` on.
+vm::status runtime::wait(worker_t& worker, task_t& task, vm::slot_t* base, const uint32_t depth)
+{
+    scheduler_t& scheduler = *worker.scheduler;
+    for (uint32_t idle = 0; !is_done(task);)
+    {
+        if (scheduler.failed.load(std::memory_order_relaxed) || scheduler.stopping.load(std::memory_order_relaxed))
+        {
+            worker.vm.error = scheduler.failed ? "awaited task failed" : "scheduler stopped";
+            return vm::status::ERROR;
+        }
+        if (task_t* next = find_task(worker))
+        {
+            if (run_task(worker, *next, base, depth + 1) != vm::status::OK)
+                return vm::status::ERROR;
+            idle = 0;
+        }
+        else if (scheduler.workers.size() == 1)
+        {
+            // Nothing is runnable and no other thread could make the task finish.
+            worker.vm.error = "deadlock: the awaited task can never finish";
+            return vm::status::ERROR;
+        }
+        else if (++idle < SPIN_ROUNDS)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            sleep(worker, &task);
+            idle = 0;
+        }
+    }
+    return vm::status::OK;
+}
+
+vm::status runtime::call(scheduler_t& scheduler, const uint32_t function, const vm::slot_t* args, const size_t count, vm::slot_t& result)
+{
+    worker_t& worker = *scheduler.workers.front();
+    const vm::function_t& fn = scheduler.program->functions[function];
+    vm::status status;
+    if (!fn.coroutine)
+    {
+        status = vm::call(worker.vm, function, args, count, result);
+    }
+    else if (count != fn.param_count)
+    {
+        worker.vm.error = "bad call to " + fn.name;
+        status = vm::status::ERROR;
+    }
+    else
+    {
+        task_t* task = create(worker, function);
+        std::copy_n(args, count, task->frame);
+        schedule(worker, task);
+        status = wait(worker, *task, worker.vm.stack.get(), 0);
+        result = task->result;
+    }
+
+    // A task that failed fails the call even if nothing awaited it.
+    if (status != vm::status::OK || scheduler.failed.load())
+    {
+        const std::lock_guard guard(scheduler.lock);
+        if (!scheduler.failed.load())
+            scheduler.error = worker.vm.error;
+        scheduler.failed.store(true);
+        status = vm::status::ERROR;
+    }
+    return status;
+}
+
+vm::status runtime::run(scheduler_t& scheduler, int& exit_code)
+{
+    const vm::program_t& program = *scheduler.program;
+    exit_code = 0;
+    if (program.entry < 0)
+    {
+        scheduler.error = "no main function";
+        return vm::status::ERROR;
+    }
+    vm::slot_t result = {};
+    const vm::status status = call(scheduler, static_cast<uint32_t>(program.entry), nullptr, 0, result);
+    shutdown(scheduler);
+
+    const ir::type_kind type = program.functions[program.entry].return_type;
+    if (status == vm::status::OK && (type == ir::type_kind::I32 || type == ir::type_kind::BOOL))
+        exit_code = result.i32;
+    else if (status == vm::status::OK && type == ir::type_kind::I64)
+        exit_code = static_cast<int>(result.i64);
+    return status;
+}
+
+void runtime::print_stats(const scheduler_t& scheduler, std::ostream& out)
+{
+    // Every worker has its own inline caches; a merged site lists each class any of them saw.
+    vm::vm_t merged = {};
+    merged.program = scheduler.program;
+    merged.caches = scheduler.workers.front()->vm.caches;
+    for (size_t w = 1; w < scheduler.workers.size(); ++w)
+    {
+        for (size_t i = 0; i < merged.caches.size(); ++i)
+        {
+            vm::inline_cache_t& into = merged.caches[i];
+            const vm::inline_cache_t& from = scheduler.workers[w]->vm.caches[i];
+            into.hits += from.hits;
+            into.misses += from.misses;
+            into.megamorphic |= from.megamorphic;
+            for (uint32_t k = 0; k < from.count; ++k)
+            {
+                if (std::find(into.classes, into.classes + into.count, from.classes[k]) != into.classes + into.count)
+                    continue;
+                if (into.count == vm::CACHE_WAYS)
+                {
+                    into.megamorphic = true;
+                    continue;
+                }
+                into.classes[into.count] = from.classes[k];
+                into.targets[into.count] = from.targets[k];
+                ++into.count;
+            }
+        }
+    }
+    vm::print_stats(merged, out);
+    if (!scheduler.started)
+        return;
+
+    out << "Workers\n";
+    out << std::left << std::setw(8) << "worker" << std::right << std::setw(12) << "spawned" << std::setw(12) << "steals"
+        << std::setw(12) << "suspended" << "\n";
+    for (const auto& worker : scheduler.workers)
+    {
+        out << std::left << std::setw(8) << worker->index << std::right << std::setw(12) << worker->spawned << std::setw(12)
+            << worker->steals << std::setw(12) << worker->suspensions << "\n";
+    }
+}
@@ -0,0 +1,128 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+// Work-stealing scheduler for `async` functions. Every worker thread owns a VM, a deque of runnable
+// tasks and a pool of coroutine frames. An `async` call pushes a task onto the caller's deque; a worker
+// pops its own deque at the bottom and, once that is empty, steals from the top of the others'.
+//
+
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "vm.h"
+
+namespace runtime
+{
+    constexpr uintptr_t FINISHED = 1; // `task_t::waiters` once the task has returned
+    constexpr uint32_t SIZE_CLASSES = 17; // frames of 2^k slots, up to the largest frame a function can have
+
+    // A running call of an `async` function. Its registers live in a frame from the pool of the worker
+    // that started it and go back to a pool when the call returns. The task itself is never freed while
+    // the scheduler lives, like objects on the VM heap, so a handle can be awaited any number of times.
+    struct task_t
+    {
+        std::atomic<uintptr_t> waiters; // suspended tasks awaiting this one, linked through `next`
+        std::atomic<bool> blocked;      // a synchronous caller may be asleep waiting for this task
+        task_t* next;
+        vm::slot_t* frame;
+        vm::slot_t result;
+        uint32_t function;
+        uint32_t pc;         // where the coroutine resumes
+        uint32_t size_class; // of `frame`
+        int64_t spawned;     // steady clock in nanoseconds, when latencies are recorded
+    };
+
+    // Chase-Lev deque as in Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+    // The owner pushes and pops at the bottom and thieves take from the top. Outgrown rings are kept
+    // until the deque goes away since a thief may still be reading from one.
+    struct ring_t
+    {
+        int64_t mask;
+        std::unique_ptr<std::atomic<task_t*>[]> slots;
+    };
+
+    struct deque_t
+    {
+        alignas(64) std::atomic<int64_t> top;
+        alignas(64) std::atomic<int64_t> bottom;
+        std::atomic<ring_t*> ring;
+        std::vector<std::unique_ptr<ring_t>> rings;
+    };
+
+    // Per-thread free lists of coroutine frames by size class. Task headers are carved from the same
+    // chunks but never returned.
+    struct pool_t
+    {
+        std::vector<std::unique_ptr<vm::slot_t[]>> chunks;
+        vm::slot_t* cursor;
+        vm::slot_t* limit;
+        vm::slot_t* free[SIZE_CLASSES]; // a free frame holds the next one in its first slot
+    };
+
+    struct scheduler_t;
+
+    struct worker_t
+    {
+        deque_t deque;
+        pool_t pool;
+        vm::vm_t vm;
+        scheduler_t* scheduler;
+        uint32_t index;
+        uint64_t seed; // victim selection
+        uint64_t spawned;
+        uint64_t steals;
+        uint64_t suspensions;
+        std::vector<int64_t> latencies; // spawn to completion of each task, in nanoseconds
+    };
+
+    // Worker 0 runs on the thread that calls into the scheduler. The other workers get their threads on
+    // the first `async` call, so programs without one never start any.
+    struct scheduler_t
+    {
+        const vm::program_t* program;
+        std::vector<std::unique_ptr<worker_t>> workers;
+        std::vector<std::thread> threads;
+        bool started;
+        bool record_latency;
+        std::atomic<bool> stopping;
+        std::atomic<bool> failed;
+        std::atomic<uint32_t> sleepers;
+        std::atomic<uint32_t> epoch; // bumped to wake sleeping workers
+        std::mutex lock;             // output and `error`
+        std::string error;
+    };
+
+    inline bool is_done(const task_t& task)
+    {
+        return task.waiters.load(std::memory_order_acquire) == FINISHED;
+    }
+
+    void deque_init(deque_t& deque, int64_t capacity);
+    void push(deque_t& deque, task_t* task);
+    task_t* pop(deque_t& deque);
+    task_t* steal(deque_t& deque);
+
+    vm::slot_t* allocate_frame(pool_t& pool, uint32_t slots, uint32_t& size_class);
+    void free_frame(pool_t& pool, vm::slot_t* frame, uint32_t size_class);
+
+    // `threads` counts the calling thread; 0 picks one worker per hardware thread.
+    void scheduler_init(scheduler_t& scheduler, const vm::program_t& program, std::ostream& out, uint32_t threads);
+    void shutdown(scheduler_t& scheduler);
+
+    task_t* spawn(worker_t& worker, uint32_t function, const vm::slot_t* regs, const uint32_t* args, uint32_t count);
+    vm::status wait(worker_t& worker, task_t& task, vm::slot_t* base, uint32_t depth);
+
+    vm::status call(scheduler_t& scheduler, uint32_t function, const vm::slot_t* args, size_t count, vm::slot_t& result);
+    vm::status run(scheduler_t& scheduler, int& exit_code);
+    void print_stats(const scheduler_t& scheduler, std::ostream& out);
+}
+
+#endif
@@ -0,0 +1,341 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <fcntl.h>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <utility>
+#include <unistd.h>
+#include "driver.h"
+#include "server.h"
+
+extern char** environ;
+
+namespace
+{
+    constexpr int IO_TIMEOUT_SECONDS = 10; // for a client to send its request and take the response
+    constexpr std::chrono::milliseconds ACCEPT_RETRY_DELAY(100);
+
+    struct state_t
+    {
+        driver::cache_t cache;
+        std::mutex lock; // guards `cache` and the redirection of std::cout and std::cerr
+        std::string runner;
+        uint32_t run_timeout;
+        std::atomic<bool> stop;
+        int listener;
+
+        std::mutex connections_lock;
+        std::condition_variable idle;
+        size_t connections;
+    };
+
+    std::string status(const driver::cache_t& cache)
+    {
+        std::ostringstream out;
+        out << "units " << cache.units.size() << ", hits " << cache.hits << ", misses " << cache.misses << "\n";
+        for (const auto& [path, unit] : cache.units)
+        {
+            out << "    " << (path.empty() ? "<default>" : path) << " " << std::hex << std::setw(16) << std::setfill('0') << unit->hash
+                << std::dec << std::setfill(' ') << (unit->compiled ? " compiled" : "") << "\n";
+        }
+        return out.str();
+    }
+
+    void close_pipes(int (&pipes)[3][2])
+    {
+        for (auto& pipe : pipes)
+        {
+            for (int& fd : pipe)
+            {
+                if (fd >= 0)
+                    ::close(fd);
+                fd = -1;
+            }
+        }
+    }
+
+    // Runs the program in a fresh `lumen-lang run-program` process, so neither an endless loop nor a crash
+    // takes the server down. The program is flattened while `guard` still holds the cache and the server
+    // goes on once that is done. The child is spawned rather than forked since the server has threads; it
+    // gets the program on its standard input and is killed if it has not finished within `timeout` seconds.
+    server::response_t run_isolated(const std::string& runner, const driver::invocation_t& invocation,
+        std::unique_lock<std::mutex>& guard, const uint32_t timeout)
+    {
+        const std::string input = driver::write_invocation(invocation);
+        guard.unlock();
+
+        // The child's standard input, output and error. Every descriptor is close-on-exec, so only the
+        // ends duplicated onto the child's 0, 1 and 2 reach it and spawns on other threads inherit none.
+        int pipes[3][2] = { { -1, -1 }, { -1, -1 }, { -1, -1 } };
+        for (auto& pipe : pipes)
+        {
+            if (::pipe2(pipe, O_CLOEXEC) != 0)
+            {
+                const int error = errno;
+                close_pipes(pipes);
+                return { 1, {}, "Cannot start the program: " + std::string(std::strerror(error)) + "\n" };
+            }
+        }
+        int ends[3] = { pipes[0][1], pipes[1][0], pipes[2][0] }; // the server's side of each pipe
+
+        posix_spawn_file_actions_t actions;
+        ::posix_spawn_file_actions_init(&actions);
+        ::posix_spawn_file_actions_adddup2(&actions, pipes[0][0], STDIN_FILENO);
+        ::posix_spawn_file_actions_adddup2(&actions, pipes[1][1], STDOUT_FILENO);
+        ::posix_spawn_file_actions_adddup2(&actions, pipes[2][1], STDERR_FILENO);
+        std::string command = "run-program";
+        std::string program_path = runner;
+        char* argv[] = { program_path.data(), command.data(), nullptr };
+        // The server ignores SIGPIPE and the child would inherit that; it gets the default back.
+        posix_spawnattr_t attributes;
+        ::posix_spawnattr_init(&attributes);
+        sigset_t defaults;
+        sigemptyset(&defaults);
+        sigaddset(&defaults, SIGPIPE);
+        ::posix_spawnattr_setsigdefault(&attributes, &defaults);
+        ::posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+        pid_t pid = -1;
+        const int spawned = ::posix_spawnp(&pid, runner.c_str(), &actions, &attributes, argv, environ);
+        ::posix_spawnattr_destroy(&attributes);
+        ::posix_spawn_file_actions_destroy(&actions);
+        ::close(pipes[0][0]);
+        ::close(pipes[1][1]);
+        ::close(pipes[2][1]);
+        if (spawned != 0)
+        {
+            for (const int fd : ends)
+                ::close(fd);
+            return { 1, {}, "Cannot start the program: " + std::string(std::strerror(spawned)) + "\n" };
+        }
+        for (const int fd : ends)
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        // Feeds the input and collects the output until the child closes both of its outputs, which it
+        // does by exiting.
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+        std::string output[2];
+        size_t written = 0;
+        bool timed_out = false;
+        int poll_error = 0;
+        while (ends[1] >= 0 || ends[2] >= 0)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0)
+            {
+                timed_out = true;
+                break;
+            }
+            pollfd pending[3] = { { ends[0], POLLOUT, 0 }, { ends[1], POLLIN, 0 }, { ends[2], POLLIN, 0 } };
+            if (::poll(pending, 3, static_cast<int>(left.count())) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                poll_error = errno;
+                break;
+            }
+            if (pending[0].revents != 0)
+            {
+                const ssize_t n = ::write(ends[0], input.data() + written, input.size() - written);
+                if (n > 0)
+                    written += static_cast<size_t>(n);
+                if (written == input.size() || (n < 0 && errno != EAGAIN && errno != EINTR))
+                {
+                    ::close(ends[0]); // EOF for the child, or it is gone and its outputs will say so
+                    ends[0] = -1;
+                }
+            }
+            for (int k = 1; k < 3; ++k)
+            {
+                if (pending[k].revents == 0)
+                    continue;
+                char buffer[4096];
+                const ssize_t n = ::read(ends[k], buffer, sizeof(buffer));
+                if (n > 0)
+                {
+                    output[k - 1].append(buffer, static_cast<size_t>(n));
+                }
+                else if (n == 0 || (errno != EAGAIN && errno != EINTR))
+                {
+                    ::close(ends[k]);
+                    ends[k] = -1;
+                }
+            }
+        }
+
+        // Whatever went wrong, the child must not outlive the request: waitpid would wait for it forever.
+        const bool finished = ends[1] < 0 && ends[2] < 0;
+        if (!finished)
+            ::kill(pid, SIGKILL);
+        for (const int fd : ends)
+        {
+            if (fd >= 0)
+                ::close(fd);
+        }
+        int wait_status = 0;
+        while (::waitpid(pid, &wait_status, 0) < 0 && errno == EINTR)
+        {
+        }
+
+        auto& [out, err] = output;
+        if (timed_out)
+            return { 1, std::move(out), std::move(err) + "Program did not finish within " + std::to_string(timeout) + " s\n" };
+        if (!finished)
+            return { 1, std::move(out), std::move(err) + "Cannot wait for the program: " + std::strerror(poll_error) + "\n" };
+        if (!WIFEXITED(wait_status))
+            return { 1, std::move(out), std::move(err) + "Program terminated abnormally\n" };
+        return { WEXITSTATUS(wait_status), std::move(out), std::move(err) };
+    }
+
+    // Runs one request with std::cout and std::cerr captured into the response.
+    server::response_t handle(state_t& state, const server::request_t& request)
+    {
+        if (request.args.size() == 1 && request.args[0] == "--shutdown")
+        {
+            state.stop = true;
+            if (state.listener >= 0)
+                ::shutdown(state.listener, SHUT_RDWR); // wakes up the accept loop
+            return { 0, {}, {} };
+        }
+
+        std::unique_lock guard(state.lock);
+        if (request.args.size() == 1 && request.args[0] == "--status")
+            return { 0, status(state.cache), {} };
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t hits = state.cache.hits;
+        std::ostringstream out;
+        std::ostringstream err;
+        std::streambuf* saved_out = std::cout.rdbuf(out.rdbuf());
+        std::streambuf* saved_err = std::cerr.rdbuf(err.rdbuf());
+        driver::invocation_t invocation = {};
+        int exit_code = 0;
+        const bool run = driver::prepare(state.cache, request.args, request.cwd, invocation, exit_code);
+        std::cout.flush();
+        std::cout.rdbuf(saved_out);
+        std::cerr.rdbuf(saved_err);
+        const bool cached = state.cache.hits != hits;
+
+        server::response_t response = { exit_code, out.str(), err.str() };
+        if (run)
+        {
+            const server::response_t program = run_isolated(state.runner, invocation, guard, state.run_timeout);
+            response.exit_code = program.exit_code;
+            response.out += program.out;
+            response.err += program.err;
+        }
+        else
+        {
+            guard.unlock();
+        }
+
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::ostringstream log;
+        log << "lumen-lang:";
+        for (const auto& arg : request.args)
+            log << " " << arg;
+        log << " -> " << response.exit_code << " (" << std::fixed << std::setprecision(2) << elapsed.count() << " ms"
+            << (cached ? ", cached" : "") << ")\n";
+        std::clog << log.str() << std::flush;
+        return response;
+    }
+
+    void serve_connection(state_t& state, const int client)
+    {
+        if (server::request_t request; server::read_request(client, request))
+            server::write_response(client, handle(state, request));
+        ::close(client);
+
+        std::lock_guard guard(state.connections_lock);
+        if (--state.connections == 0)
+            state.idle.notify_all();
+    }
+}
+
+int server::serve(const std::string& socket_path, const std::string& runner, const uint32_t run_timeout)
+{
+    state_t state = {};
+    state.runner = runner;
+    state.run_timeout = run_timeout;
+    state.listener = -1;
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (socket_path.empty())
+    {
+        request_t request;
+        while (!state.stop && read_request(STDIN_FILENO, request))
+        {
+            if (!write_response(STDOUT_FILENO, handle(state, request)))
+                return 1;
+        }
+        return 0;
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path))
+    {
+        std::cerr << "Socket path is too long: " << socket_path << "\n";
+        return 1;
+    }
+    socket_path.copy(address.sun_path, socket_path.size());
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ::unlink(socket_path.c_str());
+    if (listener < 0 || ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 16) != 0)
+    {
+        std::cerr << "Cannot listen on " << socket_path << "\n";
+        if (listener >= 0)
+            ::close(listener);
+        return 1;
+    }
+    state.listener = listener;
+    std::clog << "lumen-lang: serving on " << socket_path << std::endl;
+
+    // Each connection gets its own thread and a bounded time to send its request, so a stalled client
+    // holds up nobody else. Builds still take turns on the cache; programs run in child processes.
+    while (!state.stop)
+    {
+        const int client = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0)
+        {
+            // Out of descriptors or memory, accept fails again at once until a connection closes; wait
+            // for that rather than spinning. `--shutdown` also ends up here, through the listener.
+            const int error = errno;
+            if (state.stop || error == EINTR || error == ECONNABORTED)
+                continue;
+            std::clog << "lumen-lang: cannot accept a connection: " << std::strerror(error) << std::endl;
+            std::this_thread::sleep_for(ACCEPT_RETRY_DELAY);
+            continue;
+        }
+        const timeval timeout = { IO_TIMEOUT_SECONDS, 0 };
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        {
+            std::lock_guard guard(state.connections_lock);
+            ++state.connections;
+        }
+        std::thread(serve_connection, std::ref(state), client).detach();
+    }
+
+    std::unique_lock guard(state.connections_lock);
+    state.idle.wait(guard, [&] { return state.connections == 0; });
+    ::close(listener);
+    ::unlink(socket_path.c_str());
+    return 0;
+}
@@ -0,0 +1,53 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A long-lived compiler process that keeps parsed and compiled files in memory between requests.
+// Requests and responses are length-prefixed frames:
+//
+//     request:  <count>\n then <count> strings (working directory, then the arguments)
+//     response: <exit code>\n then two strings (standard output, standard error)
+//
+// where a string is `<length>\n<bytes>`. The arguments are those of a regular `lumen-lang` invocation;
+// `--status` reports the cache and `--shutdown` stops the server.
+namespace server
+{
+    struct request_t
+    {
+        std::string cwd;
+        std::vector<std::string> args;
+    };
+
+    struct response_t
+    {
+        int exit_code;
+        std::string out;
+        std::string err;
+    };
+
+    bool read_request(int fd, request_t& request);
+    bool write_request(int fd, const request_t& request);
+    bool read_response(int fd, response_t& response);
+    bool write_response(int fd, const response_t& response);
+
+    std::string default_socket();
+
+    constexpr uint32_t DEFAULT_RUN_TIMEOUT = 30;
+
+    // Serves requests on a Unix socket at `socket_path`, or on stdin/stdout if it is empty. `run` requests
+    // execute in a `<runner> run-program` child process that is killed after `run_timeout` seconds; `runner`
+    // is the path of a lumen-lang executable built from the same sources.
+    int serve(const std::string& socket_path, const std::string& runner, uint32_t run_timeout = DEFAULT_RUN_TIMEOUT);
+
+    // Thin client: sends `args` to the server at `socket_path` and relays its output and exit code.
+    int forward(const std::string& socket_path, const std::vector<std::string>& args);
+}
+
+#endif
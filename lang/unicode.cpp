@@ -0,0 +1,229 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <cstring>
+#include "unicode.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LUMEN_UTF8_AVX2 1
+#include <immintrin.h>
+#else
+#define LUMEN_UTF8_AVX2 0
+#endif
+
+#if LUMEN_UTF8_AVX2
+namespace
+{
+    // Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte". Every byte is
+    // classified by the high nibble of its predecessor, the low nibble of its predecessor and its own
+    // high nibble; a sequence is ill-formed where the three lookups share an error bit. Whether a byte
+    // must be the 2nd or 3rd continuation of a longer sequence is checked separately.
+    constexpr uint8_t TOO_SHORT = 1 << 0;  // lead byte followed by a lead byte or ASCII
+    constexpr uint8_t TOO_LONG = 1 << 1;   // ASCII followed by a continuation
+    constexpr uint8_t OVERLONG_3 = 1 << 2; // E0 80..9F
+    constexpr uint8_t TOO_LARGE = 1 << 3;  // F4 90..BF or F5..FF
+    constexpr uint8_t SURROGATE = 1 << 4;  // ED A0..BF
+    constexpr uint8_t OVERLONG_2 = 1 << 5; // C0 or C1
+    constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+    constexpr uint8_t OVERLONG_4 = 1 << 6; // F0 80..8F
+    constexpr uint8_t TWO_CONTS = 1 << 7;  // continuation after a continuation
+    constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+    struct utf8_state_t
+    {
+        __m256i error;
+        __m256i previous;   // last block with non-ASCII bytes
+        __m256i incomplete; // lead bytes at the end of `previous` still missing continuations
+    };
+
+    __attribute__((target("avx2"))) __m256i lookup(const uint8_t (&table)[16], const __m256i nibbles)
+    {
+        const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+        return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(half), nibbles);
+    }
+
+    __attribute__((target("avx2"))) __m256i high_nibbles(const __m256i bytes)
+    {
+        return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+    }
+
+    // `input` shifted right by N bytes, with the last N bytes of `previous` shifted in.
+    template<int N>
+    __attribute__((target("avx2"))) __m256i preceding(const __m256i input, const __m256i previous)
+    {
+        return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+    }
+
+    __attribute__((target("avx2"))) void check_block(utf8_state_t& state, const __m256i input)
+    {
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            state.error = _mm256_or_si256(state.error, state.incomplete);
+            return;
+        }
+
+        static constexpr uint8_t byte_1_high[16] = {
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            TOO_SHORT | OVERLONG_2,
+            TOO_SHORT,
+            TOO_SHORT | OVERLONG_3 | SURROGATE,
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+        };
+        static constexpr uint8_t byte_1_low[16] = {
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+            CARRY | OVERLONG_2,
+            CARRY,
+            CARRY,
+            CARRY | TOO_LARGE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+        };
+        static constexpr uint8_t byte_2_high[16] = {
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        };
+
+        const __m256i previous1 = preceding<1>(input, state.previous);
+        const __m256i special = _mm256_and_si256(
+            _mm256_and_si256(lookup(byte_1_high, high_nibbles(previous1)), lookup(byte_1_low, _mm256_and_si256(previous1, _mm256_set1_epi8(0x0F)))),
+            lookup(byte_2_high, high_nibbles(input)));
+
+        // Only bytes two after E0..FF or three after F0..FF keep their high bit through the subtraction.
+        const __m256i third = _mm256_subs_epu8(preceding<2>(input, state.previous), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+        const __m256i fourth = _mm256_subs_epu8(preceding<3>(input, state.previous), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+        const __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+        state.error = _mm256_or_si256(state.error, _mm256_xor_si256(must_continue, special));
+
+        const __m256i max_complete = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+        state.incomplete = _mm256_subs_epu8(input, max_complete);
+        state.previous = input;
+    }
+
+    __attribute__((target("avx2"))) bool validate_avx2(const std::string_view text)
+    {
+        utf8_state_t state = { _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+        size_t i = 0;
+        for (; i + unicode::BLOCK_SIZE <= text.size(); i += unicode::BLOCK_SIZE)
+            check_block(state, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i)));
+        if (i < text.size())
+        {
+            char tail[unicode::BLOCK_SIZE] = {};
+            std::memcpy(tail, text.data() + i, text.size() - i);
+            check_block(state, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail)));
+        }
+        const __m256i error = _mm256_or_si256(state.error, state.incomplete);
+        return _mm256_testz_si256(error, error) != 0;
+    }
+}
+#endif
+
+bool unicode::is_ascii_block(const char* block)
+{
+    uint64_t words[BLOCK_SIZE / 8];
+    std::memcpy(words, block, BLOCK_SIZE);
+    return ((words[0] | words[1] | words[2] | words[3]) & 0x8080808080808080ull) == 0;
+}
+
+unicode::code_point_t unicode::decode(const std::string_view text)
+{
+    if (text.empty())
+        return { 0, 0 };
+    const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char lead = bytes[0];
+    if (lead < 0x80)
+        return { lead, 1 };
+
+    // Well-formed sequences as in table 3-7 of the Unicode standard; the second byte has a narrower
+    // range after E0, ED, F0 and F4 to rule out overlong forms, surrogates and values past U+10FFFF.
+    uint32_t length;
+    char32_t value;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        length = 2;
+        value = lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        length = 3;
+        value = lead & 0x0F;
+        low = lead == 0xE0 ? 0xA0 : low;
+        high = lead == 0xED ? 0x9F : high;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        length = 4;
+        value = lead & 0x07;
+        low = lead == 0xF0 ? 0x90 : low;
+        high = lead == 0xF4 ? 0x8F : high;
+    }
+    else
+    {
+        return { 0, 0 };
+    }
+
+    if (text.size() < length)
+        return { 0, 0 };
+    for (uint32_t i = 1; i < length; ++i)
+    {
+        if (bytes[i] < low || bytes[i] > high)
+            return { 0, 0 };
+        low = 0x80;
+        high = 0xBF;
+        value = value << 6 | (bytes[i] & 0x3F);
+    }
+    return { value, length };
+}
+
+size_t unicode::find_invalid_utf8(const std::string_view text)
+{
+    size_t i = 0;
+    while (i < text.size())
+    {
+        if (i + BLOCK_SIZE <= text.size() && is_ascii_block(text.data() + i))
+        {
+            i += BLOCK_SIZE;
+        }
+        else if (static_cast<unsigned char>(text[i]) < 0x80)
+        {
+            ++i;
+        }
+        else
+        {
+            const uint32_t length = decode(text.substr(i)).length;
+            if (length == 0)
+                return i;
+            i += length;
+        }
+    }
+    return std::string_view::npos;
+}
+
+bool unicode::validate_utf8(const std::string_view text)
+{
+#if LUMEN_UTF8_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    if (avx2)
+        return validate_avx2(text);
+#endif
+    return find_invalid_utf8(text) == std::string_view::npos;
+}
@@ -0,0 +1,52 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#ifndef UNICODE_H
+#define UNICODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "unicode_data.h"
+
+namespace unicode
+{
+    constexpr size_t BLOCK_SIZE = 32; // bytes checked for ASCII at once
+
+    struct code_point_t
+    {
+        char32_t value;
+        uint32_t length; // bytes of the encoding, 0 if the sequence is not well-formed UTF-8
+    };
+
+    // `word` is 0 for XID_Start and 2 for XID_Continue, see `XID_LEAVES`.
+    inline bool is_xid(const char32_t code, const uint32_t word)
+    {
+        if (code >= XID_LIMIT)
+            return false;
+        const uint8_t row = XID_STAGE1[code >> XID_STAGE1_SHIFT];
+        const uint8_t leaf = XID_STAGE2[row * XID_ROW_SIZE + (code >> XID_LEAF_SHIFT) % XID_ROW_SIZE];
+        return XID_LEAVES[leaf][word + (code >> 6 & 1)] >> (code & 63) & 1;
+    }
+
+    inline bool is_xid_start(const char32_t code)
+    {
+        return is_xid(code, 0);
+    }
+
+    inline bool is_xid_continue(const char32_t code)
+    {
+        return is_xid(code, 2);
+    }
+
+    bool is_ascii_block(const char* block);
+    code_point_t decode(std::string_view text);
+
+    // Validation uses AVX2 where the CPU has it and falls back to `find_invalid_utf8` otherwise; both
+    // skip 32-byte blocks of ASCII without decoding them.
+    bool validate_utf8(std::string_view text);
+    size_t find_invalid_utf8(std::string_view text); // offset of the first ill-formed sequence or npos
+}
+
+#endif
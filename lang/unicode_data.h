@@ -0,0 +1,286 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+// Generated by scripts/unicode_tables.py from Unicode 14.0.0; do not edit. 7297 bytes in total.
+//
+
+#ifndef UNICODE_DATA_H
+#define UNICODE_DATA_H
+
+#include <cstdint>
+
+namespace unicode
+{
+    constexpr char32_t XID_LIMIT = 0xe0800; // no identifier characters at or above
+    constexpr uint32_t XID_STAGE1_SHIFT = 11;
+    constexpr uint32_t XID_LEAF_SHIFT = 7;
+    constexpr uint32_t XID_ROW_SIZE = 16;
+
+    // Row of `XID_STAGE2` for each 2048 code points.
+    constexpr uint8_t XID_STAGE1[449] = {
+        0, 1, 2, 3, 4, 5, 6, 7, 7, 8, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 9, 10, 7, 7,
+        7, 7, 11, 12, 12, 12, 12, 13, 14, 15, 16, 17, 18, 19, 20, 12, 21, 12, 12, 12, 12, 22, 7, 7,
+        23, 24, 12, 12, 12, 25, 26, 27, 12, 28, 29, 30, 31, 32, 12, 33, 7, 7, 7, 7, 7, 7, 7, 7,
+        7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 34, 7, 35, 36, 7, 37, 7, 7, 7, 38, 12, 39,
+        7, 7, 40, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+        12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 41,
+    };
+
+    // Leaf of `XID_LEAVES` for each 128 code points, `XID_ROW_SIZE` per row.
+    constexpr uint8_t XID_STAGE2[672] = {
+        0, 1, 2, 2, 2, 3, 4, 5, 2, 6, 7, 8, 9, 10, 11, 12,
+        13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28,
+        29, 30, 2, 2, 31, 32, 33, 34, 35, 2, 2, 2, 36, 37, 38, 39,
+        40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 2, 50, 2, 2, 51, 52,
+        53, 54, 55, 56, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+        57, 57, 57, 57, 57, 57, 57, 57, 2, 58, 59, 60, 57, 57, 57, 57,
+        61, 62, 63, 64, 57, 57, 57, 57, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 65, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 66, 2, 2, 67, 68, 69, 70,
+        71, 72, 73, 74, 75, 76, 77, 78, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 79,
+        57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+        57, 57, 2, 2, 80, 81, 82, 83, 84, 2, 85, 86, 87, 88, 89, 90,
+        91, 92, 93, 94, 57, 95, 96, 97, 2, 98, 99, 100, 2, 2, 101, 102,
+        103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 57, 57, 114, 115, 116,
+        117, 118, 119, 120, 121, 122, 123, 57, 124, 125, 57, 126, 127, 128, 129, 57,
+        130, 131, 132, 133, 134, 135, 57, 57, 136, 137, 138, 139, 57, 140, 57, 141,
+        2, 2, 2, 2, 2, 2, 2, 142, 143, 2, 144, 57, 57, 57, 57, 57,
+        57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 145,
+        2, 2, 2, 2, 2, 2, 2, 2, 146, 57, 57, 57, 57, 57, 57, 57,
+        57, 57, 57, 57, 57, 57, 57, 57, 2, 2, 2, 2, 147, 57, 57, 57,
+        2, 2, 2, 2, 148, 149, 150, 151, 57, 57, 57, 57, 152, 57, 153, 154,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 155,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 156, 56, 57, 57, 57, 57, 57,
+        57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 157,
+        2, 2, 158, 2, 2, 159, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+        57, 57, 57, 57, 57, 57, 57, 57, 160, 161, 57, 57, 57, 57, 57, 57,
+        57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 162, 57,
+        57, 57, 163, 164, 165, 57, 57, 57, 166, 167, 168, 2, 2, 169, 170, 171,
+        57, 57, 57, 57, 172, 173, 57, 57, 57, 57, 57, 57, 57, 57, 174, 57,
+        175, 57, 176, 57, 57, 177, 57, 57, 57, 57, 57, 57, 57, 57, 57, 178,
+        2, 179, 180, 57, 57, 57, 57, 57, 57, 57, 57, 57, 181, 182, 57, 57,
+        57, 57, 57, 57, 57, 57, 57, 183, 57, 57, 57, 57, 57, 57, 57, 57,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 184, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 185, 2,
+        186, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 187, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 188, 57, 57, 57, 57, 57, 57, 57, 57,
+        2, 2, 2, 2, 189, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+        2, 2, 2, 2, 2, 2, 190, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+        57, 57, 191, 192, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    };
+
+    // XID_Start bits in words 0 and 1, XID_Continue bits in words 2 and 3.
+    constexpr uint64_t XID_LEAVES[193][4] = {
+        { 0x0000000000000000, 0x07fffffe07fffffe, 0x03ff000000000000, 0x07fffffe87fffffe },
+        { 0x0420040000000000, 0xff7fffffff7fffff, 0x04a0040000000000, 0xff7fffffff7fffff },
+        { 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff },
+        { 0xffffffffffffffff, 0x0000501f0003ffc3, 0xffffffffffffffff, 0x0000501f0003ffc3 },
+        { 0x0000000000000000, 0xb8df000000000000, 0xffffffffffffffff, 0xb8dfffffffffffff },
+        { 0xfffffffbffffd740, 0xffbfffffffffffff, 0xfffffffbffffd7c0, 0xffbfffffffffffff },
+        { 0xfffffffffffffc03, 0xffffffffffffffff, 0xfffffffffffffcfb, 0xffffffffffffffff },
+        { 0xfffeffffffffffff, 0xffffffff027fffff, 0xfffeffffffffffff, 0xffffffff027fffff },
+        { 0x00000000000001ff, 0x000787ffffff0000, 0xbffffffffffe01ff, 0x000787ffffff00b6 },
+        { 0xffffffff00000000, 0xfffec000000007ff, 0xffffffff07ff0000, 0xffffc3ffffffffff },
+        { 0xffffffffffffffff, 0x9c00c060002fffff, 0xffffffffffffffff, 0x9ffffdff9fefffff },
+        { 0x0000fffffffd0000, 0xffffffffffffe000, 0xffffffffffff0000, 0xffffffffffffe7ff },
+        { 0x0002003fffffffff, 0x043007fffffffc00, 0x0003ffffffffffff, 0x243fffffffffffff },
+        { 0x00000110043fffff, 0xffff07ff01ffffff, 0x00003fffffffffff, 0xffff07ff0fffffff },
+        { 0xffffffff00007eff, 0x00000000000003ff, 0xffffffffff007eff, 0xfffffffbffffffff },
+        { 0x23fffffffffffff0, 0xfffe0003ff010000, 0xffffffffffffffff, 0xfffeffcfffffffff },
+        { 0x23c5fdfffff99fe1, 0x10030003b0004000, 0xf3c5fdfffff99fef, 0x5003ffcfb080799f },
+        { 0x036dfdfffff987e0, 0x001c00005e000000, 0xd36dfdfffff987ee, 0x003fffc05e023987 },
+        { 0x23edfdfffffbbfe0, 0x0200000300010000, 0xf3edfdfffffbbfee, 0xfe00ffcf00013bbf },
+        { 0x23edfdfffff99fe0, 0x00020003b0000000, 0xf3edfdfffff99fee, 0x0002ffcfb0e0399f },
+        { 0x03ffc718d63dc7e8, 0x0000000000010000, 0xc3ffc718d63dc7ec, 0x0000ffc000813dc7 },
+        { 0x23fffdfffffddfe0, 0x0000000327000000, 0xf3fffdfffffddfff, 0x0000ffcf27603ddf },
+        { 0x23effdfffffddfe1, 0x0006000360000000, 0xf3effdfffffddfef, 0x0006ffcf60603ddf },
+        { 0x27fffffffffddff0, 0xfc00000380704000, 0xfffffffffffddfff, 0xfc00ffcf80f07ddf },
+        { 0x2ffbfffffc7fffe0, 0x000000000000007f, 0x2ffbfffffc7fffee, 0x000cffc0ff5f847f },
+        { 0x0005fffffffffffe, 0x000000000000007f, 0x07fffffffffffffe, 0x0000000003ff7fff },
+        { 0x2005ffaffffff7d6, 0x00000000f000005f, 0x3fffffaffffff7d6, 0x00000000f3ff3f5f },
+        { 0x0000000000000001, 0x00001ffffffffeff, 0xc2a003ff03000001, 0xfffe1ffffffffeff },
+        { 0x0000000000001f00, 0x0000000000000000, 0x1ffffffffeffffdf, 0x0000000000000040 },
+        { 0x800007ffffffffff, 0xffe1c0623c3f0000, 0xffffffffffffffff, 0xffffffffffff03ff },
+        { 0xffffffff00004003, 0xf7ffffffffff20bf, 0xffffffff3fffffff, 0xf7ffffffffff20bf },
+        { 0xffffffffffffffff, 0xffffffff3d7f3dff, 0xffffffffffffffff, 0xffffffff3d7f3dff },
+        { 0x7f3dffffffff3dff, 0xffffffffff7fff3d, 0x7f3dffffffff3dff, 0xffffffffff7fff3d },
+        { 0xffffffffff3dffff, 0x0000000007ffffff, 0xffffffffff3dffff, 0x0003fe00e7ffffff },
+        { 0xffffffff0000ffff, 0x3f3fffffffffffff, 0xffffffff0000ffff, 0x3f3fffffffffffff },
+        { 0xfffffffffffffffe, 0xffffffffffffffff, 0xfffffffffffffffe, 0xffffffffffffffff },
+        { 0xffffffffffffffff, 0xffff9fffffffffff, 0xffffffffffffffff, 0xffff9fffffffffff },
+        { 0xffffffff07fffffe, 0x01ffc7ffffffffff, 0xffffffff07fffffe, 0x01ffc7ffffffffff },
+        { 0x0003ffff8003ffff, 0x0001dfff0003ffff, 0x001fffff803fffff, 0x000ddfff000fffff },
+        { 0x000fffffffffffff, 0x0000000010800000, 0xffffffffffffffff, 0x000003ff308fffff },
+        { 0xffffffff00000000, 0x01ffffffffffffff, 0xffffffff03ffb800, 0x01ffffffffffffff },
+        { 0xffff05ffffffffff, 0x003fffffffffffff, 0xffff07ffffffffff, 0x003fffffffffffff },
+        { 0x000000007fffffff, 0x001f3fffffff0000, 0x0fff0fff7fffffff, 0x001f3fffffffffc0 },
+        { 0xffff0fffffffffff, 0x00000000000003ff, 0xffff0fffffffffff, 0x0000000007ff03ff },
+        { 0xffffffff007fffff, 0x00000000001fffff, 0xffffffff0fffffff, 0x9fffffff7fffffff },
+        { 0x0000008000000000, 0x0000000000000000, 0xbfff008003ff03ff, 0x0000000000007fff },
+        { 0x000fffffffffffe0, 0x0000000000001fe0, 0xffffffffffffffff, 0x000ff80003ff1fff },
+        { 0xfc00c001fffffff8, 0x0000003fffffffff, 0xffffffffffffffff, 0x000fffffffffffff },
+        { 0x0000000fffffffff, 0x3ffffffffc00e000, 0x00ffffffffffffff, 0x3fffffffffffe3ff },
+        { 0xe7ffffffffff01ff, 0x046fde0000000000, 0xe7ffffffffff01ff, 0x07fffffffff70000 },
+        { 0xffffffffffffffff, 0x0000000000000000, 0xffffffffffffffff, 0xffffffffffffffff },
+        { 0xffffffff3f3fffff, 0x3fffffffaaff3f3f, 0xffffffff3f3fffff, 0x3fffffffaaff3f3f },
+        { 0x5fdfffffffffffff, 0x1fdc1fff0fcf1fdc, 0x5fdfffffffffffff, 0x1fdc1fff0fcf1fdc },
+        { 0x0000000000000000, 0x8002000000000000, 0x8000000000000000, 0x8002000000100001 },
+        { 0x000000001fff0000, 0x0000000000000000, 0x000000001fff0000, 0x0001ffe21fff0000 },
+        { 0xf3fffd503f2ffc84, 0xffffffff000043e0, 0xf3fffd503f2ffc84, 0xffffffff000043e0 },
+        { 0x00000000000001ff, 0x0000000000000000, 0x00000000000001ff, 0x0000000000000000 },
+        { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x0000000000000000 },
+        { 0xffffffffffffffff, 0x000c781fffffffff, 0xffffffffffffffff, 0x000ff81fffffffff },
+        { 0xffff20bfffffffff, 0x000080ffffffffff, 0xffff20bfffffffff, 0x800080ffffffffff },
+        { 0x7f7f7f7f007fffff, 0x000000007f7f7f7f, 0x7f7f7f7f007fffff, 0xffffffff7f7f7f7f },
+        { 0x1f3e03fe000000e0, 0xfffffffffffffffe, 0x1f3efffe000000e0, 0xfffffffffffffffe },
+        { 0xfffffffee07fffff, 0xf7ffffffffffffff, 0xfffffffee67fffff, 0xf7ffffffffffffff },
+        { 0xfffeffffffffffe0, 0xffffffffffffffff, 0xfffeffffffffffe0, 0xffffffffffffffff },
+        { 0xffffffff00007fff, 0xffff000000000000, 0xffffffff00007fff, 0xffff000000000000 },
+        { 0xffffffffffffffff, 0x0000000000000000, 0xffffffffffffffff, 0x0000000000000000 },
+        { 0x0000000000001fff, 0x3fffffffffff0000, 0x0000000000001fff, 0x3fffffffffff0000 },
+        { 0x00000c00ffff1fff, 0x80007fffffffffff, 0x00000fffffff1fff, 0xbff0ffffffffffff },
+        { 0xffffffff3fffffff, 0x0000ffffffffffff, 0xffffffffffffffff, 0x0003ffffffffffff },
+        { 0xfffffffcff800000, 0xffffffffffffffff, 0xfffffffcff800000, 0xffffffffffffffff },
+        { 0xfffffffffffff9ff, 0xfffc000003eb07ff, 0xfffffffffffff9ff, 0xfffc000003eb07ff },
+        { 0x00000007fffff7bb, 0x000fffffffffffff, 0x000010ffffffffff, 0x000fffffffffffff },
+        { 0x000ffffffffffffc, 0x68fc000000000000, 0xffffffffffffffff, 0xe8ffffff03ff003f },
+        { 0xffff003ffffffc00, 0x1fffffff0000007f, 0xffff3fffffffffff, 0x1fffffff000fffff },
+        { 0x0007fffffffffff0, 0x7c00ffdf00008000, 0xffffffffffffffff, 0x7fffffff03ff8001 },
+        { 0x000001ffffffffff, 0xc47fffff00000ff7, 0x007fffffffffffff, 0xfc7fffff03ff3fff },
+        { 0x3e62ffffffffffff, 0x001c07ff38000005, 0xffffffffffffffff, 0x007cffff38000007 },
+        { 0xffff7f7f007e7e7e, 0xffff03fff7ffffff, 0xffff7f7f007e7e7e, 0xffff03fff7ffffff },
+        { 0xffffffffffffffff, 0x00000007ffffffff, 0xffffffffffffffff, 0x03ff37ffffffffff },
+        { 0xffff000fffffffff, 0x0ffffffffffff87f, 0xffff000fffffffff, 0x0ffffffffffff87f },
+        { 0xffffffffffffffff, 0xffff3fffffffffff, 0xffffffffffffffff, 0xffff3fffffffffff },
+        { 0xffffffffffffffff, 0x0000000003ffffff, 0xffffffffffffffff, 0x0000000003ffffff },
+        { 0x5f7ffdffa0f8007f, 0xffffffffffffffdb, 0x5f7ffdffe0f8007f, 0xffffffffffffffdb },
+        { 0x0003ffffffffffff, 0xfffffffffff80000, 0x0003ffffffffffff, 0xfffffffffff80000 },
+        { 0xffffffffffffffff, 0xfffffff03fffffff, 0xffffffffffffffff, 0xfffffff03fffffff },
+        { 0x3fffffffffffffff, 0xffffffffffff0000, 0x3fffffffffffffff, 0xffffffffffff0000 },
+        { 0xfffffffffffcffff, 0x03ff0000000000ff, 0xfffffffffffcffff, 0x03ff0000000000ff },
+        { 0x0000000000000000, 0xaa8a000000000000, 0x0018ffff0000ffff, 0xaa8a00000000e000 },
+        { 0xffffffffffffffff, 0x1fffffffffffffff, 0xffffffffffffffff, 0x1fffffffffffffff },
+        { 0x07fffffe00000000, 0xffffffc007fffffe, 0x87fffffe03ff0000, 0xffffffc007fffffe },
+        { 0x7fffffff3fffffff, 0x000000001cfcfcfc, 0x7fffffffffffffff, 0x000000001cfcfcfc },
+        { 0xb7ffff7fffffefff, 0x000000003fff3fff, 0xb7ffff7fffffefff, 0x000000003fff3fff },
+        { 0xffffffffffffffff, 0x07ffffffffffffff, 0xffffffffffffffff, 0x07ffffffffffffff },
+        { 0x0000000000000000, 0x001fffffffffffff, 0x0000000000000000, 0x001fffffffffffff },
+        { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x2000000000000000 },
+        { 0xffffffff1fffffff, 0x000000000001ffff, 0xffffffff1fffffff, 0x000000010001ffff },
+        { 0xffffe000ffffffff, 0x003fffffffff07ff, 0xffffe000ffffffff, 0x07ffffffffff07ff },
+        { 0xffffffff3fffffff, 0x00000000003eff0f, 0xffffffff3fffffff, 0x00000000003eff0f },
+        { 0xffff00003fffffff, 0x0fffffffff0fffff, 0xffff03ff3fffffff, 0x0fffffffff0fffff },
+        { 0xffff00ffffffffff, 0xf7ff000fffffffff, 0xffff00ffffffffff, 0xf7ff000fffffffff },
+        { 0x1bfbfffbffb7f7ff, 0x0000000000000000, 0x1bfbfffbffb7f7ff, 0x0000000000000000 },
+        { 0x007fffffffffffff, 0x000000ff003fffff, 0x007fffffffffffff, 0x000000ff003fffff },
+        { 0x07fdffffffffffbf, 0x0000000000000000, 0x07fdffffffffffbf, 0x0000000000000000 },
+        { 0x91bffffffffffd3f, 0x007fffff003fffff, 0x91bffffffffffd3f, 0x007fffff003fffff },
+        { 0x000000007fffffff, 0x0037ffff00000000, 0x000000007fffffff, 0x0037ffff00000000 },
+        { 0x03ffffff003fffff, 0x0000000000000000, 0x03ffffff003fffff, 0x0000000000000000 },
+        { 0xc0ffffffffffffff, 0x0000000000000000, 0xc0ffffffffffffff, 0x0000000000000000 },
+        { 0x003ffffffeef0001, 0x1fffffff00000000, 0x873ffffffeeff06f, 0x1fffffff00000000 },
+        { 0x000000001fffffff, 0x0000001ffffffeff, 0x000000001fffffff, 0x0000007ffffffeff },
+        { 0x003fffffffffffff, 0x0007ffff003fffff, 0x003fffffffffffff, 0x0007ffff003fffff },
+        { 0x000000000003ffff, 0x0000000000000000, 0x000000000003ffff, 0x0000000000000000 },
+        { 0xffffffffffffffff, 0x00000000000001ff, 0xffffffffffffffff, 0x00000000000001ff },
+        { 0x0007ffffffffffff, 0x0007ffffffffffff, 0x0007ffffffffffff, 0x0007ffffffffffff },
+        { 0x0000000fffffffff, 0x0000000000000000, 0x03ff00ffffffffff, 0x0000000000000000 },
+        { 0x000303ffffffffff, 0x0000000000000000, 0x00031bffffffffff, 0x0000000000000000 },
+        { 0xffff00801fffffff, 0xffff00000000003f, 0xffff00801fffffff, 0xffff00000001ffff },
+        { 0xffff000000000003, 0x007fffff0000001f, 0xffff00000000003f, 0x007fffff0000001f },
+        { 0x00fffffffffffff8, 0x0026000000000000, 0xffffffffffffffff, 0x803fffc00000007f },
+        { 0x0000fffffffffff8, 0x000001ffffff0000, 0x07ffffffffffffff, 0x03ff01ffffff0004 },
+        { 0x0000007ffffffff8, 0x0047ffffffff0090, 0xffdfffffffffffff, 0x004fffffffff00f0 },
+        { 0x0007fffffffffff8, 0x000000001400001e, 0xffffffffffffffff, 0x0000000017ffde1f },
+        { 0x00000ffffffbffff, 0x0000000000000000, 0x40fffffffffbffff, 0x0000000000000000 },
+        { 0xffff01ffbfffbd7f, 0x000000007fffffff, 0xffff01ffbfffbd7f, 0x03ff07ffffffffff },
+        { 0x23edfdfffff99fe0, 0x00000003e0010000, 0xfbedfdfffff99fef, 0x001f1fcfe081399f },
+        { 0x001fffffffffffff, 0x0000000380000780, 0xffffffffffffffff, 0x00000003c3ff07ff },
+        { 0x0000ffffffffffff, 0x00000000000000b0, 0xffffffffffffffff, 0x0000000003ff00bf },
+        { 0x00007fffffffffff, 0x000000000f000000, 0xff3fffffffffffff, 0x000000003f000001 },
+        { 0x0000ffffffffffff, 0x0000000000000010, 0xffffffffffffffff, 0x0000000003ff0011 },
+        { 0x010007ffffffffff, 0x0000000000000000, 0x01ffffffffffffff, 0x00000000000003ff },
+        { 0x0000000007ffffff, 0x000000000000007f, 0x03ff0fffe7ffffff, 0x000000000000007f },
+        { 0x00000fffffffffff, 0x0000000000000000, 0x07ffffffffffffff, 0x0000000000000000 },
+        { 0xffffffff00000000, 0x80000000ffffffff, 0xffffffff00000000, 0x800003ffffffffff },
+        { 0x8000ffffff6ff27f, 0x0000000000000002, 0xf9bfffffff6ff27f, 0x0000000003ff000f },
+        { 0xfffffcff00000000, 0x0000000a0001ffff, 0xfffffcff00000000, 0x0000001bfcffffff },
+        { 0x0407fffffffff801, 0xfffffffff0010000, 0x7fffffffffffffff, 0xffffffffffff0080 },
+        { 0xffff0000200003ff, 0x01ffffffffffffff, 0xffff000023ffffff, 0x01ffffffffffffff },
+        { 0x00007ffffffffdff, 0xfffc000000000001, 0xff7ffffffffffdff, 0xfffc000003ff0001 },
+        { 0x000000000000ffff, 0x0000000000000000, 0x007ffefffffcffff, 0x0000000000000000 },
+        { 0x0001fffffffffb7f, 0xfffffdbf00000040, 0xb47ffffffffffb7f, 0xfffffdbf03ff00ff },
+        { 0x00000000010003ff, 0x0000000000000000, 0x000003ff01fb7fff, 0x0000000000000000 },
+        { 0x0000000000000000, 0x0007ffff00000000, 0x0000000000000000, 0x007fffff00000000 },
+        { 0x0001000000000000, 0x0000000000000000, 0x0001000000000000, 0x0000000000000000 },
+        { 0x0000000003ffffff, 0x0000000000000000, 0x0000000003ffffff, 0x0000000000000000 },
+        { 0xffffffffffffffff, 0x00007fffffffffff, 0xffffffffffffffff, 0x00007fffffffffff },
+        { 0xffffffffffffffff, 0x000000000000000f, 0xffffffffffffffff, 0x000000000000000f },
+        { 0xffffffffffff0000, 0x0001ffffffffffff, 0xffffffffffff0000, 0x0001ffffffffffff },
+        { 0x00007fffffffffff, 0x0000000000000000, 0x00007fffffffffff, 0x0000000000000000 },
+        { 0xffffffffffffffff, 0x000000000000007f, 0xffffffffffffffff, 0x000000000000007f },
+        { 0x01ffffffffffffff, 0xffff00007fffffff, 0x01ffffffffffffff, 0xffff03ff7fffffff },
+        { 0x7fffffffffffffff, 0x00003fffffff0000, 0x7fffffffffffffff, 0x001f3fffffff03ff },
+        { 0x0000ffffffffffff, 0xe0fffff80000000f, 0x007fffffffffffff, 0xe0fffff803ff000f },
+        { 0x000000000000ffff, 0x0000000000000000, 0x000000000000ffff, 0x0000000000000000 },
+        { 0x0000000000000000, 0xffffffffffffffff, 0x0000000000000000, 0xffffffffffffffff },
+        { 0xffffffffffffffff, 0x00000000000107ff, 0xffffffffffffffff, 0xffffffffffff87ff },
+        { 0x00000000fff80000, 0x0000000b00000000, 0x00000000ffff80ff, 0x0003001b00000000 },
+        { 0xffffffffffffffff, 0x00ffffffffffffff, 0xffffffffffffffff, 0x00ffffffffffffff },
+        { 0xffffffffffffffff, 0x00000000003fffff, 0xffffffffffffffff, 0x00000000003fffff },
+        { 0x0000000000000000, 0x6fef000000000000, 0x0000000000000000, 0x6fef000000000000 },
+        { 0x00000007ffffffff, 0xffff00f000070000, 0x00000007ffffffff, 0xffff00f000070000 },
+        { 0xffffffffffffffff, 0x0fffffffffffffff, 0xffffffffffffffff, 0x0fffffffffffffff },
+        { 0xffffffffffffffff, 0x1fff07ffffffffff, 0xffffffffffffffff, 0x1fff07ffffffffff },
+        { 0x0000000003ff01ff, 0x0000000000000000, 0x0000000063ff01ff, 0x0000000000000000 },
+        { 0x0000000000000000, 0x0000000000000000, 0xffff3fffffffffff, 0x000000000000007f },
+        { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0xf807e3e000000000 },
+        { 0x0000000000000000, 0x0000000000000000, 0x00003c0000000fe7, 0x0000000000000000 },
+        { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x000000000000001c },
+        { 0xffffffffffffffff, 0xffffffffffdfffff, 0xffffffffffffffff, 0xffffffffffdfffff },
+        { 0xebffde64dfffffff, 0xffffffffffffffef, 0xebffde64dfffffff, 0xffffffffffffffef },
+        { 0x7bffffffdfdfe7bf, 0xfffffffffffdfc5f, 0x7bffffffdfdfe7bf, 0xfffffffffffdfc5f },
+        { 0xffffff3fffffffff, 0xf7fffffff7fffffd, 0xffffff3fffffffff, 0xf7fffffff7fffffd },
+        { 0xffdfffffffdfffff, 0xffff7fffffff7fff, 0xffdfffffffdfffff, 0xffff7fffffff7fff },
+        { 0xfffffdfffffffdff, 0x0000000000000ff7, 0xfffffdfffffffdff, 0xffffffffffffcff7 },
+        { 0x0000000000000000, 0x0000000000000000, 0xf87fffffffffffff, 0x00201fffffffffff },
+        { 0x0000000000000000, 0x0000000000000000, 0x0000fffef8000010, 0x0000000000000000 },
+        { 0x000000007fffffff, 0x0000000000000000, 0x000000007fffffff, 0x0000000000000000 },
+        { 0x0000000000000000, 0x0000000000000000, 0x000007dbf9ffff7f, 0x0000000000000000 },
+        { 0x3f801fffffffffff, 0x0000000000004000, 0x3fff1fffffffffff, 0x00000000000043ff },
+        { 0x00003fffffff0000, 0x00000fffffffffff, 0x00007fffffff0000, 0x03ffffffffffffff },
+        { 0x0000000000000000, 0x7fff6f7f00000000, 0x0000000000000000, 0x7fff6f7f00000000 },
+        { 0xffffffffffffffff, 0x000000000000001f, 0xffffffffffffffff, 0x00000000007f001f },
+        { 0xffffffffffffffff, 0x000000000000080f, 0xffffffffffffffff, 0x0000000003ff0fff },
+        { 0x0af7fe96ffffffef, 0x5ef7f796aa96ea84, 0x0af7fe96ffffffef, 0x5ef7f796aa96ea84 },
+        { 0x0ffffbee0ffffbff, 0x0000000000000000, 0x0ffffbee0ffffbff, 0x0000000000000000 },
+        { 0x0000000000000000, 0x0000000000000000, 0x0000000000000000, 0x03ff000000000000 },
+        { 0xffffffffffffffff, 0x00000000ffffffff, 0xffffffffffffffff, 0x00000000ffffffff },
+        { 0x01ffffffffffffff, 0xffffffffffffffff, 0x01ffffffffffffff, 0xffffffffffffffff },
+        { 0xffffffff3fffffff, 0xffffffffffffffff, 0xffffffff3fffffff, 0xffffffffffffffff },
+        { 0xffff0003ffffffff, 0xffffffffffffffff, 0xffff0003ffffffff, 0xffffffffffffffff },
+        { 0xffffffffffffffff, 0x00000001ffffffff, 0xffffffffffffffff, 0x00000001ffffffff },
+        { 0x000000003fffffff, 0x0000000000000000, 0x000000003fffffff, 0x0000000000000000 },
+        { 0xffffffffffffffff, 0x00000000000007ff, 0xffffffffffffffff, 0x00000000000007ff },
+        { 0x0000000000000000, 0x0000000000000000, 0xffffffffffffffff, 0xffffffffffffffff },
+        { 0x0000000000000000, 0x0000000000000000, 0xffffffffffffffff, 0x0000ffffffffffff },
+    };
+}
+
+#endif
@@ -0,0 +1,574 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include "runtime.h"
+#include "vm.h"
+
+namespace
+{
+    constexpr size_t ARENA_CHUNK = 1 << 20;
+    constexpr uint32_t MAX_CALL_DEPTH = 10000;
+
+    template<typename T>
+    T wrap_add(const T a, const T b)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+    }
+
+    template<typename T>
+    T wrap_sub(const T a, const T b)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) - static_cast<U>(b));
+    }
+
+    template<typename T>
+    T wrap_mul(const T a, const T b)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) * static_cast<U>(b));
+    }
+
+    template<typename T>
+    T shift_left(const T a, const T b)
+    {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) << (b & (sizeof(T) * 8 - 1)));
+    }
+
+    // Field access goes through memcpy: fields of @packed classes are not aligned to their size.
+    template<typename T>
+    T load_field(const void* object, const uint32_t offset)
+    {
+        T value;
+        std::memcpy(&value, static_cast<const std::byte*>(object) + offset, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void store_field(void* object, const uint32_t offset, const T value)
+    {
+        std::memcpy(static_cast<std::byte*>(object) + offset, &value, sizeof(T));
+    }
+
+    // Saturating float to integer conversion; NaN converts to zero.
+    template<typename T, typename F>
+    T saturate(const F value)
+    {
+        if (std::isnan(value))
+            return 0;
+        if (value <= static_cast<F>(std::numeric_limits<T>::min()))
+            return std::numeric_limits<T>::min();
+        if (value >= static_cast<F>(std::numeric_limits<T>::max()))
+            return std::numeric_limits<T>::max();
+        return static_cast<T>(value);
+    }
+
+    void write_value(const vm::vm_t& vm, std::ostream& out, const vm::slot_t value, const ir::type_kind type)
+    {
+        switch (type)
+        {
+            case ir::type_kind::BOOL: out << (value.i32 != 0 ? "true" : "false"); break;
+            case ir::type_kind::I32: out << value.i32; break;
+            case ir::type_kind::I64: out << value.i64; break;
+            case ir::type_kind::F32: out << value.f32; break;
+            case ir::type_kind::F64: out << value.f64; break;
+            case ir::type_kind::STR: out << (value.ref != nullptr ? *static_cast<const std::string*>(value.ref) : std::string("null")); break;
+            case ir::type_kind::REF:
+            {
+                if (value.ref == nullptr)
+                {
+                    out << "null";
+                    break;
+                }
+                const auto* header = static_cast<const vm::object_header_t*>(value.ref) - 1;
+                out << vm.program->classes[header->class_id].name << "@" << value.ref;
+                break;
+            }
+            case ir::type_kind::TASK:
+                if (value.ref == nullptr)
+                    out << "null";
+                else
+                    out << "task@" << value.ref;
+                break;
+            default: break;
+        }
+    }
+
+    // io.write; with several workers a line is formatted first so it reaches the stream in one piece.
+    void write_line(const vm::vm_t& vm, const vm::slot_t* regs, const uint32_t* site)
+    {
+        const auto format = [&](std::ostream& out)
+        {
+            for (uint32_t k = 0; k < site[0]; ++k)
+            {
+                if (k != 0)
+                    out << " ";
+                write_value(vm, out, regs[site[1 + 2 * k]], static_cast<ir::type_kind>(site[2 + 2 * k]));
+            }
+            out << "\n";
+        };
+        if (vm.out_lock == nullptr)
+        {
+            format(*vm.out);
+            return;
+        }
+        std::ostringstream line;
+        format(line);
+        const std::lock_guard guard(*vm.out_lock);
+        *vm.out << line.view();
+    }
+
+    vm::status fail(vm::vm_t& vm, const vm::function_t& fn, const vm::instr_t* ip, const std::string& message)
+    {
+        vm.error = message + " in " + fn.name + " at " + std::to_string(ip - fn.code.data());
+        return vm::status::ERROR;
+    }
+
+    vm::status execute(vm::vm_t& vm, uint32_t index, vm::slot_t* regs, vm::slot_t* calls, uint32_t depth, runtime::task_t* task);
+
+    // Calls `target` with its frame at `frame`, which is directly after the caller's registers unless the
+    // caller is a coroutine.
+    vm::status invoke(vm::vm_t& vm, vm::slot_t* regs, vm::slot_t* frame, const uint32_t target, const uint32_t* args,
+        const uint32_t count, const uint32_t depth)
+    {
+        const vm::function_t& callee = vm.program->functions[target];
+        if (frame + callee.frame_size > vm.stack_limit || depth >= MAX_CALL_DEPTH)
+        {
+            vm.error = "stack overflow in " + callee.name;
+            return vm::status::ERROR;
+        }
+        for (uint32_t k = 0; k < count; ++k)
+            frame[k] = regs[args[k]];
+        return execute(vm, target, frame, frame + callee.frame_size, depth + 1, nullptr);
+    }
+
+    // Slow path of a virtual call: look the method up and remember it while the cache has room.
+    int32_t resolve_miss(vm::vm_t& vm, vm::inline_cache_t& cache, const uint32_t site, const uint32_t class_id)
+    {
+        ++cache.misses;
+        const int32_t target = vm::lookup_method(*vm.program, class_id, vm.program->sites[site].selector);
+        if (target < 0 || cache.megamorphic)
+            return target;
+        if (cache.count == vm::CACHE_WAYS)
+        {
+            cache.megamorphic = true;
+            return target;
+        }
+        cache.classes[cache.count] = class_id;
+        cache.targets[cache.count] = static_cast<uint32_t>(target);
+        ++cache.count;
+        return target;
+    }
+
+    // Runs function `index` with its registers at `regs`; callees get their frames from `calls` on. A
+    // coroutine runs on behalf of `task`: its registers are the task's frame, it starts where it last
+    // suspended, and AWAIT on an unfinished task returns SUSPENDED instead of waiting.
+    vm::status execute(vm::vm_t& vm, const uint32_t index, vm::slot_t* regs, vm::slot_t* calls, const uint32_t depth, runtime::task_t* task)
+    {
+        using vm::opcode;
+        const vm::function_t& fn = vm.program->functions[index];
+        const vm::instr_t* ip = fn.code.data() + (task != nullptr ? task->pc : 0);
+        const vm::slot_t* constants = fn.constants.data();
+        const uint32_t* operands = fn.operands.data();
+
+#define R(x) regs[ip->x]
+#define IMM (static_cast<uint32_t>(ip->b) | static_cast<uint32_t>(ip->c) << 16)
+
+#if LUMEN_VM_COMPUTED_GOTO
+        static void* const dispatch[] = {
+#define LUMEN_VM_LABEL(name) &&op_##name,
+            LUMEN_VM_OPCODES(LUMEN_VM_LABEL)
+#undef LUMEN_VM_LABEL
+        };
+#define TARGET(name) op_##name:
+#define DISPATCH() goto *dispatch[static_cast<uint8_t>(ip->op)]
+        DISPATCH();
+#else
+#define TARGET(name) case opcode::name:
+#define DISPATCH() goto dispatch
+    dispatch:
+        switch (ip->op)
+        {
+#endif
+#define NEXT() do { ++ip; DISPATCH(); } while (0)
+#define BINARY(name, field, expr) TARGET(name) { const auto x = R(b).field; const auto y = R(c).field; R(a).field = (expr); NEXT(); }
+#define UNARY(name, field, expr) TARGET(name) { const auto x = R(b).field; R(a).field = (expr); NEXT(); }
+#define COMPARE(name, field, op) TARGET(name) { R(a).i32 = R(b).field op R(c).field; NEXT(); }
+#define CONVERT(name, from, to, expr) TARGET(name) { const auto x = R(b).from; R(a).to = (expr); NEXT(); }
+#define JUMP_IF(name, field, op) TARGET(name) { if (R(b).field op R(c).field) ip = fn.code.data() + ip->a; else ++ip; DISPATCH(); }
+#define INT_DIVIDE(name, type, field, op) TARGET(name)                                     \
+        {                                                                                       \
+            const type x = R(b).field;                                                          \
+            const type y = R(c).field;                                                          \
+            if (y == 0)                                                                         \
+                return fail(vm, fn, ip, "division by zero");                                    \
+            R(a).field = y == -1 ? (op == '/' ? wrap_sub<type>(0, x) : 0) : (op == '/' ? x / y : x % y); \
+            NEXT();                                                                             \
+        }
+#define NULL_CHECK(obj) if ((obj) == nullptr) return fail(vm, fn, ip, "null dereference")
+
+        TARGET(NOP) NEXT();
+        TARGET(MOV) { R(a) = R(b); NEXT(); }
+        TARGET(LOADI) { R(a).i64 = static_cast<int32_t>(IMM); NEXT(); }
+        TARGET(LOADK) { R(a) = constants[IMM]; NEXT(); }
+
+        BINARY(ADD_I32, i32, wrap_add(x, y))
+        BINARY(SUB_I32, i32, wrap_sub(x, y))
+        BINARY(MUL_I32, i32, wrap_mul(x, y))
+        INT_DIVIDE(DIV_I32, int32_t, i32, '/')
+        INT_DIVIDE(REM_I32, int32_t, i32, '%')
+        BINARY(AND_I32, i32, x & y)
+        BINARY(OR_I32, i32, x | y)
+        BINARY(XOR_I32, i32, x ^ y)
+        BINARY(SHL_I32, i32, shift_left(x, y))
+        BINARY(SHR_I32, i32, x >> (y & 31))
+        UNARY(NEG_I32, i32, wrap_sub(0, x))
+        UNARY(NOT_I32, i32, ~x)
+
+        BINARY(ADD_I64, i64, wrap_add(x, y))
+        BINARY(SUB_I64, i64, wrap_sub(x, y))
+        BINARY(MUL_I64, i64, wrap_mul(x, y))
+        INT_DIVIDE(DIV_I64, int64_t, i64, '/')
+        INT_DIVIDE(REM_I64, int64_t, i64, '%')
+        BINARY(AND_I64, i64, x & y)
+        BINARY(OR_I64, i64, x | y)
+        BINARY(XOR_I64, i64, x ^ y)
+        BINARY(SHL_I64, i64, shift_left(x, y))
+        BINARY(SHR_I64, i64, x >> (y & 63))
+        UNARY(NEG_I64, i64, wrap_sub<int64_t>(0, x))
+        UNARY(NOT_I64, i64, ~x)
+
+        BINARY(ADD_F32, f32, x + y)
+        BINARY(SUB_F32, f32, x - y)
+        BINARY(MUL_F32, f32, x * y)
+        BINARY(DIV_F32, f32, x / y)
+        BINARY(REM_F32, f32, std::fmod(x, y))
+        UNARY(NEG_F32, f32, -x)
+
+        BINARY(ADD_F64, f64, x + y)
+        BINARY(SUB_F64, f64, x - y)
+        BINARY(MUL_F64, f64, x * y)
+        BINARY(DIV_F64, f64, x / y)
+        BINARY(REM_F64, f64, std::fmod(x, y))
+        UNARY(NEG_F64, f64, -x)
+
+        UNARY(NOT_BOOL, i32, x ^ 1)
+
+        COMPARE(EQ_I32, i32, ==)
+        COMPARE(NE_I32, i32, !=)
+        COMPARE(LT_I32, i32, <)
+        COMPARE(LE_I32, i32, <=)
+        COMPARE(EQ_I64, i64, ==)
+        COMPARE(NE_I64, i64, !=)
+        COMPARE(LT_I64, i64, <)
+        COMPARE(LE_I64, i64, <=)
+        COMPARE(EQ_F32, f32, ==)
+        COMPARE(NE_F32, f32, !=)
+        COMPARE(LT_F32, f32, <)
+        COMPARE(LE_F32, f32, <=)
+        COMPARE(EQ_F64, f64, ==)
+        COMPARE(NE_F64, f64, !=)
+        COMPARE(LT_F64, f64, <)
+        COMPARE(LE_F64, f64, <=)
+
+        CONVERT(I32_TO_I64, i32, i64, x)
+        CONVERT(I64_TO_I32, i64, i32, static_cast<int32_t>(x))
+        CONVERT(I32_TO_F32, i32, f32, static_cast<float>(x))
+        CONVERT(I32_TO_F64, i32, f64, x)
+        CONVERT(I64_TO_F32, i64, f32, static_cast<float>(x))
+        CONVERT(I64_TO_F64, i64, f64, static_cast<double>(x))
+        CONVERT(F32_TO_I32, f32, i32, saturate<int32_t>(x))
+        CONVERT(F32_TO_I64, f32, i64, saturate<int64_t>(x))
+        CONVERT(F64_TO_I32, f64, i32, saturate<int32_t>(x))
+        CONVERT(F64_TO_I64, f64, i64, saturate<int64_t>(x))
+        CONVERT(F32_TO_F64, f32, f64, x)
+        CONVERT(F64_TO_F32, f64, f32, static_cast<float>(x))
+
+        TARGET(NEW)
+        {
+            void* object = vm::allocate(vm, IMM);
+            if (object == nullptr)
+                return fail(vm, fn, ip, "out of memory");
+            R(a).ref = object;
+            NEXT();
+        }
+        TARGET(NEW_LOCAL)
+        {
+            // The header sits at the end of one slot and the data starts at the next, so the object keeps
+            // slot alignment.
+            static_assert(sizeof(vm::object_header_t) <= sizeof(vm::slot_t));
+            vm::slot_t* data = regs + ip->b + 1;
+            auto* header = reinterpret_cast<vm::object_header_t*>(data) - 1;
+            header->class_id = ip->c;
+            std::memset(data, 0, vm.program->classes[ip->c].size);
+            R(a).ref = data;
+            NEXT();
+        }
+        TARGET(LOAD_I8) { NULL_CHECK(R(b).ref); R(a).i32 = load_field<int8_t>(R(b).ref, ip->c); NEXT(); }
+        TARGET(LOAD_U8) { NULL_CHECK(R(b).ref); R(a).i32 = load_field<uint8_t>(R(b).ref, ip->c); NEXT(); }
+        TARGET(LOAD_I16) { NULL_CHECK(R(b).ref); R(a).i32 = load_field<int16_t>(R(b).ref, ip->c); NEXT(); }
+        TARGET(LOAD_U16) { NULL_CHECK(R(b).ref); R(a).i32 = load_field<uint16_t>(R(b).ref, ip->c); NEXT(); }
+        TARGET(LOAD_I32) { NULL_CHECK(R(b).ref); R(a).i32 = load_field<int32_t>(R(b).ref, ip->c); NEXT(); }
+        TARGET(LOAD_U32) { NULL_CHECK(R(b).ref); R(a).i64 = load_field<uint32_t>(R(b).ref, ip->c); NEXT(); }
+        TARGET(LOAD_64) { NULL_CHECK(R(b).ref); R(a).i64 = load_field<int64_t>(R(b).ref, ip->c); NEXT(); }
+        TARGET(STORE_8) { NULL_CHECK(R(a).ref); store_field<uint8_t>(R(a).ref, ip->b, static_cast<uint8_t>(R(c).i32)); NEXT(); }
+        TARGET(STORE_16) { NULL_CHECK(R(a).ref); store_field<uint16_t>(R(a).ref, ip->b, static_cast<uint16_t>(R(c).i32)); NEXT(); }
+        TARGET(STORE_32) { NULL_CHECK(R(a).ref); store_field<int32_t>(R(a).ref, ip->b, R(c).i32); NEXT(); }
+        TARGET(STORE_64) { NULL_CHECK(R(a).ref); store_field<int64_t>(R(a).ref, ip->b, R(c).i64); NEXT(); }
+        TARGET(COPY)
+        {
+            NULL_CHECK(R(a).ref);
+            NULL_CHECK(R(b).ref);
+            const uint32_t* copy = operands + ip->c;
+            std::memmove(static_cast<std::byte*>(R(a).ref) + copy[0], static_cast<std::byte*>(R(b).ref) + copy[1], copy[2]);
+            NEXT();
+        }
+
+        TARGET(CALL)
+        {
+            const uint32_t* site = operands + IMM;
+            if (invoke(vm, regs, calls, site[0], site + 2, site[1], depth) != vm::status::OK)
+                return vm::status::ERROR;
+            if (ip->aux != 0)
+                R(a) = vm.result;
+            NEXT();
+        }
+        TARGET(CALL_VIRTUAL)
+        {
+            const uint32_t* site = operands + IMM;
+            void* receiver = regs[site[2]].ref;
+            NULL_CHECK(receiver);
+            const uint32_t class_id = (static_cast<const vm::object_header_t*>(receiver) - 1)->class_id;
+            vm::inline_cache_t& cache = vm.caches[site[0]];
+            int32_t target = -1;
+            for (uint32_t k = 0; k < cache.count; ++k)
+            {
+                if (cache.classes[k] == class_id)
+                {
+                    target = static_cast<int32_t>(cache.targets[k]);
+                    ++cache.hits;
+                    break;
+                }
+            }
+            if (target < 0 && (target = resolve_miss(vm, cache, site[0], class_id)) < 0)
+                return fail(vm, fn, ip, vm.program->classes[class_id].name + " has no method " + vm.program->selectors[vm.program->sites[site[0]].selector]);
+            if (invoke(vm, regs, calls, static_cast<uint32_t>(target), site + 2, site[1], depth) != vm::status::OK)
+                return vm::status::ERROR;
+            if (ip->aux != 0)
+                R(a) = vm.result;
+            NEXT();
+        }
+        TARGET(SPAWN)
+        {
+            if (vm.worker == nullptr)
+                return fail(vm, fn, ip, "async call outside of a scheduler");
+            const uint32_t* site = operands + IMM;
+            runtime::task_t* spawned = runtime::spawn(*vm.worker, site[0], regs, site + 2, site[1]);
+            if (ip->aux != 0)
+                R(a).ref = spawned;
+            NEXT();
+        }
+        TARGET(AWAIT)
+        {
+            auto* awaited = static_cast<runtime::task_t*>(R(b).ref);
+            NULL_CHECK(awaited);
+            if (!runtime::is_done(*awaited))
+            {
+                // A coroutine hands its worker back and comes back to this instruction once the task is
+                // done; synchronous code keeps its frames and runs other tasks meanwhile.
+                if (task != nullptr)
+                {
+                    task->pc = static_cast<uint32_t>(ip - fn.code.data());
+                    vm.awaited = awaited;
+                    return vm::status::SUSPENDED;
+                }
+                if (runtime::wait(*vm.worker, *awaited, calls, depth) != vm::status::OK)
+                    return vm::status::ERROR;
+            }
+            if (ip->aux != 0)
+                R(a) = awaited->result;
+            NEXT();
+        }
+        TARGET(WRITE)
+        {
+            write_line(vm, regs, operands + IMM);
+            NEXT();
+        }
+
+        TARGET(JMP) { ip = fn.code.data() + IMM; DISPATCH(); }
+        TARGET(JMP_IF) { ip = R(a).i32 != 0 ? fn.code.data() + IMM : ip + 1; DISPATCH(); }
+        TARGET(JMP_IFNOT) { ip = R(a).i32 == 0 ? fn.code.data() + IMM : ip + 1; DISPATCH(); }
+        TARGET(RET) { vm.result = R(a); return vm::status::OK; }
+        TARGET(RET_VOID) { return vm::status::OK; }
+
+        TARGET(ADDI_I32) { R(a).i32 = wrap_add<int32_t>(R(b).i32, static_cast<int16_t>(ip->c)); NEXT(); }
+        TARGET(ADDI_I64) { R(a).i64 = wrap_add<int64_t>(R(b).i64, static_cast<int16_t>(ip->c)); NEXT(); }
+        JUMP_IF(JEQ_I32, i32, ==)
+        JUMP_IF(JNE_I32, i32, !=)
+        JUMP_IF(JLT_I32, i32, <)
+        JUMP_IF(JLE_I32, i32, <=)
+        JUMP_IF(JEQ_I64, i64, ==)
+        JUMP_IF(JNE_I64, i64, !=)
+        JUMP_IF(JLT_I64, i64, <)
+        JUMP_IF(JLE_I64, i64, <=)
+
+#if !LUMEN_VM_COMPUTED_GOTO
+            default:
+                return fail(vm, fn, ip, "invalid opcode");
+        }
+#endif
+
+#undef NULL_CHECK
+#undef INT_DIVIDE
+#undef JUMP_IF
+#undef CONVERT
+#undef COMPARE
+#undef UNARY
+#undef BINARY
+#undef NEXT
+#undef DISPATCH
+#undef TARGET
+#undef IMM
+#undef R
+    }
+}
+
+void vm::vm_init(vm_t& vm, const program_t& program, std::ostream& out)
+{
+    vm.program = &program;
+    vm.stack = std::make_unique_for_overwrite<slot_t[]>(STACK_SLOTS); // registers are written before they are read
+    vm.stack_limit = vm.stack.get() + STACK_SLOTS;
+    vm.result = {};
+    vm.heap = {};
+    vm.caches.assign(program.sites.size(), {});
+    vm.out = &out;
+    vm.out_lock = nullptr;
+    vm.worker = nullptr;
+    vm.awaited = nullptr;
+    vm.error.clear();
+}
+
+void* vm::allocate(vm_t& vm, const uint32_t class_id)
+{
+    const class_info_t& cls = vm.program->classes[class_id];
+    const size_t align = std::max<size_t>(cls.align, alignof(object_header_t));
+    const size_t size = std::max<size_t>(cls.size, 1);
+
+    // The header sits directly in front of the object data, which keeps the class alignment.
+    auto place = [&]() -> std::byte*
+    {
+        if (vm.heap.cursor == nullptr)
+            return nullptr;
+        auto data = reinterpret_cast<uintptr_t>(vm.heap.cursor) + sizeof(object_header_t);
+        data = (data + align - 1) & ~(align - 1);
+        if (data + size > reinterpret_cast<uintptr_t>(vm.heap.limit))
+            return nullptr;
+        vm.heap.cursor = reinterpret_cast<std::byte*>(data + size);
+        return reinterpret_cast<std::byte*>(data);
+    };
+
+    std::byte* data = place();
+    if (data == nullptr)
+    {
+        const size_t chunk = std::max(ARENA_CHUNK, size + align + sizeof(object_header_t));
+        vm.heap.chunks.push_back(std::make_unique<std::byte[]>(chunk));
+        vm.heap.cursor = vm.heap.chunks.back().get();
+        vm.heap.limit = vm.heap.cursor + chunk;
+        data = place();
+    }
+
+    std::memset(data, 0, size);
+    auto* header = reinterpret_cast<object_header_t*>(data) - 1;
+    header->class_id = class_id;
+    return data;
+}
+
+vm::status vm::call(vm_t& vm, const uint32_t function, const slot_t* args, const size_t count, slot_t& result)
+{
+    const function_t& fn = vm.program->functions[function];
+    if (count != fn.param_count || fn.frame_size > STACK_SLOTS)
+    {
+        vm.error = "bad call to " + fn.name;
+        return status::ERROR;
+    }
+    if (fn.coroutine)
+    {
+        vm.error = "async function " + fn.name + " called outside of a scheduler";
+        return status::ERROR;
+    }
+    std::copy_n(args, count, vm.stack.get());
+    vm.result = {};
+    const status s = execute(vm, function, vm.stack.get(), vm.stack.get() + fn.frame_size, 0, nullptr);
+    result = vm.result;
+    return s;
+}
+
+vm::status vm::resume(vm_t& vm, runtime::task_t& task, slot_t* base, const uint32_t depth)
+{
+    vm.result = {};
+    const status s = execute(vm, task.function, task.frame, base, depth, &task);
+    if (s == status::OK)
+        task.result = vm.result;
+    return s;
+}
+
+vm::status vm::run(vm_t& vm, int& exit_code)
+{
+    if (vm.program->entry < 0)
+    {
+        vm.error = "no main function";
+        return status::ERROR;
+    }
+    slot_t result;
+    const status s = call(vm, static_cast<uint32_t>(vm.program->entry), nullptr, 0, result);
+    const ir::type_kind type = vm.program->functions[vm.program->entry].return_type;
+    exit_code = 0;
+    if (s == status::OK && (type == ir::type_kind::I32 || type == ir::type_kind::BOOL))
+        exit_code = result.i32;
+    else if (s == status::OK && type == ir::type_kind::I64)
+        exit_code = static_cast<int>(result.i64);
+    return s;
+}
+
+int32_t vm::lookup_method(const program_t& program, const uint32_t class_id, const uint32_t selector)
+{
+    for (int32_t c = static_cast<int32_t>(class_id); c >= 0; c = program.classes[c].base)
+    {
+        for (const auto& [s, function] : program.classes[c].methods)
+        {
+            if (s == selector)
+                return static_cast<int32_t>(function);
+        }
+    }
+    return -1;
+}
+
+void vm::print_stats(const vm_t& vm, std::ostream& out)
+{
+    const program_t& program = *vm.program;
+    out << "Virtual call sites\n";
+    out << std::left << std::setw(32) << "site" << std::setw(14) << "state" << std::right << std::setw(12) << "hits"
+        << std::setw(12) << "misses" << "  classes\n";
+    for (size_t i = 0; i < program.sites.size(); ++i)
+    {
+        const call_site_t& site = program.sites[i];
+        const inline_cache_t& cache = vm.caches[i];
+        const std::string name = program.functions[site.function].name + "@" + std::to_string(site.pc) + " "
+            + program.selectors[site.selector];
+        const char* state = cache.megamorphic ? "megamorphic" : cache.count > 1 ? "polymorphic" : cache.count == 1 ? "monomorphic" : "unused";
+        out << std::left << std::setw(32) << name << std::setw(14) << state << std::right << std::setw(12) << cache.hits
+            << std::setw(12) << cache.misses << " ";
+        for (uint32_t k = 0; k < cache.count; ++k)
+            out << " " << program.classes[cache.classes[k]].name;
+        out << (cache.megamorphic ? " ..." : "") << "\n";
+    }
+}
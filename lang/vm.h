@@ -0,0 +1,216 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#ifndef VM_H
+#define VM_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "ir.h"
+#include "layout.h"
+
+// Computed-goto dispatch where the compiler supports labels as values; define
+// LUMEN_VM_SWITCH_DISPATCH to force the portable switch loop.
+#if !defined(LUMEN_VM_SWITCH_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define LUMEN_VM_COMPUTED_GOTO 1
+#else
+#define LUMEN_VM_COMPUTED_GOTO 0
+#endif
+
+// Operand conventions: `a` is the destination register unless noted, `b` and `c` are source
+// registers, and `imm` is the 32-bit immediate formed by `b | c << 16`.
+#define LUMEN_VM_OPCODES(X) \
+    X(NOP)                                                                                      \
+    X(MOV)                          /* a = b */                                                 \
+    X(LOADI)                        /* a = imm, sign-extended */                                \
+    X(LOADK)                        /* a = constants[imm] */                                    \
+    X(ADD_I32) X(SUB_I32) X(MUL_I32) X(DIV_I32) X(REM_I32)                                      \
+    X(AND_I32) X(OR_I32) X(XOR_I32) X(SHL_I32) X(SHR_I32) X(NEG_I32) X(NOT_I32)                 \
+    X(ADD_I64) X(SUB_I64) X(MUL_I64) X(DIV_I64) X(REM_I64)                                      \
+    X(AND_I64) X(OR_I64) X(XOR_I64) X(SHL_I64) X(SHR_I64) X(NEG_I64) X(NOT_I64)                 \
+    X(ADD_F32) X(SUB_F32) X(MUL_F32) X(DIV_F32) X(REM_F32) X(NEG_F32)                           \
+    X(ADD_F64) X(SUB_F64) X(MUL_F64) X(DIV_F64) X(REM_F64) X(NEG_F64)                           \
+    X(NOT_BOOL)                                                                                 \
+    X(EQ_I32) X(NE_I32) X(LT_I32) X(LE_I32)                                                     \
+    X(EQ_I64) X(NE_I64) X(LT_I64) X(LE_I64)                                                     \
+    X(EQ_F32) X(NE_F32) X(LT_F32) X(LE_F32)                                                     \
+    X(EQ_F64) X(NE_F64) X(LT_F64) X(LE_F64)                                                     \
+    X(I32_TO_I64) X(I64_TO_I32) X(I32_TO_F32) X(I32_TO_F64) X(I64_TO_F32) X(I64_TO_F64)         \
+    X(F32_TO_I32) X(F32_TO_I64) X(F64_TO_I32) X(F64_TO_I64) X(F32_TO_F64) X(F64_TO_F32)         \
+    X(NEW)                          /* a = new object of class imm */                           \
+    X(NEW_LOCAL)                    /* a = object of class c in the frame at slot b */          \
+    X(LOAD_I8) X(LOAD_U8) X(LOAD_I16) X(LOAD_U16) X(LOAD_I32) X(LOAD_U32) X(LOAD_64)            \
+                                    /* a = *(b + c) */                                          \
+    X(STORE_8) X(STORE_16) X(STORE_32) X(STORE_64)                                              \
+                                    /* *(a + b) = c */                                          \
+    X(COPY)                         /* copy between objects a and b, operands[c..c + 3) */      \
+    X(CALL)                         /* a = call, operands[imm] = function, argc, args... */     \
+    X(CALL_VIRTUAL)                 /* a = call, operands[imm] = site, argc, receiver, args... */ \
+    X(SPAWN)                        /* a = task, operands[imm] = async function, argc, args... */ \
+    X(AWAIT)                        /* a = result of task b, suspending a coroutine until it is done */ \
+    X(WRITE)                        /* io.write, operands[imm] = argc, (register, type)... */   \
+    X(JMP)                          /* pc = imm */                                              \
+    X(JMP_IF)                       /* if a: pc = imm */                                        \
+    X(JMP_IFNOT)                    /* if !a: pc = imm */                                       \
+    X(RET)                          /* return a */                                              \
+    X(RET_VOID)                                                                                 \
+    /* Superinstructions */                                                                     \
+    X(ADDI_I32) X(ADDI_I64)         /* a = b + (int16_t)c */                                    \
+    X(JEQ_I32) X(JNE_I32) X(JLT_I32) X(JLE_I32)                                                 \
+    X(JEQ_I64) X(JNE_I64) X(JLT_I64) X(JLE_I64)                                                 \
+                                    /* if b op c: pc = a */
+
+namespace runtime
+{
+    struct task_t;
+    struct worker_t;
+}
+
+namespace vm
+{
+    enum class opcode : uint8_t
+    {
+#define LUMEN_VM_ENUM(name) name,
+        LUMEN_VM_OPCODES(LUMEN_VM_ENUM)
+#undef LUMEN_VM_ENUM
+        COUNT
+    };
+
+    struct instr_t
+    {
+        opcode op;
+        uint8_t aux;
+        uint16_t a;
+        uint16_t b;
+        uint16_t c;
+    };
+
+    union slot_t
+    {
+        int32_t i32;
+        int64_t i64;
+        float f32;
+        double f64;
+        void* ref;
+    };
+
+    struct function_t
+    {
+        std::string name;
+        std::vector<instr_t> code;
+        std::vector<slot_t> constants;
+        std::vector<uint32_t> operands; // call sites, write arguments and copy descriptors
+        std::vector<uint32_t> string_constants; // constants whose `ref` points into `program_t::strings`
+        uint16_t register_count;
+        uint16_t param_count;
+        uint32_t frame_size; // registers plus objects allocated in the frame, in slots
+        ir::type_kind return_type;
+        bool coroutine; // `async`: runs in a task frame and may suspend at AWAIT
+    };
+
+    struct class_info_t
+    {
+        std::string name;
+        uint32_t size;
+        uint32_t align;
+        int32_t base;
+        std::vector<std::pair<uint32_t, uint32_t>> methods; // (selector, function) declared by this class
+    };
+
+    struct call_site_t
+    {
+        uint32_t function;
+        uint32_t pc;
+        uint32_t selector;
+    };
+
+    struct program_t
+    {
+        std::vector<function_t> functions;
+        std::vector<class_info_t> classes;
+        std::vector<std::string> selectors;
+        std::vector<call_site_t> sites; // virtual call sites, indexed by the inline cache id
+        std::vector<std::string> strings;
+        std::vector<std::string> error_log;
+        int32_t entry;
+    };
+
+    // Objects are laid out as `layout` computed them, preceded by this header.
+    struct object_header_t
+    {
+        uint32_t class_id;
+    };
+
+    enum class status : uint8_t
+    {
+        OK,
+        ERROR,
+        SUSPENDED, // a coroutine stopped at AWAIT; `vm_t::awaited` is the task it waits for
+    };
+
+    constexpr uint32_t CACHE_WAYS = 4;
+
+    // Per-site inline cache keyed on the receiver's class layout id. Empty, monomorphic (one entry) or
+    // polymorphic (up to CACHE_WAYS) while it has room; once another class shows up it is megamorphic
+    // and further misses go to the method lookup without being cached.
+    struct inline_cache_t
+    {
+        uint32_t classes[CACHE_WAYS];
+        uint32_t targets[CACHE_WAYS];
+        uint32_t count;
+        bool megamorphic;
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    struct arena_t
+    {
+        std::vector<std::unique_ptr<std::byte[]>> chunks;
+        std::byte* cursor;
+        std::byte* limit;
+    };
+
+    struct vm_t
+    {
+        const program_t* program;
+        std::unique_ptr<slot_t[]> stack;
+        slot_t* stack_limit;
+        slot_t result;
+        arena_t heap;
+        std::vector<inline_cache_t> caches;
+        std::ostream* out;
+        std::mutex* out_lock;     // serializes `io.write` between workers, null for a single VM
+        runtime::worker_t* worker; // the scheduler worker running this VM, null outside of a scheduler
+        runtime::task_t* awaited;
+        std::string error;
+    };
+
+    constexpr size_t STACK_SLOTS = 1 << 20;
+
+    bool compile_program(program_t& program, const ir::module_t& module, const layout::layout_table_t& layouts);
+    void print_program(const program_t& program, std::ostream& out);
+    // Flattens `program` for another process running the same executable, which rebuilds it with
+    // `read_program`. String constants travel as indices into `program_t::strings`.
+    std::string write_program(const program_t& program);
+    bool read_program(std::string_view data, program_t& program);
+    std::string_view opcode_name(opcode op);
+
+    void vm_init(vm_t& vm, const program_t& program, std::ostream& out);
+    status call(vm_t& vm, uint32_t function, const slot_t* args, size_t count, slot_t& result);
+    status resume(vm_t& vm, runtime::task_t& task, slot_t* base, uint32_t depth);
+    status run(vm_t& vm, int& exit_code);
+    void* allocate(vm_t& vm, uint32_t class_id);
+    int32_t lookup_method(const program_t& program, uint32_t class_id, uint32_t selector);
+    void print_stats(const vm_t& vm, std::ostream& out);
+
+    void flush_errors(const program_t& program);
+}
+
+#endif
@@ -1,32 +1,63 @@
+#include <charconv>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <string>
 #include <vector>
 
-#include "lang/lang.h"
+#include "lang/driver.h"
+#include "lang/server.h"
 
-int main()
+int main(const int argc, char** argv)
 {
-    constexpr std::string_view source = R"(function() -> void { var x: i32 = 0; })";
+    const std::vector<std::string> args(argv + 1, argv + argc);
 
-    lexer::lexer_t lexer;
-    lexer_init(lexer, source);
-
-    const std::vector<lexer::token_t> tokens = tokenize(lexer);
-    flush_errors(lexer);
-    std::cout << "Token count: " << tokens.size() << std::endl;
-    parser::parser_t parser;
-    parser_init(parser, tokens);
-
-    if (parse_program(parser))
+    // `lumen-lang serve` keeps compiled files in memory and answers requests from `lumen-client`.
+    if (!args.empty() && args[0] == "serve")
     {
-        std::cout << "Parsing completed successfully." << "\n";
+        std::string socket_path = server::default_socket();
+        uint32_t run_timeout = server::DEFAULT_RUN_TIMEOUT;
+        for (size_t i = 1; i < args.size(); ++i)
+        {
+            if (args[i] == "--stdio")
+            {
+                socket_path.clear();
+            }
+            else if (args[i] == "--socket" && i + 1 < args.size())
+            {
+                socket_path = args[++i];
+            }
+            else if (args[i] == "--timeout" && i + 1 < args.size())
+            {
+                const std::string& seconds = args[++i];
+                const auto [end, error] = std::from_chars(seconds.data(), seconds.data() + seconds.size(), run_timeout);
+                if (error != std::errc() || end != seconds.data() + seconds.size() || run_timeout == 0)
+                {
+                    std::cerr << "Invalid timeout: " << seconds << "\n";
+                    return 1;
+                }
+            }
+            else
+            {
+                std::cerr << "Unknown option: " << args[i] << "\n";
+                return 1;
+            }
+        }
+        // Programs run in a fresh copy of this executable. /proc/self/exe stays this very binary even if
+        // the file is rebuilt meanwhile, so the copy always reads the bytecode the server writes.
+        std::error_code error;
+        const std::string runner = std::filesystem::exists("/proc/self/exe", error) ? "/proc/self/exe" : argv[0];
+        return server::serve(socket_path, runner, run_timeout);
     }
-    else
+
+    // `lumen-lang run-program` runs a program that `serve` built and sent on standard input.
+    if (args.size() == 1 && args[0] == "run-program")
     {
-        std::cerr << "Parsing failed." << "\n";
+        const std::string data(std::istreambuf_iterator<char>(std::cin), {});
+        return driver::run_serialized(data);
     }
 
-    lexer.tokens.clear();
-    lexer.tokens.shrink_to_fit();
-
-    return 0;
+    driver::cache_t cache = {};
+    std::error_code error;
+    return driver::execute(cache, args, std::filesystem::current_path(error).string());
 }
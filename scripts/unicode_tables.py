@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+# Created by alpluspluss on 10/18/2026 AD.
+#
+# Generates lang/unicode_data.h, the XID_Start/XID_Continue tables used by the lexer. Python's
+# `str.isidentifier` implements UAX #31 on the interpreter's Unicode database, so the script needs a
+# Python whose `unicodedata` is Unicode 14.0.0 (3.11) for the output to stay reproducible.
+#
+# Three levels: code point >> 11 picks a row of 16 leaf ids, and a leaf holds the start and continue
+# bits of 128 code points. Identical rows and leaves are stored once.
+#
+# Usage: python3 scripts/unicode_tables.py > lang/unicode_data.h
+
+import sys
+import unicodedata
+
+UNICODE_VERSION = "14.0.0"
+STAGE1_SHIFT = 11
+LEAF_SHIFT = 7
+ROW_SIZE = 1 << (STAGE1_SHIFT - LEAF_SHIFT)
+LEAF_SIZE = 1 << LEAF_SHIFT
+
+
+def xid_start(code):
+    # '_' may start a Python identifier but is not XID_Start; the lexer accepts it on its own.
+    return code != ord("_") and chr(code).isidentifier()
+
+
+def xid_continue(code):
+    return ("a" + chr(code)).isidentifier()
+
+
+def bits(flags):
+    words = []
+    for w in range(0, LEAF_SIZE, 64):
+        words.append(sum(1 << i for i in range(64) if flags[w + i]))
+    return words
+
+
+def rows_of(values, per_line, width):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("        " + ", ".join(f"{v:#0{width}x}" if width else str(v) for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    if unicodedata.unidata_version != UNICODE_VERSION:
+        sys.exit(f"expected Unicode {UNICODE_VERSION}, this Python has {unicodedata.unidata_version}")
+
+    limit = max(c for c in range(0x110000) if xid_continue(c)) + 1
+    limit = (limit + (1 << STAGE1_SHIFT) - 1) >> STAGE1_SHIFT << STAGE1_SHIFT
+
+    leaves = {}
+    leaf_ids = []
+    for base in range(0, limit, LEAF_SIZE):
+        span = range(base, base + LEAF_SIZE)
+        key = tuple(bits([xid_start(c) for c in span]) + bits([xid_continue(c) for c in span]))
+        leaf_ids.append(leaves.setdefault(key, len(leaves)))
+
+    rows = {}
+    stage1 = []
+    for i in range(0, len(leaf_ids), ROW_SIZE):
+        stage1.append(rows.setdefault(tuple(leaf_ids[i:i + ROW_SIZE]), len(rows)))
+    assert len(rows) <= 256 and len(leaves) <= 256
+
+    stage2 = [leaf for row in rows for leaf in row]
+    leaf_words = [word for leaf in leaves for word in leaf]
+    size = len(stage1) + len(stage2) + 8 * len(leaf_words)
+
+    print(f"""//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+// Generated by scripts/unicode_tables.py from Unicode {UNICODE_VERSION}; do not edit. {size} bytes in total.
+//
+
+#ifndef UNICODE_DATA_H
+#define UNICODE_DATA_H
+
+#include <cstdint>
+
+namespace unicode
+{{
+    constexpr char32_t XID_LIMIT = {limit:#x}; // no identifier characters at or above
+    constexpr uint32_t XID_STAGE1_SHIFT = {STAGE1_SHIFT};
+    constexpr uint32_t XID_LEAF_SHIFT = {LEAF_SHIFT};
+    constexpr uint32_t XID_ROW_SIZE = {ROW_SIZE};
+
+    // Row of `XID_STAGE2` for each {1 << STAGE1_SHIFT} code points.
+    constexpr uint8_t XID_STAGE1[{len(stage1)}] = {{
+{rows_of(stage1, 24, 0)}
+    }};
+
+    // Leaf of `XID_LEAVES` for each {LEAF_SIZE} code points, `XID_ROW_SIZE` per row.
+    constexpr uint8_t XID_STAGE2[{len(stage2)}] = {{
+{rows_of(stage2, ROW_SIZE, 0)}
+    }};
+
+    // XID_Start bits in words 0 and 1, XID_Continue bits in words 2 and 3.
+    constexpr uint64_t XID_LEAVES[{len(leaves)}][4] = {{
+{chr(10).join("        { " + ", ".join(f"{w:#018x}" for w in leaf) + " }," for leaf in leaves)}
+    }};
+}}
+
+#endif""")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,15 @@
+//
+// Created by alpluspluss on 10/18/2026 AD.
+//
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+
+// Records a failed condition and keeps going; tests return `failures == 0 ? 0 : 1` from main.
+#define CHECK(cond) do { if (!(cond)) { std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n"; ++failures; } } while (0)
+
+inline int failures = 0;
+
+#endif
@@ -0,0 +1,149 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include "../lang/driver.h"
+#include "../lang/server.h"
+#include "check.h"
+
+static void write_file(const std::filesystem::path& path, const std::string_view text)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+// Runs the driver with std::cout captured.
+static int execute(driver::cache_t& cache, const std::vector<std::string>& args, const std::string& cwd, std::string& out)
+{
+    std::ostringstream buffer;
+    std::streambuf* saved = std::cout.rdbuf(buffer.rdbuf());
+    const int exit_code = driver::execute(cache, args, cwd);
+    std::cout.rdbuf(saved);
+    out = buffer.str();
+    return exit_code;
+}
+
+static int connect_to(const std::string& socket_path)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    socket_path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send(const std::string& socket_path, const server::request_t& request, server::response_t& response)
+{
+    const int fd = connect_to(socket_path);
+    const bool ok = fd >= 0 && server::write_request(fd, request) && server::read_response(fd, response);
+    if (fd >= 0)
+        ::close(fd);
+    return ok;
+}
+
+int main()
+{
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / ("lumen-driver-" + std::to_string(::getpid()));
+    std::filesystem::create_directories(dir);
+    write_file(dir / "main.lm", "function main() -> i32\n{\n    io.write(6 * 7);\n    return 3;\n}\n");
+
+    driver::cache_t cache = {};
+    std::string first;
+    std::string second;
+    CHECK(execute(cache, { "run", "main.lm" }, dir.string(), first) == 3 && first == "42\n");
+    CHECK(cache.misses == 1 && cache.hits == 0);
+
+    // An unchanged file is served from the cache, including its bytecode.
+    CHECK(execute(cache, { "run", "main.lm" }, dir.string(), second) == 3 && second == first);
+    CHECK(cache.misses == 1 && cache.hits == 1);
+    CHECK(cache.units.size() == 1 && cache.units.begin()->second->compiled);
+
+    // A cache hit says its pass timings are old rather than presenting them as measured now.
+    std::ostringstream timings;
+    std::streambuf* saved_err = std::cerr.rdbuf(timings.rdbuf());
+    CHECK(execute(cache, { "main.lm", "--time-passes" }, dir.string(), second) == 0);
+    std::cerr.rdbuf(saved_err);
+    CHECK(timings.str().starts_with("(pass timings from the cached build; no passes ran)\n===== Pass timings ====="));
+
+    // Matching hashes are not enough: a unit whose source differs is built again.
+    cache.units.begin()->second->source += " ";
+    CHECK(execute(cache, { "run", "main.lm" }, dir.string(), second) == 3 && second == first);
+    CHECK(cache.misses == 2 && cache.hits == 2);
+
+    // Changing the content or a build option processes the file again.
+    write_file(dir / "main.lm", "function main() -> i32\n{\n    io.write(6 * 8);\n    return 4;\n}\n");
+    CHECK(execute(cache, { "run", "main.lm" }, dir.string(), second) == 4 && second == "48\n");
+    CHECK(execute(cache, { "run", "--no-opt", (dir / "main.lm").string() }, "/", second) == 4 && second == "48\n");
+    CHECK(cache.misses == 4 && cache.hits == 2 && cache.units.size() == 1);
+
+    // Failed builds are not kept.
+    write_file(dir / "broken.lm", "function main( -> i32 {");
+    CHECK(execute(cache, { "broken.lm" }, dir.string(), second) == 1);
+    CHECK(cache.units.size() == 1);
+
+    // The program a server hands to `lumen-lang run-program` survives being flattened, string constants included.
+    driver::unit_t unit;
+    CHECK(driver::build_program(unit, "function main() -> i32\n{\n    io.write(\"six\", 6);\n    return 2;\n}\n"));
+    std::ostringstream ran;
+    std::streambuf* saved_out = std::cout.rdbuf(ran.rdbuf());
+    const std::string flat = driver::write_invocation({ &unit, 1, false });
+    CHECK(driver::run_serialized(flat) == 2);
+    std::cout.rdbuf(saved_out);
+    CHECK(ran.str() == "six 6\n");
+    std::ostringstream rejected;
+    saved_err = std::cerr.rdbuf(rejected.rdbuf());
+    CHECK(driver::run_serialized(std::string_view(flat).substr(0, flat.size() - 1)) == 1);
+    std::cerr.rdbuf(saved_err);
+    CHECK(rejected.str() == "Invalid program\n");
+
+    // Requests and responses survive the wire format.
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    server::request_t request = { "/work", { "run", "--vm-stats", "with\nnewline.lm" } };
+    server::request_t received;
+    CHECK(server::write_request(fds[1], request) && server::read_request(fds[0], received));
+    CHECK(received.cwd == request.cwd && received.args == request.args);
+    server::response_t response = { -1, "out", "" };
+    server::response_t back;
+    CHECK(server::write_response(fds[1], response) && server::read_response(fds[0], back));
+    CHECK(back.exit_code == -1 && back.out == "out" && back.err.empty());
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    // The server answers other clients while one has connected without sending anything, and stops a
+    // program that runs past the timeout without stopping itself.
+    const std::string socket_path = (dir / "server.sock").string();
+    std::thread serving([&] { server::serve(socket_path, LUMEN_LANG_EXECUTABLE, 1); });
+    int stalled = -1;
+    for (int attempt = 0; attempt < 100 && stalled < 0; ++attempt)
+    {
+        stalled = connect_to(socket_path);
+        if (stalled < 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK(stalled >= 0);
+    write_file(dir / "loop.lm", "function main() -> i32\n{\n    while (true)\n    {\n    }\n    return 0;\n}\n");
+    write_file(dir / "greet.lm", "function main() -> i32\n{\n    io.write(\"answer\", 6 * 7);\n    return 0;\n}\n");
+    CHECK(send(socket_path, { dir.string(), { "run", "main.lm" } }, back) && back.exit_code == 4 && back.out == "48\n");
+    CHECK(send(socket_path, { dir.string(), { "run", "--vm-stats", "greet.lm" } }, back) && back.exit_code == 0);
+    CHECK(back.out == "answer 42\n" && !back.err.empty());
+    CHECK(send(socket_path, { dir.string(), { "run", "loop.lm" } }, back) && back.exit_code == 1);
+    CHECK(back.err == "Program did not finish within 1 s\n");
+    CHECK(send(socket_path, { dir.string(), { "--status" } }, back) && back.out.starts_with("units 3,"));
+    ::close(stalled);
+    CHECK(send(socket_path, { dir.string(), { "--shutdown" } }, back) && back.exit_code == 0);
+    serving.join();
+
+    std::filesystem::remove_all(dir);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <iostream>
+#include "../lang/ir.h"
+#include "check.h"
+
+static constexpr std::string_view source = R"(
+class Vector3
+{
+    var x: i32 = 0;
+    var y: i32 = 0;
+    var z: i32 = 0;
+};
+
+inline function square(v: i32) -> i32
+{
+    return v * v;
+}
+
+function folded() -> i32
+{
+    var a: i32 = 2 * 3 + 4;
+    if (a > 5)
+        return a;
+    return 0;
+}
+
+function common(x: i32, y: i32) -> i32
+{
+    var a: i32 = x * y + 1;
+    var b: i32 = x * y + 1;
+    return a + b;
+}
+
+function loop(n: i32) -> i64
+{
+    var total: i64 = 0;
+    for (var i: i32 = 0; i < n; i += 1)
+    {
+        if (i % 2 == 0 && i > 3)
+            total += square(i);
+        else
+            continue;
+    }
+    return total;
+}
+
+function fields() -> i32
+{
+    var v: Vector3 = Vector3(1, 2, 3);
+    v.y += 5;
+    return v.x + v.y + v.z;
+}
+
+function sum(v: Vector3) -> i32
+{
+    return v.x + v.y + v.z;
+}
+
+function local(n: i32) -> i32
+{
+    var v: Vector3 = new Vector3();
+    v.x = n;
+    return sum(v);
+}
+
+function checked(a: i32, b: i32) -> i32
+{
+    var q: i32 = a / b;
+    var r: i32 = a % 4;
+    return a;
+}
+
+inline function spin(n: i32) -> i32
+{
+    while (true)
+        n += 1;
+}
+
+function stuck(n: i32) -> i32
+{
+    return spin(n) + 2;
+}
+
+function leak() -> Vector3
+{
+    return new Vector3();
+}
+
+@aligned(32)
+class Block
+{
+    var a: i32 = 0;
+    var b: i32 = 0;
+};
+
+function total(b: Block) -> i32
+{
+    return b.a + b.b;
+}
+
+function aligned(n: i32) -> i32
+{
+    var b: Block = new Block();
+    b.a = n;
+    return total(b);
+}
+)";
+
+static size_t count(const ir::function_t& fn, const ir::opcode op)
+{
+    return static_cast<size_t>(std::ranges::count_if(fn.insts, [&](const ir::inst_t& inst) { return inst.op == op; }));
+}
+
+int main()
+{
+    lexer::lexer_t lexer;
+    lexer::lexer_init(lexer, source);
+    const auto tokens = lexer::tokenize(lexer);
+    parser::parser_t parser;
+    parser::parser_init(parser, tokens);
+    CHECK(parser::parse_program(parser));
+
+    layout::layout_table_t layouts;
+    layout::layout_init(layouts, parser.module);
+    CHECK(layout::compute_layouts(layouts));
+
+    ir::module_t module;
+    CHECK(ir::lower_module(module, parser, layouts));
+    ir::flush_errors(module);
+
+    std::string error;
+    for (const auto& fn : module.functions)
+        CHECK(ir::verify(fn, error));
+
+    const auto& loop = module.functions[ir::find_function(module, "loop")];
+    CHECK(count(loop, ir::opcode::PHI) >= 2);
+    CHECK(count(loop, ir::opcode::CALL) == 1);
+
+    ir::pass_manager_t passes;
+    ir::pass_manager_init(passes);
+    size_t hook_calls = 0;
+    size_t invalid = 0;
+    passes.hook = [&](std::string_view, const ir::function_t& fn, std::chrono::nanoseconds)
+    {
+        ++hook_calls;
+        invalid += !ir::verify(fn, error);
+    };
+    ir::run_passes(passes, module);
+    CHECK(hook_calls == passes.passes.size() * module.functions.size());
+    CHECK(invalid == 0);
+
+    for (const auto& fn : module.functions)
+    {
+        CHECK(ir::verify(fn, error));
+        if (!error.empty())
+            std::cerr << error << "\n";
+    }
+
+    // Constant folding removes the branch entirely: `return 10`.
+    const auto& folded = module.functions[ir::find_function(module, "folded")];
+    CHECK(folded.blocks.size() == 1 && folded.insts.size() == 2);
+    CHECK(folded.insts[0].op == ir::opcode::CONST && folded.insts[0].a == 10);
+
+    // Value numbering computes `x * y + 1` once.
+    const auto& common = module.functions[ir::find_function(module, "common")];
+    CHECK(count(common, ir::opcode::MUL) == 1);
+
+    // `square` is inlined into the loop.
+    CHECK(count(module.functions[ir::find_function(module, "loop")], ir::opcode::CALL) == 0);
+
+    // The object in `fields` is replaced by its fields, which then fold to `return 11`.
+    const auto& fields = module.functions[ir::find_function(module, "fields")];
+    CHECK(count(fields, ir::opcode::NEW) == 0 && count(fields, ir::opcode::STORE) == 0);
+    CHECK(fields.insts.size() == 2 && fields.insts[0].op == ir::opcode::CONST && fields.insts[0].a == 11);
+
+    // A dead division by a variable may still trap, so it stays; one by a non-zero constant goes.
+    const auto& checked = module.functions[ir::find_function(module, "checked")];
+    CHECK(count(checked, ir::opcode::DIV) == 1 && count(checked, ir::opcode::REM) == 0);
+
+    // `spin` never returns a value; inlining it leaves no use of the removed call behind.
+    CHECK(count(module.functions[ir::find_function(module, "stuck")], ir::opcode::CALL) == 0);
+
+    // `sum` only reads through its parameter, so the object it is given can live in the caller's frame.
+    const auto placement = [&](const std::string_view function)
+    {
+        const auto it = std::ranges::find_if(module.allocations, [&](const ir::allocation_t& allocation)
+        {
+            return module.functions[allocation.function].name == function;
+        });
+        return it != module.allocations.end() ? *it : ir::allocation_t { 0, 0, ir::alloc_kind::HEAP, "not found" };
+    };
+    CHECK(placement("fields").kind == ir::alloc_kind::SCALAR);
+    CHECK(placement("local").kind == ir::alloc_kind::STACK);
+    CHECK(placement("leak").kind == ir::alloc_kind::HEAP);
+
+    // A frame only guarantees slot alignment, so an over-aligned object that does not escape stays on the heap.
+    CHECK(placement("aligned").kind == ir::alloc_kind::HEAP);
+    CHECK(placement("aligned").reason == "aligned to 32 bytes, more than a frame provides");
+
+    return failures == 0 ? 0 : 1;
+}
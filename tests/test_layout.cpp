@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include "../lang/lang.h"
+#include "../lang/layout.h"
+#include "check.h"
+
+static constexpr std::string_view source = R"(
+package game;
+
+@packed
+@aligned(16)
+class Vector3
+{
+    var x: i32 = 0;
+    var y: i32 = 0;
+    var z: i32 = 0;
+};
+
+class Padded
+{
+    var flag: boolean;
+    var value: f64;
+    var small: u16;
+};
+
+@aligned
+class Counter
+{
+    var hits: u64;
+};
+
+class Entity extends Padded
+{
+    var position: Vector3;
+    var tag: u8;
+};
+
+class Generic<T>
+{
+    var value: T;
+};
+
+class Holder
+{
+    var item: Generic<i32>;
+};
+)";
+
+static bool build(parser::parser_t& parser, lexer::lexer_t& lexer, layout::layout_table_t& table, const bool reorder,
+    const std::string_view text = source)
+{
+    lexer::lexer_init(lexer, text);
+    const auto tokens = lexer::tokenize(lexer);
+    parser::parser_init(parser, tokens);
+    if (!parser::parse_program(parser))
+        return false;
+    layout::layout_init(table, parser.module, { reorder });
+    return layout::compute_layouts(table);
+}
+
+int main()
+{
+    lexer::lexer_t lexer;
+    parser::parser_t parser;
+    layout::layout_table_t table;
+    CHECK(build(parser, lexer, table, false));
+
+    const auto* vector3 = layout::find_layout(table, "Vector3");
+    CHECK(vector3 && vector3->size == 16 && vector3->align == 16 && vector3->data_size == 12);
+    CHECK(vector3 && vector3->fields[2].offset == 8 && vector3->tail_padding == 4);
+
+    const auto* padded = layout::find_layout(table, "Padded");
+    CHECK(padded && padded->size == 24 && padded->align == 8 && !padded->reordered);
+    CHECK(padded && padded->reordered_size == 16);
+
+    const auto* counter = layout::find_layout(table, "Counter");
+    CHECK(counter && counter->size == layout::CACHE_LINE_SIZE && counter->align == layout::CACHE_LINE_SIZE);
+
+    const auto* entity = layout::find_layout(table, "Entity");
+    CHECK(entity && entity->base_field_count == 3 && entity->fields[3].offset == 32);
+    CHECK(entity && layout::find_field(*entity, "value")->offset == 8);
+
+    const auto* generic = layout::find_layout(table, "Generic<i32>");
+    CHECK(generic && generic->size == 4);
+    CHECK(layout::find_layout(table, "Holder")->size == 4);
+
+    CHECK(build(parser, lexer, table, true));
+    padded = layout::find_layout(table, "Padded");
+    CHECK(padded && padded->reordered && padded->size == 16 && padded->fields[0].name == "value");
+    vector3 = layout::find_layout(table, "Vector3");
+    CHECK(vector3 && !vector3->reordered && vector3->fields[0].name == "x");
+
+    // Generic arguments are plain names; nested, nullable or array arguments are rejected rather than dropped.
+    for (const std::string_view field : { "var item: Generic<Generic<i32> >;", "var item: Generic<i32?>;", "var item: Generic<[i32]>;" })
+    {
+        const std::string text = "class Generic<T>\n{\n    var value: T;\n};\nclass Holder\n{\n    " + std::string(field) + "\n};\n";
+        CHECK(!build(parser, lexer, table, false, text));
+        CHECK(std::ranges::find(parser.error_log, "Type arguments must be plain type names.") != parser.error_log.end());
+    }
+
+    // Calls through a final class or method are bound directly, so they cannot be overridden.
+    CHECK(!build(parser, lexer, table, false, R"(
+final class Base
+{
+    public virtual function speak() -> i32 { return 2; }
+};
+class Derived extends Base
+{
+    public function speak() -> i32 { return 3; }
+};
+)"));
+    CHECK(table.error_log.size() == 1 && table.error_log[0] == "Class 'Derived' cannot extend final class 'Base'");
+
+    CHECK(!build(parser, lexer, table, false, R"(
+class Base
+{
+    public virtual function speak() -> i32 { return 2; }
+};
+class Middle extends Base
+{
+    public final function speak() -> i32 { return 4; }
+};
+class Leaf extends Middle
+{
+    public function speak() -> i32 { return 5; }
+};
+)"));
+    CHECK(table.error_log.size() == 1 && table.error_log[0] == "Method 'Leaf.speak' overrides final method 'Middle.speak'");
+
+    return failures == 0 ? 0 : 1;
+}
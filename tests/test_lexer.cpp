@@ -1,4 +1,80 @@
+#include <iostream>
+#include <string>
+#include "../lang/lang.h"
+#include "../lang/unicode.h"
+#include "check.h"
+
+static std::vector<lexer::token_t> tokenize(lexer::lexer_t& lexer, const std::string_view source)
+{
+    lexer::lexer_init(lexer, source);
+    return lexer::tokenize(lexer);
+}
+
 int main()
 {
-    return 0;
+    // Letters whose code is 64 above a whitespace character must not be skipped.
+    lexer::lexer_t lexer;
+    auto tokens = tokenize(lexer, "Main Idle");
+    CHECK(tokens.size() == 3 && tokens[0].value == "Main" && tokens[1].value == "Idle");
+
+    tokens = tokenize(lexer, "var café: i32 = π + 变量 + x.ñ;");
+    CHECK(lexer.error_log.empty());
+    CHECK(tokens.size() == 12 && tokens[1].value == "café" && tokens[5].value == "π" && tokens[7].value == "变量");
+    CHECK(tokens[9].type == lexer::token_type::IDENTIFIER && tokens[9].value == "x.ñ");
+
+    // A character that cannot be part of an identifier is one error, not one per byte.
+    tokens = tokenize(lexer, "a → b");
+    CHECK(tokens.size() == 3 && lexer.error_log.size() == 1);
+    CHECK(lexer.error_log[0] == "Unknown character '→' at line 1, column 3");
+
+    tokens = tokenize(lexer, "var é\n  x\xFF = 1;");
+    CHECK(lexer.error_log.size() == 1 && lexer.error_log[0] == "Invalid UTF-8 at line 2, column 4");
+
+    CHECK(unicode::is_xid_start(U'a') && !unicode::is_xid_start(U'1') && unicode::is_xid_continue(U'1'));
+    CHECK(!unicode::is_xid_start(U'·') && unicode::is_xid_continue(U'·'));
+    CHECK(unicode::is_xid_start(U'℘') && !unicode::is_xid_continue(U'\U0001F600'));
+
+    // Ill-formed sequences are found at any offset, whether or not the block around them is ASCII.
+    const std::string_view valid[] = { "\xE2\x82\xAC", "\xF0\x9D\x94\xB8", "\xF4\x8F\xBF\xBF", "\xED\x9F\xBF" };
+    const std::string_view invalid[] = { "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xF5\x80", "\x80", "\xE2\x82", "\xE0\x9F\x80" };
+    for (size_t offset = 0; offset < 70; ++offset)
+    {
+        for (const auto sequence : valid)
+        {
+            const std::string text = std::string(offset, 'a') + std::string(sequence) + std::string(40, 'b');
+            CHECK(unicode::validate_utf8(text) && unicode::find_invalid_utf8(text) == std::string_view::npos);
+        }
+        for (const auto sequence : invalid)
+        {
+            const std::string text = std::string(offset, 'a') + std::string(sequence) + std::string(offset % 3 == 0 ? 0 : 40, 'b');
+            CHECK(!unicode::validate_utf8(text) && unicode::find_invalid_utf8(text) == offset);
+        }
+    }
+
+    // Mostly well-formed text with the odd stray byte, checked against the scalar validator.
+    uint32_t seed = 12345;
+    const auto next = [&seed] { return seed = seed * 1664525 + 1013904223, seed >> 8; };
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string text;
+        for (size_t n = next() % 60; n > 0; --n)
+        {
+            const uint32_t kind = next() % 16;
+            const auto code = static_cast<char32_t>(next() % 0x110000);
+            if (kind < 10 || code < 0x80 || (code >= 0xD800 && code < 0xE000))
+                text += static_cast<char>('a' + code % 26);
+            else if (kind == 15 && i % 4 == 0)
+                text += static_cast<char>(0x80 + code % 0x80);
+            else if (code < 0x800)
+                text += { static_cast<char>(0xC0 | code >> 6), static_cast<char>(0x80 | (code & 0x3F)) };
+            else if (code < 0x10000)
+                text += { static_cast<char>(0xE0 | code >> 12), static_cast<char>(0x80 | (code >> 6 & 0x3F)), static_cast<char>(0x80 | (code & 0x3F)) };
+            else
+                text += { static_cast<char>(0xF0 | code >> 18), static_cast<char>(0x80 | (code >> 12 & 0x3F)), static_cast<char>(0x80 | (code >> 6 & 0x3F)), static_cast<char>(0x80 | (code & 0x3F)) };
+        }
+        CHECK(unicode::validate_utf8(text) == (unicode::find_invalid_utf8(text) == std::string_view::npos));
+        CHECK(i % 4 == 0 || unicode::validate_utf8(text));
+    }
+
+    return failures == 0 ? 0 : 1;
 }
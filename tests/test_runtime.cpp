@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include "../lang/driver.h"
+#include "../lang/runtime.h"
+#include "check.h"
+
+static constexpr std::string_view source = R"(
+async function fib(n: i32) -> i32
+{
+    if (n < 2)
+        return n;
+    var a: Task<i32> = fib(n - 1);
+    var b: Task<i32> = fib(n - 2);
+    return await a + await b;
+}
+
+async function leaf(i: i32) -> i64
+{
+    return i;
+}
+
+async function fan(n: i32) -> i64
+{
+    var total: i64 = 0;
+    for (var i: i32 = 0; i < n; i += 1)
+        total += await leaf(i);
+    return total;
+}
+
+async function twice(t: Task<i32>) -> i32
+{
+    return await t + await t;
+}
+
+function ready() -> i32
+{
+    return await 5;
+}
+
+function shared() -> i32
+{
+    var t: Task<i32> = fib(10);
+    var u: Task<i32> = twice(t);
+    return await u + await t;
+}
+
+async function broken(n: i32) -> i32
+{
+    return n / 0;
+}
+
+function failing() -> i32
+{
+    return await broken(1);
+}
+
+function main() -> i32
+{
+    io.write("fib", await fib(15));
+    return await fan(100) - 4950 + shared();
+}
+)";
+
+static vm::status call(runtime::scheduler_t& scheduler, const ir::module_t& module, const std::string_view name,
+    const std::vector<vm::slot_t>& args, vm::slot_t& result)
+{
+    return runtime::call(scheduler, static_cast<uint32_t>(ir::find_function(module, name)), args.data(), args.size(), result);
+}
+
+int main()
+{
+    // The owner takes the newest task, thieves the oldest; the ring grows past its capacity.
+    runtime::deque_t deque;
+    runtime::deque_init(deque, 4);
+    runtime::task_t tasks[10] = {};
+    for (auto& task : tasks)
+        runtime::push(deque, &task);
+    CHECK(runtime::pop(deque) == &tasks[9]);
+    CHECK(runtime::steal(deque) == &tasks[0]);
+    CHECK(runtime::steal(deque) == &tasks[1]);
+    size_t left = 0;
+    while (runtime::pop(deque) != nullptr)
+        ++left;
+    CHECK(left == 7 && runtime::steal(deque) == nullptr);
+
+    runtime::pool_t pool = {};
+    uint32_t size_class = 0;
+    vm::slot_t* frame = runtime::allocate_frame(pool, 5, size_class);
+    CHECK(size_class == 3);
+    runtime::free_frame(pool, frame, size_class);
+    CHECK(runtime::allocate_frame(pool, 8, size_class) == frame);
+    CHECK(runtime::allocate_frame(pool, 9, size_class) != frame && size_class == 4);
+
+    driver::unit_t unit;
+    CHECK(driver::build_program(unit, source));
+    const ir::module_t& module = unit.module;
+    const vm::program_t& program = unit.program;
+
+    // `await` on a plain value is the value itself; only a task handle compiles to AWAIT.
+    const auto& ready = program.functions[ir::find_function(module, "ready")].code;
+    CHECK(std::ranges::none_of(ready, [](const vm::instr_t& i) { return i.op == vm::opcode::AWAIT; }));
+    CHECK(program.functions[ir::find_function(module, "fib")].coroutine);
+
+    // Async functions need a scheduler.
+    std::ostringstream out;
+    vm::vm_t machine;
+    vm::vm_init(machine, program, out);
+    const vm::slot_t arg = { .i32 = 3 };
+    vm::slot_t result;
+    CHECK(vm::call(machine, static_cast<uint32_t>(ir::find_function(module, "fib")), &arg, 1, result) == vm::status::ERROR);
+
+    for (const uint32_t threads : { 1u, 4u })
+    {
+        std::ostringstream output;
+        runtime::scheduler_t scheduler;
+        runtime::scheduler_init(scheduler, program, output, threads);
+        CHECK(call(scheduler, module, "ready", {}, result) == vm::status::OK && result.i32 == 5);
+        CHECK(!scheduler.started);
+        CHECK(call(scheduler, module, "fib", { vm::slot_t { .i32 = 20 } }, result) == vm::status::OK && result.i32 == 6765);
+        CHECK(call(scheduler, module, "shared", {}, result) == vm::status::OK && result.i32 == 55 * 3);
+
+        uint64_t spawned = 0;
+        for (const auto& worker : scheduler.workers)
+            spawned += worker->spawned;
+        CHECK(spawned == 2 * 10946 - 1 + 2 * 89 - 1 + 1); // fib(n) makes 2 * fib(n + 1) - 1 calls
+
+        int exit_code = 0;
+        CHECK(runtime::run(scheduler, exit_code) == vm::status::OK);
+        CHECK(exit_code == 55 * 3);
+        CHECK(output.str() == "fib 610\n");
+        if (!scheduler.error.empty())
+            std::cerr << scheduler.error << "\n";
+    }
+
+    runtime::scheduler_t scheduler;
+    runtime::scheduler_init(scheduler, program, out, 2);
+    CHECK(call(scheduler, module, "failing", {}, result) == vm::status::ERROR);
+    CHECK(scheduler.error.find("division by zero") != std::string::npos);
+    runtime::shutdown(scheduler);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include "../lang/driver.h"
+#include "check.h"
+
+static constexpr std::string_view source = R"(
+class Vector3
+{
+    var x: f32 = 0.0;
+    var y: f32 = 0.0;
+    var z: f32 = 0.0;
+};
+
+class Particle
+{
+    var position: Vector3;
+    var id: u16;
+};
+
+class Shape
+{
+    var side: i32 = 0;
+
+    public virtual function area() -> i32
+    {
+        return 0;
+    }
+};
+
+class Square extends Shape
+{
+    public function area() -> i32
+    {
+        return side * side;
+    }
+};
+
+final class Triangle extends Shape
+{
+    public function area() -> i32
+    {
+        return side * side / 2;
+    }
+};
+
+class Hexagon extends Shape
+{
+    public function area() -> i32
+    {
+        return 6;
+    }
+};
+
+class Octagon extends Hexagon
+{
+    public function area() -> i32
+    {
+        return 8;
+    }
+};
+
+function measure(s: Shape) -> i32
+{
+    return s.area();
+}
+
+function shapes(n: i32) -> i32
+{
+    var square: Square = new Square();
+    square.side = 3;
+    var triangle: Triangle = new Triangle();
+    triangle.side = 4;
+    var total: i32 = 0;
+    for (var i: i32 = 0; i < n; i += 1)
+        total += measure(square) + measure(triangle);
+    return total;
+}
+
+function everything() -> i32
+{
+    return measure(new Shape()) + measure(new Hexagon()) + measure(new Octagon()) + measure(new Square()) + measure(new Triangle());
+}
+
+function triangle(t: Triangle) -> i32
+{
+    return t.area();
+}
+
+function fib(n: i32) -> i32
+{
+    if (n < 2)
+        return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+function sum(n: i32) -> i64
+{
+    var total: i64 = 0;
+    for (var i: i32 = 0; i < n; i += 1)
+        total += i;
+    return total;
+}
+
+function swap(n: i32) -> i32
+{
+    var a: i32 = 1;
+    var b: i32 = 2;
+    for (var i: i32 = 0; i < n; i += 1)
+    {
+        var t: i32 = a;
+        a = b;
+        b = t;
+    }
+    return a * 10 + b;
+}
+
+function dot(n: i32) -> f32
+{
+    var v: Vector3 = Vector3(1.0, 2.0, 3.0);
+    var total: f32 = 0.0;
+    for (var i: i32 = 0; i < n; i += 1)
+        total += v.x * v.x + v.y * v.y + v.z * v.z;
+    return total;
+}
+
+function nested() -> i32
+{
+    var p: Particle = new Particle();
+    p.position.y = 4.5;
+    p.id = 65535;
+    var copy: Vector3 = p.position;
+    copy.y += 1.0;
+    return p.id + copy.y * 2.0;
+}
+
+function length(v: Vector3) -> f32
+{
+    return v.x + v.y + v.z;
+}
+
+function churn(n: i32) -> f32
+{
+    var total: f32 = 0.0;
+    for (var i: i32 = 0; i < n; i += 1)
+    {
+        var v: Vector3 = new Vector3();
+        v.x = 1.0;
+        v.z = i;
+        total += length(v);
+    }
+    return total;
+}
+
+@packed
+class Header
+{
+    var tag: u8;
+    var length: i64;
+    var flags: u16;
+    var ratio: f32;
+};
+
+function header(n: i32) -> Header
+{
+    var h: Header = new Header();
+    h.tag = 7;
+    h.length = n;
+    h.flags = 513;
+    h.ratio = 0.5;
+    return h;
+}
+
+function packed(n: i32) -> i64
+{
+    var h: Header = header(n);
+    h.length += h.tag;
+    h.ratio += 1.0;
+    return h.length * 1000 + h.flags + h.ratio * 2.0;
+}
+
+function divide(a: i32, b: i32) -> i32
+{
+    return a / b;
+}
+
+function Main() -> i32
+{
+    io.write("fib", fib(10));
+    io.write(sum(100), swap(4), true);
+    return nested();
+}
+)";
+
+// The register stack is not zeroed, so every call first fills it with garbage: a register read before
+// it is written would change the result.
+static void poison(vm::vm_t& machine)
+{
+    std::fill_n(machine.stack.get(), vm::STACK_SLOTS, vm::slot_t { .i64 = 0x5A5A5A5A5A5A5A5A });
+}
+
+static vm::status call(vm::vm_t& machine, const ir::module_t& module, const std::string_view name, const std::vector<vm::slot_t>& args,
+    vm::slot_t& result)
+{
+    poison(machine);
+    return vm::call(machine, static_cast<uint32_t>(ir::find_function(module, name)), args.data(), args.size(), result);
+}
+
+int main()
+{
+    driver::unit_t unit;
+    CHECK(driver::build_program(unit, source));
+    const ir::module_t& module = unit.module;
+    const vm::program_t& program = unit.program;
+    CHECK(program.entry == ir::find_function(module, "Main"));
+
+    // Loop conditions compile to fused compare-and-branch, `i += 1` to an add-immediate.
+    const auto& code = program.functions[ir::find_function(module, "sum")].code;
+    CHECK(std::ranges::any_of(code, [](const vm::instr_t& i) { return i.op == vm::opcode::JLE_I32 || i.op == vm::opcode::JLT_I32; }));
+    CHECK(std::ranges::any_of(code, [](const vm::instr_t& i) { return i.op == vm::opcode::ADDI_I32; }));
+
+    std::ostringstream out;
+    vm::vm_t machine;
+    vm::vm_init(machine, program, out);
+
+    vm::slot_t result;
+    CHECK(call(machine, module, "fib", { vm::slot_t { .i32 = 20 } }, result) == vm::status::OK && result.i32 == 6765);
+    CHECK(call(machine, module, "sum", { vm::slot_t { .i32 = 100000 } }, result) == vm::status::OK && result.i64 == 4999950000);
+    CHECK(call(machine, module, "swap", { vm::slot_t { .i32 = 5 } }, result) == vm::status::OK && result.i32 == 21);
+    CHECK(call(machine, module, "dot", { vm::slot_t { .i32 = 4 } }, result) == vm::status::OK && result.f32 == 56.0f);
+    // Fields of a @packed class sit at unaligned offsets.
+    CHECK(call(machine, module, "packed", { vm::slot_t { .i32 = 5 } }, result) == vm::status::OK && result.i64 == 12000 + 513 + 3);
+    CHECK(call(machine, module, "divide", { vm::slot_t { .i32 = 7 }, vm::slot_t { .i32 = 0 } }, result) == vm::status::ERROR);
+    CHECK(machine.error.find("division by zero") != std::string::npos);
+
+    // Calls through `Shape` dispatch on the receiver; `Triangle` is final, so its calls are direct.
+    CHECK(program.sites.size() == 1 && program.functions[program.sites[0].function].name == "measure");
+    const auto& direct = program.functions[ir::find_function(module, "triangle")].code;
+    CHECK(std::ranges::none_of(direct, [](const vm::instr_t& i) { return i.op == vm::opcode::CALL_VIRTUAL; }));
+
+    CHECK(call(machine, module, "shapes", { vm::slot_t { .i32 = 10 } }, result) == vm::status::OK && result.i32 == 170);
+    CHECK(machine.caches[0].count == 2 && !machine.caches[0].megamorphic);
+    CHECK(machine.caches[0].hits == 18 && machine.caches[0].misses == 2);
+    CHECK(call(machine, module, "everything", {}, result) == vm::status::OK && result.i32 == 0 + 6 + 8 + 0 + 0);
+    CHECK(machine.caches[0].megamorphic && machine.caches[0].count == vm::CACHE_WAYS);
+
+    // Objects that do not escape are placed in the frame and never touch the heap.
+    const auto& churn = program.functions[ir::find_function(module, "churn")].code;
+    CHECK(std::ranges::any_of(churn, [](const vm::instr_t& i) { return i.op == vm::opcode::NEW_LOCAL; }));
+    const std::byte* cursor = machine.heap.cursor;
+    CHECK(call(machine, module, "churn", { vm::slot_t { .i32 = 100 } }, result) == vm::status::OK && result.f32 == 5050.0f);
+    CHECK(machine.heap.cursor == cursor);
+
+    int exit_code = 0;
+    poison(machine);
+    CHECK(vm::run(machine, exit_code) == vm::status::OK);
+    CHECK(exit_code == 65535 + 11);
+    CHECK(out.str() == "fib 55\n4950 12 true\n");
+    if (!machine.error.empty())
+        std::cerr << machine.error << "\n";
+
+    return failures == 0 ? 0 : 1;
+}